@@ -1,13 +1,19 @@
 #pragma once
 #include <Arduino.h>
 #include "sensors.h"
+#include "weather_rule.h"
+#include "camera_client.h"
+#include "motion_digest.h"
 
 class Alerts {
 public:
+  static void init();  // Weather limits from NVS (or config.h defaults)
   static void checkWeatherAlerts(SensorData data);
-  static void handleMotionAlert(String photoURL);
+  static void handleMotionAlert(const CaptureSet &shots, unsigned long triggerMs);
+  static void handleMotionSummary(const MotionDigest &digest);  // End of a cooldown window
+  static bool configureWeather(const char *command);  // Runtime limits, persisted
   
 private:
-  static bool tempAlertSent;
-  static bool humAlertSent;
+  static WeatherState weather;
+  static WeatherConfig weatherCfg;
 };
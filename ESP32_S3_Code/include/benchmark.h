@@ -0,0 +1,22 @@
+#pragma once
+#include <Arduino.h>
+
+// Only built into the [env:benchmark] firmware (-DBENCHMARK_MODE)
+#ifdef BENCHMARK_MODE
+
+#ifndef BENCH_ITERATIONS
+#define BENCH_ITERATIONS 50      // Synthetic PIR edges per run
+#endif
+#ifndef BENCH_PERIOD_MS
+#define BENCH_PERIOD_MS 8000     // Edge spacing (must exceed the 5 s ISR debounce)
+#endif
+#ifndef BENCH_MOCK
+#define BENCH_MOCK 1             // 1 = mock camera URLs, 0 = real camera
+#endif
+#define BENCH_MAX_SAMPLES (BENCH_ITERATIONS * 2)  // Per stage (retries add samples)
+
+namespace Bench {
+  void start();  // Arm the synthetic PIR timer and the reporting task
+}
+
+#endif
@@ -0,0 +1,21 @@
+#pragma once
+#include <Arduino.h>
+
+// Boot stages, in the order they usually complete
+enum BootStage : uint8_t {
+  BOOT_ARMED,    // PIR interrupt, AlertTask and the alert queues are live
+  BOOT_WIFI,     // Station has an IP
+  BOOT_SENSORS,  // First valid DHT22 reading (warm-up over)
+  BOOT_MQTT,     // First broker connection
+  BOOT_CAMERA,   // Camera discovery and first /health probe done
+  BOOT_STAGE_COUNT
+};
+
+namespace Boot {
+  void init();                                 // Readiness flags, before any task starts
+  void startNetwork();                         // BootTask: WiFi -> power/NTP -> camera probe
+  void ready(BootStage s);                     // First call records the stage's time since reset
+  bool isReady(BootStage s);
+  bool waitReady(BootStage s, TickType_t ticks);
+  void logSummary();
+}
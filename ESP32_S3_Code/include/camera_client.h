@@ -1,9 +1,29 @@
 #pragma once
 #include <Arduino.h>
+#include "camera_nodes.h"
+
+#define CAM_URL_LEN 64  // Frame handle: http://<ip>:<port>/frame?id=<n>, /jpg?.. or mock JSON
+
+// Frames pinned for one motion trigger, one per camera that answered in time
+struct CaptureSet {
+  char urls[CAM_MAX_NODES][CAM_URL_LEN];  // urls[0] is the primary camera
+  uint8_t count;                          // 0 = no camera online
+  char followUrl[CAM_URL_LEN];            // Full-resolution follow-up for urls[0] ("" = none)
+  bool confirmed;                         // False only if every camera that checked saw no motion
+};
+
 namespace CameraClient {
-  String capture();
-  String captureMock(); // Mock camera for testing
+  // triggerMs: millis() of the PIR edge
+  // followUrl: receives a full-resolution follow-up URL, or "" if the alert image already is one
+  // confirmed: optional, false if the camera's frame difference found no motion
+  void capture(unsigned long triggerMs, char *url, size_t cap, char *followUrl = nullptr, size_t followCap = 0,
+               bool *confirmed = nullptr);
+  // Every online camera at once; total time is the slowest camera's, capped by CAM_CAPTURE_DEADLINE_MS
+  void captureAll(unsigned long triggerMs, CaptureSet &set);
+  void captureMock(char *out, size_t cap); // Mock camera for testing
   void setMockMode(bool enabled);
   bool isMockMode();
   bool checkConnection(); // Check if camera is online
-}
\ No newline at end of file
+  // Signed "capture and deliver": the camera uploads imageUrl's frame to Telegram
+  int deliver(const char *imageUrl, const char *caption, long replyTo, long *messageId);
+}
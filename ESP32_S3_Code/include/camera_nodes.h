@@ -0,0 +1,24 @@
+#pragma once
+#include <Arduino.h>
+
+#define CAM_MAX_NODES 4  // Camera nodes tracked (static + discovered)
+
+// One ESP32-CAM node as seen by the health checker
+struct CameraNode {
+  char host[40];            // IP address used in URLs
+  uint16_t port;
+  char name[32];            // mDNS instance name, or "static"
+  bool online;              // Passing /health checks
+  uint8_t failures;         // Consecutive failed checks
+  uint16_t rttMs;           // Last /health round trip
+  unsigned long lastSeen;   // millis() of the last good check (0 = never)
+};
+
+namespace CameraNodes {
+  void init();                                  // Seed + discover, start CamHealthTask
+  bool checkAll();                              // One synchronous health pass, true if any online
+  int pick(CameraNode &out, int skip = -1);     // Preferred online node, -1 if none
+  void reportFailure(int idx);                  // Capture path could not reach node idx
+  int count();
+  bool get(int idx, CameraNode &out);
+}
@@ -4,18 +4,144 @@
 // ---- Wi-Fi ----
 #define WIFI_SSID       "Copper"
 #define WIFI_PASS       "mockPassword123"
+#define WIFI_STATIC_IP  ""               // e.g. "10.28.158.20" skips DHCP ("" = DHCP)
+#define WIFI_GATEWAY    "10.28.158.1"    // Used with WIFI_STATIC_IP only
+#define WIFI_SUBNET     "255.255.255.0"
+#define WIFI_DNS        "8.8.8.8"
+#define WIFI_FAST_RETRIES  2             // Misses on the cached channel/BSSID before a full scan
+#define WIFI_RETRY_MIN_MS  1000          // Reconnect backoff after a failed attempt (doubles)...
+#define WIFI_RETRY_MAX_MS  30000         // ...up to this
 
 // ---- Adafruit IO ----
 #define IO_USERNAME     "CopperIO"
 #define IO_KEY          "aio_mockAPIKey1234567890abcdef"
+#define IO_GROUP        "default"  // Group holding the temperature/humidity feeds
+#define IO_RATE_PER_MIN 30         // Free tier data point limit, enforced by MqttTask
+#define IO_METRICS_FEED "metrics"  // Feed receiving the periodic metrics summary
+#define METRICS_PUBLISH_MS 300000  // Metrics summary interval (1 data point each)
+
+// ---- MQTT Backend ----
+// Adafruit IO: text feeds under the 30 points/min cap, readings sent on change.
+// Broker: self-hosted Mosquitto (or similar) over TLS with QoS 1; every
+// sensor cycle goes out as one packed binary message (telemetry.h) to
+// BROKER_TOPIC "/telemetry", alerts/metrics/config under the same prefix.
+#define MQTT_BACKEND_ADAFRUIT 0
+#define MQTT_BACKEND_BROKER   1
+#ifndef MQTT_BACKEND
+#define MQTT_BACKEND MQTT_BACKEND_ADAFRUIT  // [env:fleet] selects the broker
+#endif
+#define BROKER_HOST     "10.28.158.10"
+#define BROKER_PORT     8883              // 1883 with BROKER_TLS 0
+#define BROKER_TLS      1
+#define BROKER_CA_PEM   ""                // CA of the broker certificate ("" = not verified, lab only)
+#define BROKER_USER     "node1"
+#define BROKER_PASS     "mockBrokerPass123"
+#define BROKER_TOPIC    "ee4216/node1"    // Topic prefix of this node
+#define BROKER_RATE_PER_MIN 600           // Burst guard only; the broker has no quota
 
 // ---- Telegram ----
 #define TELEGRAM_TOKEN  "8465496106:AAHR_mockToken1234567890abcdef"
 #define TELEGRAM_CHATID "1111111111" //mockChatID
+#define TELEGRAM_TWO_STAGE 1  // Motion: text alert first, photo follows as a reply
+#define TELEGRAM_KEEPALIVE_MS (POWER_MANAGED ? 0 : 45000) // Idle time before a getMe keeps the TLS session warm (0 = off; off when power-managed, the pings keep the radio awake)
+
+// ---- Frame Pool (PSRAM) ----
+#define FRAME_POOL_SLOTS     2            // Whole frames held at once (relayed alert + follow-up)
+#define FRAME_POOL_SLOT_SIZE (96 * 1024)  // Largest camera JPEG (FRAME_RING_SLOT_SIZE in ESP32CAML.cpp)
+
+// ---- Time ----
+#define NTP_SERVER      "pool.ntp.org"
+#define TZ_OFFSET_SEC   (8 * 3600)  // UTC+8, for local log timestamps
+
+// ---- Offline Buffer ----
+#define STORE_RAM_RECORDS       240   // ~2 h of 30 s readings in RAM (10 bytes each)
+#define STORE_FLASH_SPILL       1     // Spill older records to LittleFS
+#define STORE_SPILL_BATCH       48    // Records moved to flash per write
+#define STORE_FLASH_MAX_RECORDS 8640  // ~3 days of readings on flash (~30 KB packed)
+
+// ---- Motion ----
+#ifdef BENCHMARK_MODE
+#define ALERT_COOLDOWN_MS 0      // Benchmark: every synthetic edge runs the pipeline
+#else
+#define ALERT_COOLDOWN_MS 60000  // Min time between motion alerts
+#endif
+#define COOLDOWN_DIGEST 1  // Motion during the cooldown goes out as one summary when it ends
+
+// ---- Power ----
+#ifndef POWER_MANAGED
+#define POWER_MANAGED 0   // 1 = DFS, modem sleep, light sleep with PIR wake ([env:lowpower])
+#endif
+#define POWER_MIN_MHZ 80  // Idle clock (DFS floor; WiFi needs >= 80)
+#define POWER_MAX_MHZ 240 // Alert path clock, held by Power::hold()
+#define POWER_IDLE_POLL_MS 1000 // MqttTask/LogTask poll period when power-managed
+
+// ---- Task Topology ----
+// Core 0 runs the WiFi driver (priority 23) and lwIP (18): tasks that
+// mostly wait on sockets and are not latency-critical sit beside them.
+// Core 1 keeps the alert pipeline clear of WiFi bursts, with alerts
+// above uploads above sensors, so a DHT read never delays a capture.
+// Stacks: deepest call path plus ~1 KB, sized from the frames in the
+// code (not yet measured). [env:benchmark] prints every task's
+// high-water mark ("stack_free" in BENCH_RESULT) and Metrics warns below
+// TASK_STACK_MIN_FREE - tune from those.
+#define TASK_ALERT_CORE      1     // PIR event -> capture -> enqueue
+#define TASK_ALERT_PRIO      5
+#define TASK_ALERT_STACK     6144
+#define TASK_TELEGRAM_CORE   1     // TLS upload: the mbedTLS handshake is the deepest path
+#define TASK_TELEGRAM_PRIO   4
+#define TASK_TELEGRAM_STACK  10240 // Handshake (~6 KB) under sendAlbum's ~2 KB of envelope buffers
+#define TASK_MQTT_ALERT_CORE 0     // Only hands the reason to MqttTask
+#define TASK_MQTT_ALERT_PRIO 3
+#define TASK_MQTT_ALERT_STACK 3072
+#define TASK_SENSOR_CORE     1     // Below the alert path; DHT_USE_RMT 0 bit-bangs with interrupts off, never beside WiFi
+#define TASK_SENSOR_PRIO     2
+#define TASK_SENSOR_STACK    4096
+#define TASK_MQTT_CORE       0     // Telemetry publishing
+#define TASK_MQTT_PRIO       2
+#if MQTT_BACKEND == MQTT_BACKEND_BROKER && BROKER_TLS
+#define TASK_MQTT_STACK      8192  // mqtt.connect() runs the mbedTLS handshake, as in TelegramTask
+#else
+#define TASK_MQTT_STACK      4096
+#endif
+#define TASK_CAM_HEALTH_CORE 0     // /health polling and mDNS
+#define TASK_CAM_HEALTH_PRIO 1
+#define TASK_CAM_HEALTH_STACK 4096
+#define TASK_BOOT_CORE       0     // One-shot network boot stage (WiFi wait, camera probe)
+#define TASK_BOOT_PRIO       1
+#define TASK_BOOT_STACK      4096
+#define TASK_LOG_CORE        0     // UART drain, runs whenever core 0 is otherwise idle
+#define TASK_LOG_PRIO        tskIDLE_PRIORITY
+#define TASK_LOG_STACK       2048
+#define TASK_STACK_MIN_FREE  512   // Warn when a task's stack high-water mark drops below this (bytes)
+#define TASK_WDT_TIMEOUT_S   60    // Task watchdog: longest a watched task may go without feeding
+#define TASK_WDT_FEED_MS     5000  // Max blocking wait in a watched task between feeds
 
 // ---- Thresholds ----
+// Defaults for the weather rules (weather_rule.cpp). Changed at runtime by
+// publishing e.g. "temp_high=35 temp_dwell=120" to IO_CONFIG_FEED; the
+// current limits are kept in NVS and survive a reboot.
 #define TEMP_LIMIT      34.0
 #define HUM_LIMIT       90.0
+#define TEMP_HYSTERESIS 1.0    // Re-arm once back below TEMP_LIMIT - this
+#define HUM_HYSTERESIS  5.0
+#define WEATHER_DWELL_MS 60000 // Above a limit this long before it alerts
+#define TEMP_RATE_PER_MIN 1.0  // Alert on a rise this fast (C/min, over ~1 min; 0 = off)
+#define HUM_RATE_PER_MIN  0.0  // Showers make humidity jumps normal: off
+#define IO_CONFIG_FEED  "weather-config"  // Adafruit IO feed the limits are set from
+
+// ---- Sensor Sampling ----
+#define SENSOR_PERIOD_MS      10000  // One DHT22 transaction per SensorTask cycle (sensor needs >= 2000)
+#ifndef DHT_USE_RMT
+#define DHT_USE_RMT           1      // Time the DHT reply with RMT capture, interrupts stay on (0 = DHT library)
+#endif
+#define DHT_RMT_CHANNEL       4      // RMT receive channel (4-7 on the ESP32-S3)
+#define DHT_WARMUP_MS         2000   // Power-on settle time, waited out by the first read
+#define SENSOR_MEDIAN_WINDOW  5      // Median over the last N valid samples
+#define SENSOR_EMA_ALPHA      0.3f   // EMA weight of each new median (1 = median only)
+#define SENSOR_MAX_MISSES     3      // Failed reads in a row before the values go NaN
+#define TEMP_DEADBAND         0.2f   // Publish when temperature moved this much (C)...
+#define HUM_DEADBAND          1.0f   // ...or humidity moved this much (%RH)...
+#define SENSOR_PUBLISH_MAX_MS 300000 // ...or this long passed since the last publish
 
 // ---- Pins ----
 #define DHTPIN          4
@@ -23,5 +149,25 @@
 #define PIRPIN          15  // Changed from 36 - ESP32-S3 only supports interrupts on GPIO 0-21
 
 // ---- Camera Node ----
-#define CAM_IP          "10.28.158.71"  // ESP32-CAM local IP
+#define CAM_IP          "10.28.158.71"  // Static camera seed ("" = mDNS discovery only)
 #define CAM_PORT        80
+#define CAM_MDNS_SERVICE      "esp32cam"  // Cameras advertise _esp32cam._tcp (ESP32CAML.cpp)
+#define CAM_HEALTH_MS         5000        // /health check period per node
+#define CAM_HEALTH_TIMEOUT_MS 800         // Connect + response timeout for /health
+#define CAM_DISCOVERY_MS      60000       // mDNS re-query period
+#define CAM_FRAME_RING  1   // Camera buffers recent frames: fetch the one at trigger time
+#ifdef BENCHMARK_MODE
+#define CAM_VERIFY_MOTION 0 // Benchmark: synthetic edges have no motion in the picture
+#else
+#define CAM_VERIFY_MOTION 1 // /mark checks the frame for visible motion; unconfirmed PIR edges go out text-only
+#endif
+#define CAM_ALERT_SIZE    "qvga"  // Live-capture alert image: small so it arrives fast on a weak link
+#define CAM_ALERT_QUALITY 14
+#define CAM_FULL_SIZE     "svga"  // Full-resolution follow-up photo ("" = never send one)
+#define CAM_FULL_QUALITY  10
+#define CAM_DIRECT_PUSH   1               // Camera uploads to Telegram itself (S3 gets a receipt)
+#define CAM_DELIVER_KEY   "mockDeliverKey0123456789abcdef"  // HMAC key, same as ESP32CAML.cpp
+#define CAM_DELIVER_PORT  82              // /nonce and /deliver: the camera's preview instance (PREVIEW_PORT)
+#define CAM_MULTI_CAPTURE       1     // Motion: pin a frame on every online camera, alert as an album
+#define CAM_CAPTURE_DEADLINE_MS 1500  // Slowest /mark reply waited for; later cameras are left out
+#define CAM_ALBUM_DEADLINE_MS   4000  // Slowest camera's frame headers waited for before the upload
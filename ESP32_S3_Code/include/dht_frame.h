@@ -0,0 +1,18 @@
+#pragma once
+#include <Arduino.h>
+
+#define DHT_FRAME_BITS 40  // 16 bit humidity, 16 bit temperature, 8 bit checksum
+#define DHT_BIT_ONE_US 48  // High pulse longer than this is a 1 (0 ~ 26 us, 1 ~ 70 us)
+
+// Outcome of one DHT22 transaction
+enum DhtStatus : uint8_t {
+  DHT_OK,
+  DHT_NO_RESPONSE,  // Fewer than 40 data pulses (sensor absent or frame cut short)
+  DHT_CHECKSUM,     // Bit error on the wire
+  DHT_RANGE         // Decoded, but outside the DHT22 measuring range
+};
+
+namespace DhtFrame {
+  DhtStatus decode(const uint16_t *highUs, size_t count, float &temp, float &hum);
+  const char *statusName(DhtStatus s);
+}
@@ -0,0 +1,23 @@
+#pragma once
+#include <Arduino.h>
+#include "camera_client.h"
+
+// One alert on its way to the notification channels.
+// Fixed-size fields so the event can be copied through a FreeRTOS queue.
+struct AlertEvent {
+  char reason[24];          // MQTT alert reason (e.g., "motion")
+  char text[128];           // Telegram message / caption
+  char photoURL[128];       // Frame handle from CameraClient::capture() ("" = none), primary camera
+  unsigned long raisedAt;   // millis() when the alert was enqueued
+  unsigned long triggerMs;  // millis() of the motion edge (0 = not a motion alert)
+  char followupURL[64];     // Full-resolution photo sent after delivery ("" = none)
+  char extraURLs[CAM_MAX_NODES - 1][CAM_URL_LEN]; // Other cameras' frames: Telegram album with photoURL
+  uint8_t extraCount;
+};
+
+namespace Dispatcher {
+  void init();
+  bool enqueue(const char *reason, const char *text, const char *photoURL = "", unsigned long triggerMs = 0,
+               const char *followupURL = "");
+  bool enqueue(const char *reason, const char *text, const CaptureSet &shots, unsigned long triggerMs);
+}
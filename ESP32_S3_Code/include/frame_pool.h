@@ -0,0 +1,26 @@
+#pragma once
+#include <Arduino.h>
+
+// A borrowed frame buffer: one pool slot in PSRAM
+struct FrameBuf {
+  uint8_t *data;  // nullptr = nothing borrowed
+  size_t cap;     // Slot size (FRAME_POOL_SLOT_SIZE)
+  size_t len;     // Bytes held, 0 = empty
+  int slot;       // Pool slot index, -1 = none
+};
+
+namespace FramePool {
+  struct Stats {
+    uint8_t slots;     // Slots allocated at boot (0 = no PSRAM, pool off)
+    uint8_t inUse;     // Slots borrowed right now
+    uint8_t peak;      // Most slots borrowed at once
+    uint32_t borrows;  // Successful borrows
+    uint32_t refused;  // Borrows refused because every slot was busy
+  };
+
+  void init();                   // Once at boot: every slot in one PSRAM allocation
+  bool borrow(FrameBuf &f);      // false (f.data = nullptr) if no slot is free
+  void giveBack(FrameBuf &f);    // Safe on a FrameBuf that holds nothing
+  Stats stats();
+  void logSummary();
+}
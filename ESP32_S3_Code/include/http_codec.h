@@ -0,0 +1,18 @@
+#pragma once
+// Pure string/encoding helpers used by the Telegram client.
+// No Arduino dependencies, so they also build for [env:native].
+#include <stddef.h>
+
+namespace HttpCodec {
+  size_t urlEncode(const char *in, char *out, size_t cap);
+  size_t hexEncode(const unsigned char *in, size_t len, char *out, size_t cap);
+  bool isPrivateHttpUrl(const char *url);
+  bool splitHttpUrl(const char *url, char *host, size_t hostCap, unsigned *port, const char **path);
+  size_t multipartBoundary(unsigned long seed, char *out, size_t cap);
+  size_t multipartPreamble(const char *boundary, const char *chatId, const char *caption,
+                           long replyTo, char *out, size_t cap);
+  size_t multipartTrailer(const char *boundary, char *out, size_t cap);
+  size_t multipartField(const char *boundary, const char *name, const char *value, char *out, size_t cap);
+  size_t multipartFileHeader(const char *boundary, const char *name, bool leadingCrlf, char *out, size_t cap);
+  size_t jsonEscape(const char *in, char *out, size_t cap);
+}
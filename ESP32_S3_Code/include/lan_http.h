@@ -0,0 +1,20 @@
+#pragma once
+#include <Arduino.h>
+#include <WiFiClient.h>
+
+// One raw HTTP/1.0 GET to a LAN device, split into request and response
+// so the device can work while the caller does something else - and
+// several requests can be in flight at once.
+struct HttpFetch {
+  WiFiClient client;
+  uint64_t startUs;   // When the request went out
+  bool requested;     // Request written, response not read yet
+};
+
+namespace LanHttp {
+  bool writeAll(Client &c, const uint8_t *data, size_t len);
+  bool readLine(Client &c, char *buf, size_t cap, unsigned long deadline);
+  bool request(HttpFetch &f, const char *url, int32_t connectTimeoutMs = 0);  // 0 = stack default
+  int response(HttpFetch &f, long *contentLength, unsigned long deadline);
+  size_t readBody(HttpFetch &f, char *out, size_t cap, long contentLength, unsigned long deadline);
+}
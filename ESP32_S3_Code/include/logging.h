@@ -0,0 +1,35 @@
+#pragma once
+#include <Arduino.h>
+
+// ---- Log levels ----
+// Calls above LOG_LEVEL are removed at compile time (arguments included).
+// Select with a build flag in platformio.ini, e.g. -DLOG_LEVEL=4
+#define LOG_LEVEL_NONE  0
+#define LOG_LEVEL_ERROR 1
+#define LOG_LEVEL_WARN  2
+#define LOG_LEVEL_INFO  3
+#define LOG_LEVEL_DEBUG 4
+
+#ifndef LOG_LEVEL
+#define LOG_LEVEL LOG_LEVEL_INFO
+#endif
+
+#define LOG_LINE_MAX  192  // Longer lines are truncated
+#define LOG_RING_SLOTS 64  // Queued lines (power of two, ~12 KB); overflow is dropped and counted
+
+namespace Log {
+  void init();  // Start the background UART drain task
+  // Queues "[tag] <formatted>" as one line; tag == nullptr prints no prefix
+  void line(const char *tag, const char *fmt, ...) __attribute__((format(printf, 2, 3)));
+  void flush(uint32_t timeoutMs = 500);  // Wait for queued lines to drain (e.g., before restart)
+  uint32_t dropped();  // Lines lost because the ring was full
+}
+
+#define LOG_AT(level, tag, fmt, ...) \
+  do { if (LOG_LEVEL >= (level)) Log::line(tag, fmt, ##__VA_ARGS__); } while (0)
+
+#define LOGE(tag, fmt, ...) LOG_AT(LOG_LEVEL_ERROR, tag, fmt, ##__VA_ARGS__)
+#define LOGW(tag, fmt, ...) LOG_AT(LOG_LEVEL_WARN,  tag, fmt, ##__VA_ARGS__)
+#define LOGI(tag, fmt, ...) LOG_AT(LOG_LEVEL_INFO,  tag, fmt, ##__VA_ARGS__)
+#define LOGD(tag, fmt, ...) LOG_AT(LOG_LEVEL_DEBUG, tag, fmt, ##__VA_ARGS__)
+#define LOG_BANNER(text)    LOG_AT(LOG_LEVEL_INFO,  nullptr, "%s", text)  // Untagged section header
@@ -0,0 +1,60 @@
+#pragma once
+#include <Arduino.h>
+
+// Event counters
+enum MetricCounter : uint8_t {
+  M_MOTION_EVENTS,      // Motion events taken by AlertTask
+  M_MOTION_COOLDOWN,    // Motion events during cooldown (summarised or ignored)
+  M_TG_FETCH_FAIL,      // Camera GET failed before an upload
+  M_TG_UPLOAD_RETRY,    // Extra Telegram upload attempts
+  M_TG_SEND_FAIL,       // Telegram alerts not accepted
+  M_MQTT_PUBLISH_FAIL,  // MQTT publishes rejected or timed out
+  M_MQTT_RECONNECT,     // Broker connects after a drop
+  M_ALERT_DROPPED,      // Alerts a channel gave up on or could not queue
+  M_CAM_OFFLINE,        // Camera nodes that went offline
+  M_CAM_UNAVAILABLE,    // Motion alerts sent without a photo (no camera online)
+  M_CAM_LATE,           // Cameras left out of a multi-camera capture (missed the deadline)
+  M_DHT_FAIL,           // DHT22 transactions that returned no valid frame
+  M_MOTION_UNCONFIRMED, // Motion events no camera saw in the picture (sent text-only / not summarised)
+  M_FRAME_POOL_EMPTY,   // Frame pool borrows refused (every PSRAM slot busy)
+  M_WIFI_DROP,          // Station lost its AP
+  M_COUNTER_COUNT
+};
+
+// Latency histograms
+enum MetricHist : uint8_t {
+  H_SENSOR_READ,        // Sensors::readAll()
+  H_CAPTURE,            // CameraClient::capture() / captureAll() (URL / frame pin)
+  H_TG_LOCAL_GET,       // Camera GET until headers, before upload
+  H_TG_UPLOAD,          // One streamed sendPhoto upload
+  H_TG_SEND,            // Telegram::sendAlert() end to end
+  H_CAM_PUSH,           // Camera-side Telegram delivery incl. receipt
+  H_MQTT_PUBLISH,       // One buffered record publish
+  H_MQTT_ALERT,         // One live alert publish
+  H_MOTION_FIRST_NOTICE, // PIR edge -> two-stage text alert accepted
+  H_MOTION_TO_TG,       // PIR edge -> Telegram accepted
+  H_MOTION_TO_MQTT,     // PIR edge -> MQTT alert queued
+  H_MOTION_WAKE,        // PIR ISR -> AlertTask running (includes light-sleep exit)
+  H_WIFI_CONNECT,       // Boot or link drop -> station has an IP
+  M_HIST_COUNT
+};
+
+#define METRICS_MAX_TASKS 10  // Tasks tracked for stack high-water marks
+
+namespace Metrics {
+  uint64_t now();                                // esp_timer_get_time(), microseconds
+  void count(MetricCounter c, uint32_t n = 1);
+  void observe(MetricHist h, uint32_t us);
+  void observeSince(MetricHist h, uint64_t startUs);
+  uint32_t counter(MetricCounter c);
+  const char *counterName(MetricCounter c);
+  const char *histName(MetricHist h);
+  void watchCurrentTask();                       // Track caller's stack high-water mark
+  uint8_t taskCount();                           // Tasks registered by watchCurrentTask()
+  const char *taskName(uint8_t i);
+  uint32_t taskStackFree(uint8_t i);             // Lowest free stack seen so far (bytes)
+  void setObserver(void (*fn)(MetricHist h, uint32_t us)); // Tap every sample (benchmark)
+  uint32_t percentileUs(MetricHist h, uint8_t pct);
+  void logSummary();                             // Full dump to the log
+  size_t summary(char *buf, size_t cap);         // Compact one-line summary for the dashboard
+}
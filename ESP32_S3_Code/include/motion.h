@@ -1,6 +1,17 @@
 #pragma once
 #include <Arduino.h>
+
+void onMotion(); // PIR edge ISR (also driven by the benchmark timer)
+
+// Motion event handed from the PIR ISR to the listening task
+struct MotionEvent {
+  unsigned long triggerMs;  // millis() of the PIR edge that raised the event
+  uint64_t triggerUs;       // esp_timer time of that edge (ISR -> task wake latency)
+  uint32_t edges;           // PIR edges folded into this event (debounced + coalesced)
+};
+
 namespace Motion {
   void init(int pin);
-  bool motionDetected();
+  void setListener(TaskHandle_t task); // Task woken by the ISR on motion
+  bool waitForEvent(MotionEvent &ev, TickType_t timeout = portMAX_DELAY);
 }
\ No newline at end of file
@@ -0,0 +1,27 @@
+#pragma once
+#include <Arduino.h>
+
+#define DIGEST_MAX_EVENTS 16  // Trigger times kept per window (older ones are only counted)
+#define DIGEST_MAX_PHOTOS 3   // Frames kept per window, newest win (<= camera FRAME_RING_MAX_HELD)
+#define DIGEST_URL_LEN    64  // Same as CAM_URL_LEN
+
+// Motion seen during one alert cooldown, summarised when it ends.
+// Fixed capacity: adding an event never allocates.
+struct MotionDigest {
+  unsigned long windowStartMs;   // millis() of the alert that opened the window
+  uint32_t events;               // Events folded in, including those past the ring
+  uint32_t edges;                // PIR edges behind them
+  unsigned long times[DIGEST_MAX_EVENTS];        // Trigger times (ring)
+  uint8_t nextTime;                              // Ring write position
+  char photos[DIGEST_MAX_PHOTOS][DIGEST_URL_LEN]; // Frame handles (ring)
+  uint8_t nextPhoto;                             // Ring write position
+  uint32_t photosTaken;          // Frames offered, including overwritten ones
+};
+
+namespace Digest {
+  void open(MotionDigest &d, unsigned long windowStartMs);  // Empty digest for a new window
+  void add(MotionDigest &d, unsigned long triggerMs, uint32_t edges, const char *photoUrl);  // photoUrl "" = none
+  int photoCount(const MotionDigest &d);
+  const char *photo(const MotionDigest &d, int i);  // 0 = oldest kept
+  size_t describe(const MotionDigest &d, char *out, size_t cap);  // "12 more motion events, 3 photos\n+4s +9s ..."
+}
@@ -2,6 +2,9 @@
 #include "sensors.h"
 namespace NetMQTT {
   void init();
-  void publishEnv(SensorData d);
-  void publishAlert(String reason, String photoURL);
+  void publishEnv(SensorData d);    // Queues; MqttTask sends under the rate limit (one packed message on the broker)
+  bool publishAlert(const char *reason);
+  void publishMetrics(const char *summary);
+  void setConfigHandler(bool (*handler)(const char *command)); // IO_CONFIG_FEED values, called by MqttTask
+  bool connected();
 }
\ No newline at end of file
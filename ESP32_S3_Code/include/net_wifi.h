@@ -0,0 +1,9 @@
+#pragma once
+#include <Arduino.h>
+
+namespace NetWiFi {
+  void init();                          // Starts associating (cached AP first); returns at once
+  bool waitConnected(uint32_t timeoutMs); // setup(): true once the station has an IP
+  bool connected();
+  void logSummary();
+}
@@ -0,0 +1,11 @@
+#pragma once
+#include <Arduino.h>
+
+namespace Power {
+  void init();     // After WiFi connects: DFS, modem sleep, light sleep (POWER_MANAGED)
+  void hold();     // Alert path: CPU at POWER_MAX_MHZ and no light sleep until release()
+  void release();
+  void noteWake(unsigned long triggerMs, uint64_t triggerUs); // AlertTask took a PIR event
+  void noteDelivered(unsigned long triggerMs);                // Telegram accepted that alert
+  void logSummary();
+}
@@ -1,4 +1,7 @@
 #pragma once
 namespace Scheduler {
+  void initWatchdog();      // Task watchdog timeout, first thing in setup()
   void initTasks();
-}
\ No newline at end of file
+  void watchCurrentTask();  // Task watchdog + stack high-water tracking for the caller
+  void feedWatchdog();      // At least every TASK_WDT_TIMEOUT_S in a watched task
+}
@@ -0,0 +1,33 @@
+#pragma once
+#include <Arduino.h>
+
+#define FILTER_MAX_WINDOW 9  // Largest median window
+
+// Median over the last valid samples, smoothed by an EMA (one channel)
+struct SensorFilter {
+  float window[FILTER_MAX_WINDOW]; // Last valid raw samples (ring)
+  uint8_t size;       // Window length in use
+  uint8_t count;      // Valid samples held
+  uint8_t next;       // Ring write position
+  uint8_t misses;     // Failed samples in a row
+  uint8_t maxMisses;  // Failed samples in a row before the output goes NaN
+  float alpha;        // EMA weight of each new median (1 = median only)
+  float value;        // Filtered output, NaN until the first valid sample
+};
+
+// Change-based publishing: deadband plus heartbeat (one channel)
+struct PublishGate {
+  float deadband;         // Change that is worth a data point
+  uint32_t maxIntervalMs; // Publish at least this often
+  float last;             // Last published value
+  uint32_t lastMs;        // millis() of that publish
+  bool published;         // Anything published yet
+};
+
+namespace Filter {
+  void init(SensorFilter &f, uint8_t window, float alpha, uint8_t maxMisses);
+  float push(SensorFilter &f, float raw);  // raw NaN = failed read; returns f.value
+  void initGate(PublishGate &g, float deadband, uint32_t maxIntervalMs);
+  bool due(const PublishGate &g, float value, uint32_t nowMs);
+  void mark(PublishGate &g, float value, uint32_t nowMs);
+}
@@ -1,10 +1,12 @@
 #pragma once
 #include <Arduino.h>
+#include <time.h>
 struct SensorData {
-  float temp, hum;
-  String ts;
+  float temp, hum;  // Filtered values (NaN = no valid reading lately)
+  time_t ts;  // Unix time of the reading (0 = clock not synced)
 };
 namespace Sensors {
   void init();
-  SensorData readAll();
-}
\ No newline at end of file
+  SensorData readAll();                 // One DHT22 transaction per call
+  bool publishDue(const SensorData &d); // Deadband / heartbeat check, marks d as published
+}
@@ -0,0 +1,21 @@
+#pragma once
+#include <Arduino.h>
+#include "sensors.h"
+#include "store_codec.h"  // StoreRecord and the flash block format
+
+// A day of 30 s samples is ~9-12 KB on flash (3-4 bytes each, see
+// store_codec.cpp); only the newest STORE_RAM_RECORDS stay unpacked.
+
+namespace Store {
+  void init();
+  bool push(const StoreRecord &r);
+  bool peek(StoreRecord &r);   // Oldest record, not removed
+  void pop();                  // Remove the record returned by peek()
+  uint32_t pending();
+  uint32_t dropped();
+  
+  StoreRecord envRecord(const SensorData &d);
+  StoreRecord alertRecord(const char *reason);
+  uint8_t reasonCode(const char *reason);
+  const char *reasonName(uint8_t code);
+}
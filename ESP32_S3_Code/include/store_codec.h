@@ -0,0 +1,28 @@
+#pragma once
+#include <Arduino.h>
+
+// Kinds of buffered record
+enum StoreKind : uint8_t { STORE_ENV = 1, STORE_ALERT = 2 };
+
+// One buffered data point - 10 bytes in the RAM ring. Spilled to flash
+// in delta-encoded blocks (StoreCodec), 3-4 bytes per 30 s reading.
+struct __attribute__((packed)) StoreRecord {
+  uint32_t epoch;   // Unix time when recorded (0 = clock not synced)
+  uint8_t kind;     // StoreKind
+  uint8_t reason;   // STORE_ALERT: index from Store::reasonCode()
+  int16_t temp10;   // STORE_ENV: °C x10, STORE_NAN_TEMP if invalid
+  uint16_t hum10;   // STORE_ENV: % x10, STORE_NAN_HUM if invalid
+};
+
+#define STORE_NAN_TEMP  INT16_MIN
+#define STORE_NAN_HUM   0xFFFF
+
+#define STORE_BLOCK_VERSION 1
+#define STORE_BLOCK_HEADER  4   // version, count, u16 length
+#define STORE_BLOCK_BYTES(n) (STORE_BLOCK_HEADER + (n) * 9u)  // Worst case for n records
+
+namespace StoreCodec {
+  size_t encodeBlock(const StoreRecord *recs, uint8_t n, uint8_t *out, size_t cap);  // Block length, 0 if cap too small
+  size_t blockLength(const uint8_t *header, uint8_t *count);                         // From STORE_BLOCK_HEADER bytes, 0 if not a block
+  uint8_t decodeBlock(const uint8_t *in, size_t len, StoreRecord *recs, uint8_t cap); // Records decoded, 0 if malformed
+}
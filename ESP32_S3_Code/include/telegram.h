@@ -1,5 +1,18 @@
 #pragma once
 #include <Arduino.h>
 namespace Telegram {
-  void sendAlert(String text, String photoURL="");
+  // Keep-alive session counters since boot
+  struct SessionStats {
+    uint32_t handshakes;       // Full TLS handshakes performed
+    uint32_t reused;           // Requests on an already-open session (handshakes saved)
+    uint32_t staleSessions;    // Warm sessions found dropped and re-opened
+    uint32_t handshakeMsTotal; // Time spent in handshakes
+  };
+
+  void init();
+  bool sendAlert(const char *text, const char *photoURL = "", unsigned long triggerMs = 0); // true if delivered
+  // Photos from several cameras as one sendMediaGroup (primary camera first)
+  bool sendAlbum(const char *text, const char *const urls[], int n, unsigned long triggerMs = 0);
+  void keepWarm(); // Call periodically to stop the session idling out
+  SessionStats sessionStats();
 }
\ No newline at end of file
@@ -0,0 +1,30 @@
+#pragma once
+#include <Arduino.h>
+
+#define TELEMETRY_VERSION 1
+#define TELEMETRY_LEN     24  // Encoded size of one reading
+
+#define TLM_NAN_TEMP INT16_MIN  // Same sentinels as StoreRecord
+#define TLM_NAN_HUM  0xFFFF
+
+// TelemetryReading.flags
+#define TLM_BACKLOG 0x01  // Sent from the offline spool: epoch is the recording time,
+                          // rssi/heap/uptime are from when it was sent
+#define TLM_CLOCK   0x02  // epoch is valid (NTP synced when recorded)
+
+// One sensor cycle for the self-hosted broker (MQTT_BACKEND_BROKER)
+struct TelemetryReading {
+  uint8_t flags;      // TLM_*
+  uint32_t seq;       // Per-boot message number; a QoS 1 redelivery repeats it
+  uint32_t epoch;     // Unix time of the reading, 0 = clock not synced
+  int16_t temp10;     // °C x10, TLM_NAN_TEMP if invalid
+  uint16_t hum10;     // % x10, TLM_NAN_HUM if invalid
+  int8_t rssi;        // dBm
+  uint32_t freeHeap;  // Bytes
+  uint32_t uptimeS;   // Seconds since boot
+};
+
+namespace Telemetry {
+  size_t encode(const TelemetryReading &r, uint8_t *out, size_t cap);       // TELEMETRY_LEN, 0 if cap too small
+  bool decode(const uint8_t *in, size_t len, TelemetryReading &r);          // Collector side / tests
+}
@@ -1,5 +1,9 @@
 #pragma once
 #include <Arduino.h>
+#include <time.h>
 namespace Utils {
-  String timestamp();
+  void syncTime();
+  time_t epoch();
+  size_t formatIso(time_t t, char *buf, size_t cap);
+  size_t timestamp(time_t t, char *buf, size_t cap);
 }
\ No newline at end of file
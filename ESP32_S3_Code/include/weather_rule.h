@@ -0,0 +1,51 @@
+#pragma once
+#include "sensors.h"
+
+// Weather alerts raised by one reading (bit flags)
+enum WeatherAlert : uint8_t {
+  WX_NONE         = 0,
+  WX_HIGH_TEMP    = 1 << 0,
+  WX_HIGH_HUM     = 1 << 1,
+  WX_TEMP_RISING  = 1 << 2,
+  WX_HUM_RISING   = 1 << 3
+};
+
+// Rule parameters for one quantity, changeable at runtime
+struct WeatherLimit {
+  float high;        // Alert above this
+  float hysteresis;  // Re-arm only once the value is back below high - hysteresis
+  uint32_t dwellMs;  // Must stay above high this long before alerting
+  float ratePerMin;  // Alert when rising at least this fast per minute (0 = off)
+};
+
+struct WeatherConfig {
+  WeatherLimit temp;
+  WeatherLimit hum;
+};
+
+#define WX_HISTORY 6  // Samples in the rate-of-change window
+
+// Rule state for one quantity
+struct WeatherChannel {
+  bool alerted;          // High alert sent, not yet re-armed
+  bool rising;           // Rate alert sent, not yet re-armed
+  bool above;            // Currently above high
+  uint32_t aboveSinceMs; // When the current stretch above high began
+  float hist[WX_HISTORY];      // Recent valid values (ring)
+  uint32_t histMs[WX_HISTORY]; // Their times
+  uint8_t histCount;
+  uint8_t histNext;
+};
+
+struct WeatherState {
+  WeatherChannel temp;
+  WeatherChannel hum;
+};
+
+namespace WeatherRule {
+  void reset(WeatherState &st);
+  uint8_t evaluate(WeatherState &st, const SensorData &d, const WeatherConfig &cfg, uint32_t nowMs);
+  float ratePerMin(const WeatherChannel &c);               // Slope over the history, NaN if too short
+  int apply(WeatherConfig &cfg, const char *command);      // "temp_high=35 hum_dwell=120"; keys applied, -1 on error
+  size_t describe(const WeatherConfig &cfg, char *buf, size_t cap);
+}
@@ -3,130 +3,219 @@
  * 
  * Manages two types of alerts:
  * 1. Weather alerts: Temperature and humidity threshold violations
- * 2. Motion alerts: Intrusion detection with photo evidence
+ * 2. Motion alerts: Intrusion detection with photo evidence, plus one
+ *    summary of the motion seen during each cooldown
  * 
  * Implements state machines to prevent alert spam and ensure
- * users receive one actionable notification per event.
+ * users receive one actionable notification per event. Weather limits
+ * can be changed at runtime (configureWeather) and are kept in NVS.
+ * 
+ * Delivery is asynchronous: alerts are handed to the Dispatcher,
+ * whose per-channel sender tasks talk to Telegram and MQTT.
  */
 
 #include "alerts.h"
 #include "config.h"
-#include "telegram.h"
-#include "net_mqtt.h"
+#include "dispatcher.h"
+#include "logging.h"
+#include <Preferences.h>
+
+// Static member initialization - rule state (hysteresis, dwell, history)
+// This persists across calls to implement "send once" behavior
+WeatherState Alerts::weather = {};
+WeatherConfig Alerts::weatherCfg = {
+  { TEMP_LIMIT, TEMP_HYSTERESIS, WEATHER_DWELL_MS, TEMP_RATE_PER_MIN },
+  { HUM_LIMIT, HUM_HYSTERESIS, WEATHER_DWELL_MS, HUM_RATE_PER_MIN }
+};
 
-// Static member initialization - tracks alert state
-// These persist across function calls to implement "send once" behavior
-bool Alerts::tempAlertSent = false;   // True if temp alert active
-bool Alerts::humAlertSent = false;    // True if humidity alert active
+// weatherCfg is written by MqttTask (configureWeather), read by SensorTask
+static portMUX_TYPE cfgMux = portMUX_INITIALIZER_UNLOCKED;
+static const char *NVS_NAMESPACE = "weather";
+static const char *NVS_KEY = "cfg";
 
 /*
- * Check environmental sensor data for threshold violations
+ * Load the weather limits saved by configureWeather()
+ * Called once from setup() before SensorTask starts
+ */
+void Alerts::init() {
+  Preferences prefs;
+  WeatherConfig saved;
+  bool loaded = false;
+  if (prefs.begin(NVS_NAMESPACE, true)) {
+    // A size mismatch means the struct changed since it was saved: use defaults
+    loaded = prefs.getBytesLength(NVS_KEY) == sizeof(saved) && prefs.getBytes(NVS_KEY, &saved, sizeof(saved)) == sizeof(saved);
+    prefs.end();
+  }
+  if (loaded) weatherCfg = saved;
+  
+  char line[160];
+  WeatherRule::describe(weatherCfg, line, sizeof(line));
+  LOGI("ALERT", "Weather limits (%s): %s", loaded ? "NVS" : "defaults", line);
+}
+
+/*
+ * Change weather limits at runtime
  * 
- * Implements a "send-on-crossing" state machine:
- * - Alert sent once when threshold is exceeded (rising edge)
- * - No repeated alerts while value remains high
- * - Alert state resets when value returns to normal
+ * Called from MqttTask with the payload of the IO_CONFIG_FEED feed,
+ * e.g. "temp_high=35 temp_hyst=0.5 hum_dwell=300" (see
+ * WeatherRule::apply). A command is applied whole or not at all; the
+ * accepted limits are saved to NVS. Rule state is kept, so an alert
+ * already raised does not repeat.
+ * 
+ * @param command: Configuration command
+ * @return true if it was applied
+ */
+bool Alerts::configureWeather(const char *command) {
+  portENTER_CRITICAL(&cfgMux);
+  WeatherConfig next = weatherCfg;
+  portEXIT_CRITICAL(&cfgMux);
+  
+  int applied = WeatherRule::apply(next, command);
+  if (applied < 0) {
+    LOGW("ALERT", "⚠ Weather config rejected: '%s'", command);
+    return false;
+  }
+  portENTER_CRITICAL(&cfgMux);
+  weatherCfg = next;
+  portEXIT_CRITICAL(&cfgMux);
+  
+  Preferences prefs;
+  if (!prefs.begin(NVS_NAMESPACE, false) || prefs.putBytes(NVS_KEY, &next, sizeof(next)) != sizeof(next)) {
+    LOGW("ALERT", "⚠ Weather limits not saved - back to previous after reboot");
+  }
+  prefs.end();
+  
+  char line[160];
+  WeatherRule::describe(next, line, sizeof(line));
+  LOGI("ALERT", "✓ Weather limits updated (%d key(s)): %s", applied, line);
+  return true;
+}
+
+/*
+ * Check environmental sensor data for threshold violations
  * 
- * This prevents notification spam during prolonged violations.
+ * The rules live in WeatherRule (see weather_rule.cpp): one alert
+ * per excursion above a limit once it has lasted the dwell time,
+ * re-armed only below the hysteresis band, plus a rate-of-change
+ * alert. This prevents notification spam while a value hovers at a
+ * limit or stays high.
  * 
  * @param data: SensorData struct with temp, humidity, timestamp
  */
 void Alerts::checkWeatherAlerts(SensorData data) {
-  // === Temperature Alert Check ===
-  if (!isnan(data.temp) && data.temp > TEMP_LIMIT) {
-    // Temperature exceeds configured limit
-    if (!tempAlertSent) {
-      // First crossing of threshold - send alert
-      Serial.println("[ALERT] 🌡️  EXTREME TEMPERATURE DETECTED!");
-      
-      // Format alert message with current value and limit
-      String msg = "⚠️ HIGH TEMPERATURE ALERT: " + String(data.temp, 1) + "°C (Limit: " + String(TEMP_LIMIT) + "°C)";
-      
-      // Send to Telegram for immediate user notification
-      Telegram::sendAlert(msg, "");  // No photo for weather alerts
-      
-      // Rate limiting: wait 1s before MQTT publish to respect API limits
-      vTaskDelay(pdMS_TO_TICKS(1000));
-      
-      // Publish to MQTT dashboard feed
-      NetMQTT::publishAlert("high_temperature", "");
-      
-      // Mark alert as sent to prevent repeated notifications
-      tempAlertSent = true;
-    }
-    // else: already sent alert, don't spam while temp remains high
-  } else {
-    // Temperature back to normal or reading invalid
-    tempAlertSent = false; // Reset state for next threshold crossing
+  portENTER_CRITICAL(&cfgMux);
+  WeatherConfig cfg = weatherCfg;
+  portEXIT_CRITICAL(&cfgMux);
+  uint8_t alerts = WeatherRule::evaluate(weather, data, cfg, millis());
+  
+  // === Temperature Alert ===
+  if (alerts & WX_HIGH_TEMP) {
+    LOGI("ALERT", "🌡️  EXTREME TEMPERATURE DETECTED!");
+    
+    // Format alert message with current value and limit
+    char msg[96];
+    snprintf(msg, sizeof(msg), "⚠️ HIGH TEMPERATURE ALERT: %.1f°C (Limit: %.2f°C)", data.temp, cfg.temp.high);
+    
+    // Queue for Telegram notification and MQTT dashboard feed
+    Dispatcher::enqueue("high_temperature", msg);  // No photo for weather alerts
   }
   
-  // === Humidity Alert Check ===
-  // Same logic as temperature but for humidity threshold
-  if (!isnan(data.hum) && data.hum > HUM_LIMIT) {
-    // Humidity exceeds configured limit
-    if (!humAlertSent) {
-      // First crossing of threshold - send alert
-      Serial.println("[ALERT] 💧 EXTREME HUMIDITY DETECTED!");
-      
-      // Format alert message
-      String msg = "⚠️ HIGH HUMIDITY ALERT: " + String(data.hum, 1) + "% (Limit: " + String(HUM_LIMIT) + "%)";
-      
-      // Send to Telegram
-      Telegram::sendAlert(msg, "");
-      
-      // Rate limiting delay
-      vTaskDelay(pdMS_TO_TICKS(1000));
-      
-      // Publish to MQTT
-      NetMQTT::publishAlert("high_humidity", "");
-      
-      // Mark as sent
-      humAlertSent = true;
-    }
-  } else {
-    // Humidity back to normal
-    humAlertSent = false; // Reset state
+  // === Humidity Alert ===
+  if (alerts & WX_HIGH_HUM) {
+    LOGI("ALERT", "💧 EXTREME HUMIDITY DETECTED!");
+    
+    char msg[96];
+    snprintf(msg, sizeof(msg), "⚠️ HIGH HUMIDITY ALERT: %.1f%% (Limit: %.2f%%)", data.hum, cfg.hum.high);
+    Dispatcher::enqueue("high_humidity", msg);
+  }
+  
+  // === Rate-of-Change Alerts ===
+  if (alerts & WX_TEMP_RISING) {
+    LOGI("ALERT", "📈 TEMPERATURE RISING FAST!");
+    char msg[96];
+    snprintf(msg, sizeof(msg), "📈 TEMPERATURE RISING: %.1f°C, +%.1f°C/min", data.temp, WeatherRule::ratePerMin(weather.temp));
+    Dispatcher::enqueue("temperature_rising", msg);
+  }
+  if (alerts & WX_HUM_RISING) {
+    LOGI("ALERT", "📈 HUMIDITY RISING FAST!");
+    char msg[96];
+    snprintf(msg, sizeof(msg), "📈 HUMIDITY RISING: %.1f%%, +%.1f%%/min", data.hum, WeatherRule::ratePerMin(weather.hum));
+    Dispatcher::enqueue("humidity_rising", msg);
   }
 }
 
 /*
  * Handle motion detection alert with photo evidence
  * 
- * Multi-step process:
- * 1. Send Telegram alert with photo and caption
- * 2. Publish text-only alert to MQTT dashboard
- * 3. Log performance metrics
+ * Queues one event for the Dispatcher and returns immediately:
+ * 1. Telegram sender delivers photo with caption
+ * 2. MQTT sender publishes text-only alert to dashboard
  * 
  * Note: Photo is only sent to Telegram (not MQTT) due to:
  * - MQTT payload size limitations
  * - Adafruit IO transfer limits on free tier
  * - Better user experience viewing photos in Telegram
  * 
- * @param photoURL: Camera image URL or JSON with image location
+ * With several cameras the frames go to Telegram as one album. A set
+ * no camera confirmed goes out as text only.
+ * 
+ * @param shots: Frames from CameraClient::captureAll() (URL or mock JSON each,
+ *               plus the optional full-resolution follow-up)
+ * @param triggerMs: millis() of the PIR edge (for delivery latency metrics)
  */
-void Alerts::handleMotionAlert(String photoURL) {
+void Alerts::handleMotionAlert(const CaptureSet &shots, unsigned long triggerMs) {
   unsigned long startTime = millis();  // Track execution time
   
-  Serial.println("\n\n🚨 ========== MOTION ALERT TRIGGERED ========== 🚨");
+  LOG_BANNER("\n\n🚨 ========== MOTION ALERT TRIGGERED ========== 🚨");
   
-  // === Step 1: Send Telegram notification with photo ===
-  Serial.println("[ALERT] Step 1: Sending Telegram notification with photo...");
   // Telegram receives rich alert: photo + "Motion detected" caption
-  // Photo delivery handled by two-path system (URL or multipart upload)
-  Telegram::sendAlert("Motion detected", photoURL);
-  
-  // === Step 2: Publish MQTT alert ===
-  Serial.println("[ALERT] Step 2: Publishing simple alert to MQTT...");
-  // Rate limiting: 1s delay before MQTT to avoid API throttling
-  vTaskDelay(pdMS_TO_TICKS(1000));
-  
-  // MQTT gets text-only alert for dashboard notification
-  // No photo URL - keeps payload small and respects Adafruit IO limits
-  NetMQTT::publishAlert("motion", ""); // No photo URL - Telegram only
+  // MQTT gets text-only alert - keeps payload small for Adafruit IO
+  LOGI("ALERT", "Queueing motion alert for Telegram and MQTT...");
+  bool queued;
+  if (shots.confirmed) {
+    queued = Dispatcher::enqueue("motion", "Motion detected", shots, triggerMs);
+  } else {
+    // The camera saw no change (heat, sunlight - or an intruder it cannot
+    // make out): still alert, but without uploading a photo of nothing
+    queued = Dispatcher::enqueue("motion", "Motion detected by the PIR (not visible on camera)", "", triggerMs);
+  }
   
   // === Performance Logging ===
   unsigned long elapsed = millis() - startTime;
-  Serial.println("[ALERT] ✓ Motion alert sequence completed");
-  Serial.println("[PERF] Total motion alert took: " + String(elapsed) + "ms");
-  Serial.println("🚨 ============================================== 🚨\n");
+  if (queued) {
+    LOGI("ALERT", "✓ Motion alert queued");
+  } else {
+    LOGW("ALERT", "⚠ Motion alert partially dropped (queue full)");
+  }
+  LOGD("PERF", "Motion alert hand-off took: %lums", elapsed);
+  LOG_BANNER("🚨 ============================================== 🚨\n");
+}
+
+/*
+ * Send the summary of a cooldown window
+ * 
+ * Telegram gets the digest caption with the pinned frames as one album
+ * (sendMediaGroup), or as a single photo / text when fewer were kept.
+ * MQTT gets a "motion_summary" alert. No trigger time is passed: the
+ * summary is not a first notice and stays out of the latency metrics.
+ * 
+ * @param digest: Events folded in since the window opened
+ */
+void Alerts::handleMotionSummary(const MotionDigest &digest) {
+  char text[sizeof(AlertEvent::text)];
+  int len = snprintf(text, sizeof(text), "🚨 ");
+  Digest::describe(digest, text + len, sizeof(text) - len);
+  
+  CaptureSet shots;
+  shots.count = 0;
+  shots.followUrl[0] = '\0';
+  shots.confirmed = true;
+  for (int i = 0; i < Digest::photoCount(digest) && shots.count < CAM_MAX_NODES; i++) {
+    strlcpy(shots.urls[shots.count++], Digest::photo(digest, i), sizeof(shots.urls[0]));
+  }
+  
+  LOGI("ALERT", "Cooldown over - sending summary: %s", text);
+  if (!Dispatcher::enqueue("motion_summary", text, shots, 0)) {
+    LOGW("ALERT", "⚠ Motion summary partially dropped (queue full)");
+  }
 }
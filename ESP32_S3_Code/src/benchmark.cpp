@@ -0,0 +1,181 @@
+/*
+ * Benchmark Module - End-to-End Motion Alert Latency
+ * 
+ * Built only with -DBENCHMARK_MODE ([env:benchmark] in platformio.ini).
+ * 
+ * A hardware timer calls the real PIR ISR (onMotion) every
+ * BENCH_PERIOD_MS, so each iteration runs the normal pipeline:
+ *   ISR -> AlertTask -> capture -> Dispatcher -> Telegram / MQTT
+ * 
+ * Every latency sample the pipeline records through Metrics is
+ * copied here, so percentiles are exact rather than bucketed.
+ * When all iterations have been delivered (or given up on) one
+ * machine-readable line is printed:
+ *   BENCH_RESULT {"iterations":50,...,"stages":{"capture":{...}}}
+ * It ends with every task's stack high-water mark after the run
+ * ("stack_free", bytes): TASK_*_STACK in config.h is tuned from these.
+ * 
+ * Run: pio run -e benchmark -t upload && pio device monitor | grep BENCH_RESULT
+ */
+
+#ifdef BENCHMARK_MODE
+
+#include "benchmark.h"
+#include "config.h"
+#include "metrics.h"
+#include "motion.h"
+#include "camera_client.h"
+#include "boot.h"
+#include "logging.h"
+#include <stdlib.h>
+
+// Stages reported, in pipeline order
+static const MetricHist STAGES[] = {
+  H_CAPTURE, H_TG_LOCAL_GET, H_TG_UPLOAD, H_TG_SEND, H_CAM_PUSH, H_MQTT_ALERT, H_MOTION_FIRST_NOTICE, H_MOTION_TO_TG, H_MOTION_TO_MQTT, H_MOTION_WAKE
+};
+static const MetricCounter FAILURES[] = {
+  M_TG_FETCH_FAIL, M_TG_UPLOAD_RETRY, M_TG_SEND_FAIL, M_MQTT_PUBLISH_FAIL, M_ALERT_DROPPED, M_CAM_UNAVAILABLE, M_CAM_LATE
+};
+
+static portMUX_TYPE benchMux = portMUX_INITIALIZER_UNLOCKED;
+static uint32_t samples[M_HIST_COUNT][BENCH_MAX_SAMPLES];
+static uint16_t sampleCount[M_HIST_COUNT];
+static volatile uint32_t edgesFired = 0;
+static hw_timer_t *edgeTimer = nullptr;
+
+/*
+ * Metrics observer - keep every raw sample (first BENCH_MAX_SAMPLES)
+ */
+static void onSample(MetricHist h, uint32_t us) {
+  portENTER_CRITICAL(&benchMux);
+  if (sampleCount[h] < BENCH_MAX_SAMPLES) {
+    samples[h][sampleCount[h]++] = us;
+  }
+  portEXIT_CRITICAL(&benchMux);
+}
+
+/*
+ * Timer ISR - synthetic PIR edge, stops after BENCH_ITERATIONS
+ */
+static void IRAM_ATTR onBenchTick() {
+  if (edgesFired < BENCH_ITERATIONS) {
+    edgesFired++;
+    onMotion();
+  }
+}
+
+static int compareU32(const void *a, const void *b) {
+  uint32_t x = *(const uint32_t *)a, y = *(const uint32_t *)b;
+  return (x > y) - (x < y);
+}
+
+/*
+ * Nearest-rank percentile of a sorted array
+ */
+static uint32_t percentile(const uint32_t *sorted, uint16_t n, uint8_t pct) {
+  if (n == 0) return 0;
+  uint32_t rank = ((uint32_t)pct * n + 99) / 100;
+  return sorted[rank ? rank - 1 : 0];
+}
+
+/*
+ * Print the BENCH_RESULT line
+ * 
+ * Written straight to Serial (not the log ring) so a long line is
+ * never truncated to LOG_LINE_MAX or dropped under load.
+ */
+static void report(uint32_t heapStart, bool timedOut) {
+  static uint32_t sorted[BENCH_MAX_SAMPLES];
+  
+  Serial.printf("BENCH_RESULT {\"build\":\"%s %s\",\"iterations\":%u,\"fired\":%u,\"mock\":%s,"
+                "\"timed_out\":%s,\"unit\":\"us\",\"stages\":{",
+                __DATE__, __TIME__, (unsigned)BENCH_ITERATIONS, (unsigned)edgesFired,
+                CameraClient::isMockMode() ? "true" : "false", timedOut ? "true" : "false");
+  
+  for (size_t i = 0; i < sizeof(STAGES) / sizeof(STAGES[0]); i++) {
+    MetricHist h = STAGES[i];
+    portENTER_CRITICAL(&benchMux);
+    uint16_t n = sampleCount[h];
+    memcpy(sorted, samples[h], n * sizeof(uint32_t));
+    portEXIT_CRITICAL(&benchMux);
+    qsort(sorted, n, sizeof(uint32_t), compareU32);
+    
+    Serial.printf("%s\"%s\":{\"n\":%u,\"p50\":%u,\"p95\":%u,\"p99\":%u,\"max\":%u}",
+                  i ? "," : "", Metrics::histName(h), (unsigned)n,
+                  (unsigned)percentile(sorted, n, 50), (unsigned)percentile(sorted, n, 95),
+                  (unsigned)percentile(sorted, n, 99), (unsigned)(n ? sorted[n - 1] : 0));
+  }
+  
+  uint32_t heapMin = ESP.getMinFreeHeap();
+  Serial.printf("},\"heap\":{\"start\":%u,\"min\":%u,\"peak_used\":%u},\"failures\":{",
+                (unsigned)heapStart, (unsigned)heapMin,
+                (unsigned)(heapStart > heapMin ? heapStart - heapMin : 0));
+  
+  for (size_t i = 0; i < sizeof(FAILURES) / sizeof(FAILURES[0]); i++) {
+    Serial.printf("%s\"%s\":%u", i ? "," : "", Metrics::counterName(FAILURES[i]),
+                  (unsigned)Metrics::counter(FAILURES[i]));
+  }
+  
+  Serial.print("},\"stack_free\":{");
+  for (uint8_t i = 0; i < Metrics::taskCount(); i++) {
+    Serial.printf("%s\"%s\":%u", i ? "," : "", Metrics::taskName(i), (unsigned)Metrics::taskStackFree(i));
+  }
+  Serial.println("}}");
+}
+
+/*
+ * Benchmark task - waits until every edge is accounted for
+ * 
+ * An iteration is done once Telegram accepted it (motion_tg sample)
+ * or the dispatcher gave up on it (alert_drop). A run that stalls
+ * is reported anyway after the timeout, flagged timed_out.
+ */
+static void benchTask(void *pvParameters) {
+  Boot::waitReady(BOOT_CAMERA, portMAX_DELAY);  // WiFi up and cameras probed
+  uint32_t heapStart = ESP.getFreeHeap();
+  uint32_t deadline = millis() + BENCH_ITERATIONS * BENCH_PERIOD_MS + 120000;
+  
+  LOGI("BENCH", "Running %u iterations every %ums (%s camera)", (unsigned)BENCH_ITERATIONS,
+       (unsigned)BENCH_PERIOD_MS, CameraClient::isMockMode() ? "mock" : "real");
+  
+  // 1 MHz timer tick (80 MHz APB / 80), auto-reload every period
+  edgeTimer = timerBegin(0, 80, true);
+  timerAttachInterrupt(edgeTimer, &onBenchTick, true);
+  timerAlarmWrite(edgeTimer, (uint64_t)BENCH_PERIOD_MS * 1000, true);
+  timerAlarmEnable(edgeTimer);
+  
+  bool timedOut = false;
+  while (true) {
+    vTaskDelay(pdMS_TO_TICKS(1000));
+    portENTER_CRITICAL(&benchMux);
+    uint32_t delivered = sampleCount[H_MOTION_TO_TG];
+    portEXIT_CRITICAL(&benchMux);
+    if (delivered + Metrics::counter(M_ALERT_DROPPED) >= BENCH_ITERATIONS) break;
+    if ((int32_t)(millis() - deadline) >= 0) {
+      timedOut = true;
+      break;
+    }
+  }
+  
+  timerAlarmDisable(edgeTimer);
+  timerDetachInterrupt(edgeTimer);
+  timerEnd(edgeTimer);
+  
+  // Let MQTT catch up on the last alert, then get the log out of the way
+  vTaskDelay(pdMS_TO_TICKS(2000));
+  Log::flush();
+  report(heapStart, timedOut);
+  LOG_BANNER("\n✓ BENCHMARK COMPLETE\n");
+  vTaskDelete(NULL);
+}
+
+/*
+ * Start the benchmark (call at the end of setup())
+ */
+void Bench::start() {
+  Metrics::setObserver(onSample);
+  if (BENCH_MOCK) CameraClient::setMockMode(true);
+  xTaskCreatePinnedToCore(benchTask, "BenchTask", 4096, NULL, 1, NULL, 0);
+}
+
+#endif
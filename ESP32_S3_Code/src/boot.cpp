@@ -0,0 +1,155 @@
+/*
+ * Boot Module - Staged Start-Up and Readiness Flags
+ *
+ * setup() only does local work before arming motion detection: frame
+ * pool, offline buffer, weather limits, sensor/MQTT setup (both
+ * non-blocking) and the tasks. Everything that waits on the network
+ * runs afterwards, concurrently:
+ * - BootTask: WiFi association, then power management and NTP, then
+ *   camera discovery and the first /health probe
+ * - SensorTask: DHT22 warm-up inside its first read
+ * - MqttTask: broker connection once WiFi is up
+ *
+ * Each stage sets a readiness flag (an event group bit) the first time
+ * it completes, with its time since reset, so time-to-armed and
+ * time-to-fully-up show in the log. Tasks that need a stage before
+ * they can do anything useful wait on its flag (waitReady).
+ */
+
+#include "boot.h"
+#include "config.h"
+#include "logging.h"
+#include "metrics.h"
+#include "net_wifi.h"
+#include "power.h"
+#include "utils.h"
+#include "camera_client.h"
+#include "camera_nodes.h"
+#include "freertos/event_groups.h"
+
+static const char *STAGE_NAMES[BOOT_STAGE_COUNT] = {
+  "armed", "wifi", "sensors", "mqtt", "camera"
+};
+static const EventBits_t ALL_STAGES = ((EventBits_t)1 << BOOT_STAGE_COUNT) - 1;
+
+static EventGroupHandle_t bootEvents = nullptr;
+static uint32_t readyMs[BOOT_STAGE_COUNT];  // ms since reset, 0 = pending
+static portMUX_TYPE bootMux = portMUX_INITIALIZER_UNLOCKED;
+
+/*
+ * Create the readiness flags
+ * Called from setup() before any task that marks or waits on a stage
+ */
+void Boot::init() {
+  bootEvents = xEventGroupCreate();
+}
+
+/*
+ * Boot task - the network half of the boot sequence
+ *
+ * Runs once and deletes itself. Not under the task watchdog: waiting
+ * for the AP is unbounded, and NetWiFi keeps retrying meanwhile.
+ */
+static void taskBoot(void *pv) {
+  NetWiFi::init();
+  unsigned long wifiWaitStart = millis();
+  while (!NetWiFi::waitConnected(10000)) {
+    LOGI("WIFI", "Still connecting (%lus)", (millis() - wifiWaitStart) / 1000);
+  }
+  Boot::ready(BOOT_WIFI);
+
+  // DFS, modem sleep and light sleep between cycles (POWER_MANAGED
+  // builds); modem sleep needs the station up
+  Power::init();
+
+  // Background NTP; buffered readings are stamped once it completes
+  Utils::syncTime();
+
+  // === Camera Discovery and Connection Check ===
+  LOG_BANNER("=== CAMERA INITIALIZATION ===");
+  LOGI("CAMERA", "Mode: %s", CameraClient::isMockMode() ? "MOCK" : "REAL");
+  if (!CameraClient::isMockMode()) {
+    // Static seed + mDNS discovery, then background /health checks
+    CameraNodes::init();
+    bool cameraOnline = CameraClient::checkConnection();
+    if (!cameraOnline) {
+      // Camera unavailable but system continues with degraded functionality
+      LOGW("CAMERA", "⚠ WARNING: Camera not detected!");
+      LOGI("CAMERA", "System will continue but camera features unavailable");
+      LOGI("CAMERA", "To use mock camera instead, call CameraClient::setMockMode(true)");
+    }
+  } else {
+    LOGI("CAMERA", "Mock mode active - using placeholder images");
+  }
+  Boot::ready(BOOT_CAMERA);
+
+  vTaskDelete(NULL);
+}
+
+/*
+ * Start the network stages in the background
+ * Called from setup() right after motion detection is armed
+ */
+void Boot::startNetwork() {
+  xTaskCreatePinnedToCore(taskBoot, "BootTask", TASK_BOOT_STACK, NULL, TASK_BOOT_PRIO, NULL, TASK_BOOT_CORE);
+}
+
+/*
+ * Mark a boot stage ready
+ *
+ * Safe from any task; only the first call for a stage counts, so
+ * callers may mark on every success (e.g., each MQTT connect). Logs
+ * the full timing line once the last stage is in.
+ */
+void Boot::ready(BootStage s) {
+  if (!bootEvents || s >= BOOT_STAGE_COUNT) return;
+  uint32_t ms = (uint32_t)(Metrics::now() / 1000);
+  portENTER_CRITICAL(&bootMux);
+  bool first = readyMs[s] == 0;
+  if (first) readyMs[s] = ms ? ms : 1;
+  portEXIT_CRITICAL(&bootMux);
+  if (!first) return;
+
+  EventBits_t bits = xEventGroupSetBits(bootEvents, (EventBits_t)1 << s);
+  LOGI("BOOT", "✓ Stage '%s' ready %lu ms after reset", STAGE_NAMES[s], (unsigned long)ms);
+  if ((bits & ALL_STAGES) == ALL_STAGES) logSummary();
+}
+
+bool Boot::isReady(BootStage s) {
+  return bootEvents && (xEventGroupGetBits(bootEvents) & ((EventBits_t)1 << s));
+}
+
+/*
+ * Wait for a boot stage
+ *
+ * @param s: Stage to wait for
+ * @param ticks: Longest wait (watched tasks pass TASK_WDT_FEED_MS)
+ * @return true if the stage is ready
+ */
+bool Boot::waitReady(BootStage s, TickType_t ticks) {
+  if (!bootEvents) return true;
+  EventBits_t bit = (EventBits_t)1 << s;
+  return (xEventGroupWaitBits(bootEvents, bit, pdFALSE, pdTRUE, ticks) & bit) != 0;
+}
+
+/*
+ * Log every stage's time since reset, e.g.
+ * "armed 640 | wifi 1210 | sensors 2650 | mqtt 2980 | camera 1890 ms"
+ */
+void Boot::logSummary() {
+  uint32_t snapshot[BOOT_STAGE_COUNT];
+  portENTER_CRITICAL(&bootMux);
+  memcpy(snapshot, readyMs, sizeof(snapshot));
+  portEXIT_CRITICAL(&bootMux);
+
+  char line[160];
+  size_t len = 0;
+  for (uint8_t s = 0; s < BOOT_STAGE_COUNT && len < sizeof(line); s++) {
+    if (snapshot[s]) {
+      len += snprintf(line + len, sizeof(line) - len, "%s%s %lu", s ? " | " : "", STAGE_NAMES[s], (unsigned long)snapshot[s]);
+    } else {
+      len += snprintf(line + len, sizeof(line) - len, "%s%s pending", s ? " | " : "", STAGE_NAMES[s]);
+    }
+  }
+  LOGI("BOOT", "Stage times (ms after reset): %s", line);
+}
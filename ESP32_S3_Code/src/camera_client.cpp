@@ -7,13 +7,48 @@
  * 2. Mock mode: Returns random images from Lorem Picsum for testing
  * 
  * Real mode provides camera URL for downstream fetch/upload.
- * Connection check validates TCP connectivity and HTTP response.
+ * When the camera runs its pre-trigger frame ring, capture() pins the
+ * frame closest to the PIR trigger so the later fetch returns the image
+ * from the moment of motion, not from after the alert queue drained.
+ * 
+ * The camera adapts frame size to link throughput. The alert image is
+ * the fast one (trigger frame at the adaptive size, or a small live
+ * capture); when that is below CAM_FULL_SIZE a full-resolution
+ * follow-up URL is provided as well.
+ * 
+ * Camera nodes come from CameraNodes (static seed + mDNS discovery,
+ * background /health checks); capture() uses the first healthy node and
+ * falls back to the next one instead of waiting out HTTP timeouts.
+ * 
+ * Multiple cameras (CAM_MULTI_CAPTURE): captureAll() sends /mark to
+ * every online node before reading any reply, so the cameras pin their
+ * frames concurrently and the capture takes as long as the slowest
+ * camera, not the sum. Cameras that miss CAM_CAPTURE_DEADLINE_MS are
+ * left out of the alert.
+ * 
+ * Motion verification (CAM_VERIFY_MOTION): /mark also asks the camera
+ * to difference the pinned frame against one from before the trigger.
+ * A PIR edge that no camera can see in the picture comes back as
+ * unconfirmed, and the alert task sends it as a text-only alert (no
+ * upload). No verdict (older firmware, ring too young, scene too dark
+ * or flat to judge, mock mode) counts as motion.
+ * 
+ * Direct push (CAM_DIRECT_PUSH): instead of relaying the JPEG, the S3
+ * sends the camera a signed capture-and-deliver command and gets a small
+ * receipt back - see deliver().
  */
 
 #include "camera_client.h"
 #include "config.h"
 #include <HTTPClient.h>
 #include <WiFiClient.h>
+#include <ArduinoJson.h>
+#include "logging.h"
+#include "metrics.h"
+#include "http_codec.h"
+#include "mbedtls/md.h"
+#include "camera_nodes.h"
+#include "lan_http.h"
 
 static bool mockMode = false; // Start in real mode by default
 static int mockCaptureCount = 0; // Counter for unique mock URLs
@@ -25,7 +60,7 @@ static int mockCaptureCount = 0; // Counter for unique mock URLs
  */
 void CameraClient::setMockMode(bool enabled) {
   mockMode = enabled;
-  Serial.println(mockMode ? "Camera: MOCK mode enabled" : "Camera: REAL mode enabled");
+  LOGI("CAMERA", "%s mode enabled", mockMode ? "MOCK" : "REAL");
 }
 
 /*
@@ -37,115 +72,413 @@ bool CameraClient::isMockMode() {
 }
 
 /*
- * Test camera connectivity and HTTP responsiveness
+ * Check that at least one camera node is reachable
  * 
- * Process:
- * 1. Establish TCP connection to camera IP on port 80
- * 2. If connected, send HTTP GET request to root path
- * 3. Validate HTTP server responds (any positive code)
+ * One /health pass over the static seed and any mDNS-discovered nodes
+ * (sub-second timeouts each). After boot, CamHealthTask keeps
+ * checking in the background.
  * 
- * Returns true if camera is reachable and HTTP functional
- * Returns false if TCP fails or HTTP unresponsive
+ * Returns true if any camera answered /health
  */
 bool CameraClient::checkConnection() {
-  Serial.println("\n=== CAMERA CONNECTION TEST ===");
-  Serial.println("[CAMERA] Testing connection to: " + String(CAM_IP));
-  Serial.println("[CAMERA] Port: 80");
+  LOG_BANNER("\n=== CAMERA CONNECTION TEST ===");
+  bool online = CameraNodes::checkAll();
   
-  WiFiClient testClient;
-  testClient.setTimeout(5000); // 5-second TCP connection timeout
-  
-  Serial.print("[CAMERA] Attempting to connect");
-  
-  // Step 1: Test TCP connection to camera
-  bool connected = testClient.connect(CAM_IP, 80);
-  
-  if (connected) {
-    Serial.println(" ✓");
-    Serial.println("[CAMERA] ✓✓✓ Camera is ONLINE and reachable! ✓✓✓");
-    testClient.stop();
-    
-    // Step 2: Verify HTTP server is responding
-    Serial.println("[CAMERA] Testing HTTP response...");
-    WiFiClient client;
-    HTTPClient http;
-    http.setTimeout(5000); // 5-second HTTP timeout
-    http.begin(client, "http://" + String(CAM_IP) + "/");
-    int httpCode = http.GET();
-    http.end();
-    
-    if (httpCode > 0) {
-      // HTTP server responded (any positive code is acceptable)
-      Serial.println("[CAMERA] ✓ HTTP server responding (code: " + String(httpCode) + ")");
-      Serial.println("[CAMERA] Camera web server is functional!");
-      return true;
+  for (int i = 0; i < CameraNodes::count(); i++) {
+    CameraNode n;
+    if (!CameraNodes::get(i, n)) continue;
+    if (n.online) {
+      LOGI("CAMERA", "✓ %s at %s:%u online (/health %ums)", n.name, n.host, (unsigned)n.port, (unsigned)n.rttMs);
     } else {
-      // TCP connected but HTTP not responding
-      Serial.println("[CAMERA] ⚠ Connected but HTTP not responding");
-      Serial.println("[CAMERA] Camera may be booting up...");
-      return false;
+      LOGW("CAMERA", "⚠ %s at %s:%u not answering", n.name, n.host, (unsigned)n.port);
     }
-  } else {
-    // TCP connection failed
-    Serial.println(" ✗");
-    Serial.println("[CAMERA] ✗✗✗ Camera is OFFLINE or unreachable! ✗✗✗");
-    Serial.println("[CAMERA] Troubleshooting steps:");
-    Serial.println("[CAMERA]   1. Check camera power supply");
-    Serial.println("[CAMERA]   2. Verify camera is on same WiFi network: " + String(WIFI_SSID));
-    Serial.println("[CAMERA]   3. Confirm camera IP is: " + String(CAM_IP));
-    Serial.println("[CAMERA]   4. Check if camera WiFi LED is blinking/solid");
-    Serial.println("[CAMERA]   5. Try pinging camera from computer: ping " + String(CAM_IP));
-    return false;
   }
+  
+  if (!online) {
+    LOGE("CAMERA", "✗✗✗ No camera is reachable! ✗✗✗");
+    LOGI("CAMERA", "Troubleshooting steps:");
+    LOGI("CAMERA", "  1. Check camera power supply");
+    LOGI("CAMERA", "  2. Verify camera is on same WiFi network: %s", WIFI_SSID);
+    LOGI("CAMERA", "  3. Static camera IP is: %s (mDNS service _%s._tcp)", CAM_IP, CAM_MDNS_SERVICE);
+    LOGI("CAMERA", "  4. Check if camera WiFi LED is blinking/solid");
+    LOGI("CAMERA", "Health checks continue in the background");
+  }
+  return online;
 }
 
 /*
  * Generate mock camera capture for testing
- * Returns JSON with URL to random placeholder image
+ * Writes JSON with URL to random placeholder image
  * Each call increments counter for unique image URLs
+ * 
+ * @param out: receives {"url":"https://picsum.photos/..."}
+ * @param cap: size of out
  */
-String CameraClient::captureMock() {
+void CameraClient::captureMock(char *out, size_t cap) {
   mockCaptureCount++;
-  Serial.println("\n=== CAMERA MOCK CAPTURE ===");
-  Serial.println("[MOCK] Capture count: #" + String(mockCaptureCount));
+  LOG_BANNER("\n=== CAMERA MOCK CAPTURE ===");
+  LOGI("MOCK", "Capture count: #%d", mockCaptureCount);
   
-  // Generate URL to Lorem Picsum random image service
-  // Query parameter ensures unique image each time
-  String mockUrl = "https://picsum.photos/640/480?random=" + String(mockCaptureCount);
-  Serial.println("[MOCK] Generated URL: " + mockUrl);
-  Serial.println("[MOCK] Returning JSON response");
+  // Lorem Picsum random image service; the query makes each image unique.
+  // Same JSON format as real camera would return
+  snprintf(out, cap, "{\"url\":\"https://picsum.photos/640/480?random=%d\"}", mockCaptureCount);
+  LOGI("MOCK", "Returning JSON response: %s", out);
+}
+
+/*
+ * Read the camera's frame-difference verdict from a /mark reply
+ * 
+ * @param doc: parsed /mark reply
+ * @param name: camera name for the log
+ * @return false only if the camera checked and saw no motion
+ */
+static bool motionConfirmed(const JsonDocument &doc, const char *name) {
+  JsonObjectConst motion = doc["motion"];
+  if (motion.isNull()) return true;  // Not checked - fail open
+  bool confirmed = motion["confirmed"] | true;
+  LOGI("CAMERA", "%s %s: %d/%d cells changed", name, confirmed ? "confirms motion" : "sees no motion",
+       motion["cells"].as<int>(), motion["of"].as<int>());
+  return confirmed;
+}
+
+/*
+ * Pin the camera's buffered frame closest to the trigger time
+ * 
+ * Sends /mark?ago=<ms> to the camera's frame ring. Both boards measure
+ * the same elapsed time, so no clock sync is needed. The camera holds
+ * the chosen frame for 90 s and returns its id and capture profile,
+ * plus its motion verdict with CAM_VERIFY_MOTION.
+ * 
+ * @param base: "http://<host>:<port>" of the camera node
+ * @param triggerMs: millis() of the PIR edge on this board
+ * @param url: receives the URL of the pinned frame
+ * @param cap: size of url
+ * @param fullRes: set true if the frame was captured at CAM_FULL_SIZE
+ * @param confirmed: set false if the camera saw no motion in the frame
+ * @return 200 when a frame was pinned; other HTTP codes mean the ring is
+ *         unavailable, negative means the camera could not be reached
+ */
+static int markTriggerFrame(const char *base, unsigned long triggerMs, char *url, size_t cap, bool *fullRes, bool *confirmed) {
+  unsigned long ago = millis() - triggerMs;
+  char markUrl[96];
+  snprintf(markUrl, sizeof(markUrl), "%s/mark?ago=%lu%s", base, ago, CAM_VERIFY_MOTION ? "&verify=1" : "");
+  
+  WiFiClient client;
+  HTTPClient http;
+  http.setConnectTimeout(CAM_HEALTH_TIMEOUT_MS); // Node passed /health recently - fail fast
+  http.setTimeout(1500); // LAN round trip - fail fast and fall back to /jpg
+  http.begin(client, markUrl);
+  int code = http.GET();
+  char body[192] = "";
+  if (code == 200) {
+    // Known length: the camera keeps the socket open, so reading to
+    // the end would wait out the whole timeout
+    int len = http.getSize();
+    size_t want = (len > 0 && (size_t)len < sizeof(body)) ? (size_t)len : sizeof(body) - 1;
+    size_t n = http.getStream().readBytes(body, want);
+    body[n] = '\0';
+  }
+  http.end();
   
-  // Return in same JSON format as real camera would
-  return "{\"url\":\"" + mockUrl + "\"}";
+  if (code != 200) {
+    LOGW("CAMERA", "Frame ring unavailable (code: %d) - using live capture", code);
+    return code;
+  }
+  
+  StaticJsonDocument<256> doc;
+  if (deserializeJson(doc, body) || !doc.containsKey("id")) {
+    LOGE("CAMERA", "✗ Unexpected /mark response: %s", body);
+    return 0;
+  }
+  uint32_t id = doc["id"].as<uint32_t>();
+  long offset = doc["offset"].as<long>();
+  const char *profile = doc["profile"] | CAM_FULL_SIZE;  // Older camera firmware: full size only
+  *fullRes = strcmp(profile, CAM_FULL_SIZE) == 0;
+  LOGI("CAMERA", "Pinned frame #%u at %s (%ldms from trigger, trigger was %lums ago)", (unsigned)id, profile, offset, ago);
+  snprintf(url, cap, "%s/frame?id=%u", base, (unsigned)id);
+  *confirmed = motionConfirmed(doc, base);
+  return 200;
 }
 
 /*
  * Capture photo from camera
  * 
- * Mock mode: Returns JSON with Lorem Picsum placeholder URL
- * Real mode: Returns direct HTTP URL to camera's /jpg endpoint
+ * Mock mode: Writes JSON with Lorem Picsum placeholder URL
+ * Real mode: Writes direct HTTP URL to the camera image on the first
+ *   healthy node (see CameraNodes), "" if no camera is online
+ *   - Frame ring: /frame?id=<n> for the frame closest to triggerMs
+ *   - Otherwise:  /jpg?size=CAM_ALERT_SIZE for a fast fresh capture
+ *   followUrl gets /jpg?size=CAM_FULL_SIZE unless the image is already full size
  * 
  * Real mode URL is used by Telegram module to fetch image bytes
  * for multipart upload (required for private IP cameras)
+ * 
+ * @param triggerMs: millis() of the PIR edge that caused the alert
+ * @param url: receives the URL or mock JSON
+ * @param cap: size of url
+ * @param followUrl: optional, receives the full-resolution follow-up URL or ""
+ * @param followCap: size of followUrl
+ * @param confirmed: optional, set false if the camera saw no motion
  */
-String CameraClient::capture() {
-  unsigned long startTime = millis();
+void CameraClient::capture(unsigned long triggerMs, char *url, size_t cap, char *followUrl, size_t followCap,
+                           bool *confirmed) {
+  uint64_t startUs = Metrics::now();
+  if (followUrl && followCap) followUrl[0] = '\0';
+  bool seen = true;
+  if (confirmed) *confirmed = true;
   
   if (mockMode) {
     // Mock mode: Generate placeholder image URL
-    String result = captureMock();
-    unsigned long elapsed = millis() - startTime;
-    Serial.println("[PERF] Mock camera capture took: " + String(elapsed) + "ms");
-    return result;
+    captureMock(url, cap);
+    Metrics::observeSince(H_CAPTURE, startUs);
+    return;
   }
 
-  // Real mode: Build camera JPEG endpoint URL
-  // URL format: http://CAM_IP/jpg (e.g., http://192.168.1.100/jpg)
-  String url = "http://" + String(CAM_IP) + "/jpg";
-  Serial.println("[CAMERA] Providing camera URL: " + url);
+  // Pick a healthy node; if it cannot be reached, try the next one
+  CameraNode node;
+  char base[56];
+  bool fullRes = false;
+  int idx = -1;
+  url[0] = '\0';
+  for (int attempt = 0; attempt < 2 && url[0] == '\0'; attempt++) {
+    idx = CameraNodes::pick(node, idx);
+    if (idx < 0) break;
+    snprintf(base, sizeof(base), "http://%s:%u", node.host, (unsigned)node.port);
+    
+    int code = CAM_FRAME_RING ? markTriggerFrame(base, triggerMs, url, cap, &fullRes, &seen) : 0;
+    if (code < 0) {
+      CameraNodes::reportFailure(idx);  // Unreachable - move on
+      url[0] = '\0';
+      continue;
+    }
+    if (code != 200) {
+      // Live capture: camera JPEG endpoint at the small alert profile
+      // URL format: http://<cam>:80/jpg?size=qvga&q=14
+      snprintf(url, cap, "%s/jpg?size=%s&q=%d", base, CAM_ALERT_SIZE, CAM_ALERT_QUALITY);
+      fullRes = strcmp(CAM_ALERT_SIZE, CAM_FULL_SIZE) == 0;
+    }
+  }
   
-  unsigned long elapsed = millis() - startTime;
-  Serial.println("[PERF] Built camera URL in: " + String(elapsed) + "ms");
+  if (url[0] == '\0') {
+    // Fail fast: the alert goes out as text instead of waiting on timeouts
+    LOGE("CAMERA", "✗ No camera online - alert will be sent without a photo");
+    Metrics::count(M_CAM_UNAVAILABLE);
+    Metrics::observeSince(H_CAPTURE, startUs);
+    return;
+  }
+  LOGI("CAMERA", "Providing camera URL: %s", url);
+  if (confirmed) *confirmed = seen;
   
-  return url; // Return URL for downstream fetch/upload
-}
\ No newline at end of file
+  if (followUrl && followCap && !fullRes && CAM_FULL_SIZE[0]) {
+    snprintf(followUrl, followCap, "%s/jpg?size=%s&q=%d", base, CAM_FULL_SIZE, CAM_FULL_QUALITY);
+    LOGI("CAMERA", "Full-resolution follow-up: %s", followUrl);
+  }
+  Metrics::observeSince(H_CAPTURE, startUs);
+}
+
+/*
+ * Capture from every online camera in parallel
+ * 
+ * Process:
+ * 1. Send /mark?ago=<ms> to each online node without waiting (LanHttp)
+ * 2. Collect the replies until CAM_CAPTURE_DEADLINE_MS; a node that
+ *    answers without a ring gets a live /jpg URL, a node that cannot be
+ *    reached is reported to CameraNodes, a node that is too slow is
+ *    left out (M_CAM_LATE)
+ * 3. The first node in table order that answered is the primary camera:
+ *    two-stage placement, fallbacks and the full-resolution follow-up
+ *    use it
+ * 
+ * Mock mode, a single online camera and CAM_MULTI_CAPTURE 0 all take
+ * the single-camera capture() path, which also retries another node.
+ * 
+ * @param triggerMs: millis() of the PIR edge that caused the alert
+ * @param set: receives one URL per camera, primary first
+ */
+void CameraClient::captureAll(unsigned long triggerMs, CaptureSet &set) {
+  set.count = 0;
+  set.urls[0][0] = '\0';
+  set.followUrl[0] = '\0';
+  set.confirmed = true;
+  
+  CameraNode nodes[CAM_MAX_NODES];
+  int index[CAM_MAX_NODES];
+  int online = 0;
+  for (int i = 0; i < CameraNodes::count() && online < CAM_MAX_NODES; i++) {
+    if (CameraNodes::get(i, nodes[online]) && nodes[online].online) index[online++] = i;
+  }
+  
+  if (mockMode || !CAM_MULTI_CAPTURE || !CAM_FRAME_RING || online < 2) {
+    capture(triggerMs, set.urls[0], sizeof(set.urls[0]), set.followUrl, sizeof(set.followUrl), &set.confirmed);
+    set.count = set.urls[0][0] ? 1 : 0;
+    return;
+  }
+  uint64_t startUs = Metrics::now();
+  LOGI("CAMERA", "Capturing from %d cameras in parallel", online);
+  
+  // === STEP 1: Fire every /mark before reading any reply ===
+  unsigned long ago = millis() - triggerMs;
+  HttpFetch marks[CAM_MAX_NODES];
+  char base[CAM_MAX_NODES][48];
+  for (int i = 0; i < online; i++) {
+    snprintf(base[i], sizeof(base[i]), "http://%s:%u", nodes[i].host, (unsigned)nodes[i].port);
+    char markUrl[96];
+    snprintf(markUrl, sizeof(markUrl), "%s/mark?ago=%lu%s", base[i], ago, CAM_VERIFY_MOTION ? "&verify=1" : "");
+    if (!LanHttp::request(marks[i], markUrl, CAM_HEALTH_TIMEOUT_MS)) {
+      LOGW("CAMERA", "⚠ %s unreachable - left out", nodes[i].name);
+      CameraNodes::reportFailure(index[i]);
+    }
+  }
+  
+  // === STEP 2: Collect replies until the deadline ===
+  unsigned long deadline = millis() + CAM_CAPTURE_DEADLINE_MS;
+  bool seen = false;  // Any camera that answered saw motion or could not tell
+  for (int i = 0; i < online; i++) {
+    if (!marks[i].requested) continue;
+    long len = -1;
+    int code = LanHttp::response(marks[i], &len, deadline);
+    char body[192] = "";
+    if (code == 200) LanHttp::readBody(marks[i], body, sizeof(body), len, deadline);
+    marks[i].client.stop();
+    
+    char *url = set.urls[set.count];
+    bool fullRes = false;
+    StaticJsonDocument<256> doc;
+    if (code < 0) {
+      LOGW("CAMERA", "⚠ %s missed the %ums capture deadline - left out", nodes[i].name, (unsigned)CAM_CAPTURE_DEADLINE_MS);
+      Metrics::count(M_CAM_LATE);
+      continue;
+    } else if (code == 200 && !deserializeJson(doc, body) && doc.containsKey("id")) {
+      const char *profile = doc["profile"] | CAM_FULL_SIZE;
+      fullRes = strcmp(profile, CAM_FULL_SIZE) == 0;
+      snprintf(url, CAM_URL_LEN, "%s/frame?id=%u", base[i], doc["id"].as<unsigned>());
+      if (motionConfirmed(doc, nodes[i].name)) seen = true;
+    } else {
+      // Ring unavailable on this node: small live capture instead
+      snprintf(url, CAM_URL_LEN, "%s/jpg?size=%s&q=%d", base[i], CAM_ALERT_SIZE, CAM_ALERT_QUALITY);
+      fullRes = strcmp(CAM_ALERT_SIZE, CAM_FULL_SIZE) == 0;
+      seen = true;
+    }
+    LOGI("CAMERA", "%s: %s", nodes[i].name, url);
+    if (set.count == 0 && !fullRes && CAM_FULL_SIZE[0]) {
+      snprintf(set.followUrl, sizeof(set.followUrl), "%s/jpg?size=%s&q=%d", base[i], CAM_FULL_SIZE, CAM_FULL_QUALITY);
+    }
+    set.count++;
+  }
+  
+  set.confirmed = seen || set.count == 0;
+  if (set.count == 0) {
+    LOGE("CAMERA", "✗ No camera answered - alert will be sent without a photo");
+    Metrics::count(M_CAM_UNAVAILABLE);
+  } else {
+    LOGI("CAMERA", "%u/%d cameras captured in %ums%s", (unsigned)set.count, online,
+         (unsigned)((Metrics::now() - startUs) / 1000), set.followUrl[0] ? " (full-res follow-up queued)" : "");
+  }
+  Metrics::observeSince(H_CAPTURE, startUs);
+}
+
+/*
+ * GET a small JSON reply from the camera
+ * 
+ * @return HTTP status (body NUL-terminated in out), or negative on failure
+ */
+static int cameraGetJson(const char *url, uint16_t timeoutMs, char *out, size_t cap) {
+  WiFiClient client;
+  HTTPClient http;
+  http.setTimeout(timeoutMs);
+  http.begin(client, url);
+  int code = http.GET();
+  out[0] = '\0';
+  if (code > 0) {
+    // Known length: stop there instead of waiting out the stream timeout
+    int len = http.getSize();
+    size_t want = (len > 0 && (size_t)len < cap) ? (size_t)len : cap - 1;
+    size_t n = http.getStream().readBytes(out, want);
+    out[n] = '\0';
+  }
+  http.end();
+  return code;
+}
+
+/*
+ * Have the camera upload a frame to Telegram itself
+ * 
+ * Process:
+ * 1. GET /nonce from the camera that serves imageUrl (single-use challenge),
+ *    on its CAM_DELIVER_PORT
+ * 2. Sign "deliver\n<nonce>\n<src>\n<reply>\n<caption>" with
+ *    HMAC-SHA256(CAM_DELIVER_KEY); src is imageUrl's query
+ *    ("id=<seq>" for a pinned frame, "size=..&q=.." for a live capture)
+ * 3. GET /deliver with the signed fields; the camera uploads from its
+ *    PSRAM frame buffer and answers with a receipt
+ * 
+ * Frame bytes cross the air once and never enter the S3's heap.
+ * 
+ * @param imageUrl: Camera URL from capture() (http://<cam>/frame?id=.. or /jpg?..)
+ * @param caption: Photo caption
+ * @param replyTo: message_id to thread the photo under (0 = none)
+ * @param messageId: Receives the photo's message_id from the receipt
+ * @return Telegram HTTP status from the receipt, or negative on local failure
+ *         (-1 camera unreachable or refused, -3 unreadable receipt)
+ */
+int CameraClient::deliver(const char *imageUrl, const char *caption, long replyTo, long *messageId) {
+  uint64_t startUs = Metrics::now();
+  *messageId = 0;
+  
+  char host[40];
+  unsigned port;
+  const char *path;
+  if (!HttpCodec::splitHttpUrl(imageUrl, host, sizeof(host), &port, &path)) return -1;
+  const char *query = strchr(path, '?');
+  const char *src = query ? query + 1 : "";
+  
+  // === STEP 1: Challenge ===
+  char url[768];
+  char body[160];
+  // Not on the alert port: the upload runs in the camera's handler and
+  // would hold up its /mark and /health for seconds
+  snprintf(url, sizeof(url), "http://%s:%u/nonce", host, (unsigned)CAM_DELIVER_PORT);
+  int code = cameraGetJson(url, 1500, body, sizeof(body));
+  StaticJsonDocument<192> doc;
+  if (code != 200 || deserializeJson(doc, body) || !doc.containsKey("nonce")) {
+    LOGW("CAMERA", "⚠ No delivery nonce from camera (code: %d)", code);
+    return -1;
+  }
+  char nonce[20];
+  strlcpy(nonce, doc["nonce"] | "", sizeof(nonce));
+  
+  // === STEP 2: Sign the command ===
+  char message[320];
+  int msgLen = snprintf(message, sizeof(message), "deliver\n%s\n%s\n%ld\n%s", nonce, src, replyTo > 0 ? replyTo : 0L, caption);
+  if (msgLen <= 0 || (size_t)msgLen >= sizeof(message)) return -1;
+  uint8_t mac[32];
+  mbedtls_md_hmac(mbedtls_md_info_from_type(MBEDTLS_MD_SHA256),
+                  (const uint8_t *)CAM_DELIVER_KEY, strlen(CAM_DELIVER_KEY),
+                  (const uint8_t *)message, msgLen, mac);
+  char sig[65];
+  HttpCodec::hexEncode(mac, sizeof(mac), sig, sizeof(sig));
+  
+  // === STEP 3: Deliver and read the receipt ===
+  size_t n = snprintf(url, sizeof(url), "http://%s:%u/deliver?nonce=%s&reply=%ld&sig=%s&src=",
+                      host, (unsigned)CAM_DELIVER_PORT, nonce, replyTo > 0 ? replyTo : 0L, sig);
+  n += HttpCodec::urlEncode(src, url + n, sizeof(url) - n);
+  if (n < sizeof(url)) n += strlcpy(url + n, "&caption=", sizeof(url) - n);
+  if (n < sizeof(url)) HttpCodec::urlEncode(caption, url + n, sizeof(url) - n);
+  
+  // The camera answers after its Telegram upload finishes
+  code = cameraGetJson(url, 30000, body, sizeof(body));
+  Metrics::observeSince(H_CAM_PUSH, startUs);
+  if (code != 200) {
+    LOGE("CAMERA", "✗ Direct delivery refused (code: %d) %s", code, body);
+    return -1;
+  }
+  if (deserializeJson(doc, body) || !doc.containsKey("status")) {
+    LOGE("CAMERA", "✗ Unreadable delivery receipt: %s", body);
+    return -3;
+  }
+  int status = doc["status"].as<int>();
+  *messageId = doc["message_id"].as<long>();
+  LOGI("CAMERA", "Delivery receipt: status %d, message %ld, %u bytes in %ums", status, *messageId,
+       doc["bytes"].as<unsigned>(), doc["ms"].as<unsigned>());
+  return status;
+}
@@ -0,0 +1,244 @@
+/*
+ * Camera Nodes Module - Discovery and Health Monitoring
+ * 
+ * Keeps a small table of ESP32-CAM nodes:
+ * - CAM_IP as a static seed (optional, "" to rely on discovery)
+ * - Nodes advertising _esp32cam._tcp over mDNS, re-queried every
+ *   CAM_DISCOVERY_MS so a camera that got a new DHCP lease is found again
+ * 
+ * CamHealthTask pings each node's lightweight /health endpoint every
+ * CAM_HEALTH_MS with sub-second timeouts. Capture reads the table and
+ * fails fast (or moves to another node) instead of discovering a dead
+ * camera mid-alert through long HTTP timeouts.
+ */
+
+#include "camera_nodes.h"
+#include "config.h"
+#include <HTTPClient.h>
+#include <WiFiClient.h>
+#include <ESPmDNS.h>
+#include "logging.h"
+#include "metrics.h"
+#include "scheduler.h"
+
+static const uint8_t OFFLINE_AFTER = 2;  // Consecutive failures before a node is offline
+
+static CameraNode nodes[CAM_MAX_NODES];
+static int nodeCount = 0;
+static portMUX_TYPE nodesMux = portMUX_INITIALIZER_UNLOCKED;
+static bool mdnsReady = false;
+
+/*
+ * Add a node, or move a known one to its new address
+ * 
+ * In order:
+ * 1. host:port already known - nothing to do
+ * 2. Same mDNS hostname at a new address (new DHCP lease) - the entry
+ *    is updated in place, so the old address leaves no dead entry
+ * 3. Free slot - new entry
+ * 4. Table full - the discovered node offline the longest is replaced
+ *    (never an online node or the static seed)
+ * 
+ * @return index of the (new or existing) node, -1 if the table is full
+ */
+static int addNode(const char *host, uint16_t port, const char *name) {
+  bool discovered = strcmp(name, "static") != 0;
+  portENTER_CRITICAL(&nodesMux);
+  int idx = -1;
+  for (int i = 0; i < nodeCount; i++) {
+    if (nodes[i].port == port && strcmp(nodes[i].host, host) == 0) {
+      portEXIT_CRITICAL(&nodesMux);
+      return i;
+    }
+    if (idx < 0 && discovered && strcmp(nodes[i].name, name) == 0) idx = i;
+  }
+  const char *action = "Moved";
+  if (idx < 0 && nodeCount < CAM_MAX_NODES) {
+    idx = nodeCount++;
+    action = "Tracking";
+  } else if (idx < 0) {
+    for (int i = 0; i < nodeCount; i++) {
+      if (nodes[i].online || strcmp(nodes[i].name, "static") == 0) continue;
+      if (idx < 0 || (long)(nodes[i].lastSeen - nodes[idx].lastSeen) < 0) idx = i;  // 0 = never seen: oldest
+    }
+    action = "Replaced an offline node with";
+  }
+  if (idx >= 0) {
+    CameraNode &n = nodes[idx];
+    strlcpy(n.host, host, sizeof(n.host));
+    n.port = port;
+    strlcpy(n.name, name, sizeof(n.name));
+    n.online = false;
+    n.failures = 0;
+    n.rttMs = 0;
+    n.lastSeen = 0;
+  }
+  portEXIT_CRITICAL(&nodesMux);
+  if (idx >= 0) {
+    LOGI("CAMNODE", "%s %s at %s:%u", action, name, host, (unsigned)port);
+  } else {
+    LOGW("CAMNODE", "⚠ Node table full - %s at %s:%u not tracked", name, host, (unsigned)port);
+  }
+  return idx;
+}
+
+/*
+ * Look for cameras advertising _esp32cam._tcp
+ * Blocks for the mDNS query window, so only called from CamHealthTask or boot
+ */
+static void discover() {
+  if (!mdnsReady) return;
+  int found = MDNS.queryService(CAM_MDNS_SERVICE, "tcp");
+  for (int i = 0; i < found; i++) {
+    String ip = MDNS.IP(i).toString();
+    addNode(ip.c_str(), MDNS.port(i), MDNS.hostname(i).c_str());
+  }
+  LOGD("CAMNODE", "mDNS query: %d camera(s) answering", found);
+}
+
+/*
+ * GET /health on one node with sub-second timeouts
+ * 
+ * @return true if the node answered 200
+ */
+static bool probe(int idx) {
+  CameraNode n;
+  if (!CameraNodes::get(idx, n)) return false;
+  char url[64];
+  snprintf(url, sizeof(url), "http://%s:%u/health", n.host, (unsigned)n.port);
+  
+  WiFiClient client;
+  HTTPClient http;
+  http.setConnectTimeout(CAM_HEALTH_TIMEOUT_MS);
+  http.setTimeout(CAM_HEALTH_TIMEOUT_MS);
+  unsigned long t0 = millis();
+  http.begin(client, url);
+  int code = http.GET();
+  http.end();
+  uint16_t rtt = (uint16_t)min(millis() - t0, 65535UL);
+  bool ok = code == 200;
+  
+  portENTER_CRITICAL(&nodesMux);
+  CameraNode &live = nodes[idx];
+  bool wasOnline = live.online;
+  if (ok) {
+    live.failures = 0;
+    live.online = true;
+    live.rttMs = rtt;
+    live.lastSeen = millis();
+  } else {
+    if (live.failures < 255) live.failures++;
+    if (live.failures >= OFFLINE_AFTER) live.online = false;
+  }
+  bool isOnline = live.online;
+  portEXIT_CRITICAL(&nodesMux);
+  
+  if (isOnline && !wasOnline) LOGI("CAMNODE", "✓ %s (%s) online, /health in %ums", n.name, n.host, (unsigned)rtt);
+  if (!isOnline && wasOnline) {
+    LOGW("CAMNODE", "⚠ %s (%s) offline (code: %d)", n.name, n.host, code);
+    Metrics::count(M_CAM_OFFLINE);
+  }
+  return ok;
+}
+
+/*
+ * Check every node once
+ * 
+ * @return true if at least one node is online afterwards
+ */
+bool CameraNodes::checkAll() {
+  bool any = false;
+  for (int i = 0; i < count(); i++) {
+    any |= probe(i);
+  }
+  return any;
+}
+
+/*
+ * Health task - periodic /health checks, periodic re-discovery
+ */
+static void taskHealth(void *pv) {
+  Scheduler::watchCurrentTask();
+  unsigned long lastDiscovery = millis();
+  for (;;) {
+    Scheduler::feedWatchdog();
+    if (millis() - lastDiscovery >= CAM_DISCOVERY_MS) {
+      discover();
+      lastDiscovery = millis();
+    }
+    CameraNodes::checkAll();
+    vTaskDelay(pdMS_TO_TICKS(CAM_HEALTH_MS));
+  }
+}
+
+/*
+ * Seed the static node, run the first discovery and start CamHealthTask
+ * Called once from setup() after WiFi is up
+ */
+void CameraNodes::init() {
+  if (CAM_IP[0]) addNode(CAM_IP, CAM_PORT, "static");
+  
+  char host[24];
+  snprintf(host, sizeof(host), "esp32s3-%06x", (unsigned)(ESP.getEfuseMac() & 0xFFFFFF));
+  mdnsReady = MDNS.begin(host);
+  if (!mdnsReady) LOGW("CAMNODE", "⚠ mDNS unavailable - using static camera only");
+  discover();
+  
+  xTaskCreatePinnedToCore(taskHealth, "CamHealthTask", TASK_CAM_HEALTH_STACK, NULL, TASK_CAM_HEALTH_PRIO, NULL, TASK_CAM_HEALTH_CORE);
+}
+
+/*
+ * Pick the camera to capture from: first online node in table order
+ * (static seed first), skipping one that just failed
+ * 
+ * @param out: Receives a copy of the node
+ * @param skip: Index to pass over (-1 = none)
+ * @return node index, or -1 if no node is online
+ */
+int CameraNodes::pick(CameraNode &out, int skip) {
+  int idx = -1;
+  portENTER_CRITICAL(&nodesMux);
+  for (int i = 0; i < nodeCount; i++) {
+    if (i != skip && nodes[i].online) {
+      out = nodes[i];
+      idx = i;
+      break;
+    }
+  }
+  portEXIT_CRITICAL(&nodesMux);
+  return idx;
+}
+
+/*
+ * The capture path could not reach a node: take it out of rotation
+ * right away instead of waiting for the next health pass
+ */
+void CameraNodes::reportFailure(int idx) {
+  if (idx < 0) return;
+  portENTER_CRITICAL(&nodesMux);
+  bool wasOnline = idx < nodeCount && nodes[idx].online;
+  if (idx < nodeCount) {
+    nodes[idx].online = false;
+    nodes[idx].failures = OFFLINE_AFTER;
+  }
+  portEXIT_CRITICAL(&nodesMux);
+  if (wasOnline) {
+    LOGW("CAMNODE", "⚠ Node %d failed during capture - offline until next /health", idx);
+    Metrics::count(M_CAM_OFFLINE);
+  }
+}
+
+int CameraNodes::count() {
+  portENTER_CRITICAL(&nodesMux);
+  int n = nodeCount;
+  portEXIT_CRITICAL(&nodesMux);
+  return n;
+}
+
+bool CameraNodes::get(int idx, CameraNode &out) {
+  portENTER_CRITICAL(&nodesMux);
+  bool ok = idx >= 0 && idx < nodeCount;
+  if (ok) out = nodes[idx];
+  portEXIT_CRITICAL(&nodesMux);
+  return ok;
+}
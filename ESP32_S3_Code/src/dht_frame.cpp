@@ -0,0 +1,57 @@
+/*
+ * DHT Frame Module - DHT22 Reply Decoding
+ * 
+ * Turns the high-pulse widths of one DHT22 reply into temperature and
+ * humidity. The pulses are timed by the RMT peripheral (sensors.cpp),
+ * so this is pure decoding, kept free of I/O so it can be unit tested
+ * on the host ([env:native]).
+ * 
+ * Reply on the wire, after the host start signal:
+ *   80us low, 80us high (response), then 40 bits of 50us low + high,
+ *   where a ~26us high is a 0 and a ~70us high is a 1, MSB first.
+ */
+
+#include "dht_frame.h"
+
+/*
+ * Decode one reply
+ * 
+ * Only the last DHT_FRAME_BITS pulses are data: anything before them
+ * (line release, 80us response) is skipped, so the capture may start
+ * early.
+ * 
+ * @param highUs: Widths of the high pulses in order (microseconds)
+ * @param count: Number of pulses
+ * @param temp: Receives the temperature in Celsius (set only on DHT_OK)
+ * @param hum: Receives the relative humidity in percent (set only on DHT_OK)
+ * @return DHT_OK or the reason the frame was rejected
+ */
+DhtStatus DhtFrame::decode(const uint16_t *highUs, size_t count, float &temp, float &hum) {
+  if (count < DHT_FRAME_BITS) return DHT_NO_RESPONSE;
+  const uint16_t *bits = highUs + (count - DHT_FRAME_BITS);
+  
+  uint8_t b[5] = {0, 0, 0, 0, 0};
+  for (int i = 0; i < DHT_FRAME_BITS; i++) {
+    b[i / 8] = (uint8_t)((b[i / 8] << 1) | (bits[i] > DHT_BIT_ONE_US ? 1 : 0));
+  }
+  if ((uint8_t)(b[0] + b[1] + b[2] + b[3]) != b[4]) return DHT_CHECKSUM;
+  
+  float h = ((b[0] << 8) | b[1]) * 0.1f;
+  float t = (((b[2] & 0x7F) << 8) | b[3]) * 0.1f;
+  if (b[2] & 0x80) t = -t;  // Sign-magnitude, not two's complement
+  if (h > 100.0f || t < -40.0f || t > 80.0f) return DHT_RANGE;
+  
+  temp = t;
+  hum = h;
+  return DHT_OK;
+}
+
+const char *DhtFrame::statusName(DhtStatus s) {
+  switch (s) {
+    case DHT_OK:          return "ok";
+    case DHT_NO_RESPONSE: return "no response";
+    case DHT_CHECKSUM:    return "checksum";
+    case DHT_RANGE:       return "out of range";
+  }
+  return "?";
+}
@@ -0,0 +1,220 @@
+/*
+ * Alert Dispatcher - Queue-Backed Notification Delivery
+ * 
+ * Decouples alert generation from delivery so motion capture never
+ * waits on the network. Each enqueued AlertEvent is copied into one
+ * queue per channel, and an independent sender task drains each queue:
+ * - TelegramTask: photo/text delivery via Telegram Bot API
+ * - MqttAlertTask: text alert to Adafruit IO alerts feed
+ * 
+ * A slow Telegram upload therefore delays neither the MQTT alert nor
+ * the next motion capture. Each channel has its own retry/backoff policy.
+ * 
+ * A channel may also send a best-effort follow-up after delivery
+ * (Telegram: full-resolution photo), only when nothing else is queued.
+ */
+
+#include "dispatcher.h"
+#include "telegram.h"
+#include "net_mqtt.h"
+#include "logging.h"
+#include "metrics.h"
+#include "power.h"
+#include "scheduler.h"
+#include "boot.h"
+#include "config.h"
+
+// Delivery policy for one notification channel
+struct ChannelPolicy {
+  const char *name;         // Log tag
+  int maxAttempts;          // Total delivery attempts per event
+  uint32_t backoffBaseMs;   // First retry delay, doubled on each retry
+  uint32_t backoffMaxMs;    // Upper bound for retry delay
+};
+
+// A channel = queue + policy + send function, drained by one task
+struct Channel {
+  QueueHandle_t queue;
+  ChannelPolicy policy;
+  bool (*send)(const AlertEvent &ev);
+  MetricHist motionLatency;  // Trigger-to-delivered histogram for motion alerts
+  void (*followup)(const AlertEvent &ev);  // Optional, after delivery (nullptr = none)
+};
+
+static bool sendTelegram(const AlertEvent &ev) {
+  bool ok;
+  if (ev.extraCount == 0) {
+    ok = Telegram::sendAlert(ev.text, ev.photoURL, ev.triggerMs);
+  } else {
+    const char *urls[CAM_MAX_NODES] = { ev.photoURL };
+    for (int i = 0; i < ev.extraCount; i++) urls[i + 1] = ev.extraURLs[i];
+    ok = Telegram::sendAlbum(ev.text, urls, ev.extraCount + 1, ev.triggerMs);
+  }
+  if (ok && ev.triggerMs) Power::noteDelivered(ev.triggerMs);
+  return ok;
+}
+
+/*
+ * Full-resolution photo after the fast low-res alert
+ * Single attempt: the alert itself has already been delivered
+ */
+static void sendTelegramFollowup(const AlertEvent &ev) {
+  if (ev.followupURL[0] == '\0') return;
+  char caption[48];
+  snprintf(caption, sizeof(caption), "📷 Full resolution (+%lus)", (millis() - ev.triggerMs) / 1000);
+  if (!Telegram::sendAlert(caption, ev.followupURL)) {
+    LOGW("DISPATCH", "⚠ Full-resolution follow-up not delivered");
+  }
+}
+
+static bool sendMqtt(const AlertEvent &ev) {
+  return NetMQTT::publishAlert(ev.reason); // No photo URL - Telegram only
+}
+
+// Telegram already retries fetch/upload internally, so fewer outer attempts
+static Channel telegramChannel = { nullptr, { "TELEGRAM", 2, 5000, 20000 }, sendTelegram, H_MOTION_TO_TG, sendTelegramFollowup };
+static Channel mqttChannel     = { nullptr, { "MQTT",     5, 2000, 30000 }, sendMqtt,     H_MOTION_TO_MQTT, nullptr };
+
+static const UBaseType_t QUEUE_DEPTH = 4; // Events buffered per channel
+
+/*
+ * Channel sender task
+ * 
+ * Blocks on the channel queue, then delivers each event with
+ * exponential backoff between attempts. Events are processed in
+ * order; a failed event is dropped after maxAttempts. The power lock
+ * is held only while sending, so the chip may sleep during backoff.
+ * 
+ * @param pv: Channel* describing queue, policy and send function
+ */
+static void taskChannel(void *pv) {
+  Channel *ch = (Channel *)pv;
+  LOGI("DISPATCH", "%s sender started", ch->policy.name);
+  Scheduler::watchCurrentTask();
+  
+  AlertEvent ev;
+  for (;;) {
+    Scheduler::feedWatchdog();
+    if (xQueueReceive(ch->queue, &ev, pdMS_TO_TICKS(TASK_WDT_FEED_MS)) != pdTRUE) continue;
+    
+    // An alert raised while still booting waits for the link instead
+    // of spending its attempts on it
+    while (!Boot::waitReady(BOOT_WIFI, pdMS_TO_TICKS(TASK_WDT_FEED_MS))) Scheduler::feedWatchdog();
+    
+    unsigned long queuedMs = millis() - ev.raisedAt;
+    LOGI("DISPATCH", "%s picked up '%s' (queued %lums)", ch->policy.name, ev.reason, queuedMs);
+    
+    uint32_t backoff = ch->policy.backoffBaseMs;
+    bool delivered = false;
+    for (int attempt = 1; attempt <= ch->policy.maxAttempts; attempt++) {
+      Scheduler::feedWatchdog();  // Backoff and a slow attempt can each take a while
+      Power::hold();
+      delivered = ch->send(ev);
+      Power::release();
+      if (delivered) break;
+      if (attempt < ch->policy.maxAttempts) {
+        LOGW("DISPATCH", "%s attempt %d/%d failed - retrying in %ums", ch->policy.name, attempt, ch->policy.maxAttempts, (unsigned)backoff);
+        vTaskDelay(pdMS_TO_TICKS(backoff));
+        backoff = min(backoff * 2, ch->policy.backoffMaxMs);
+      }
+    }
+    
+    unsigned long totalMs = millis() - ev.raisedAt;
+    if (delivered) {
+      LOGI("DISPATCH", "✓ %s delivered '%s' (%lums after enqueue)", ch->policy.name, ev.reason, totalMs);
+      if (ev.triggerMs) Metrics::observe(ch->motionLatency, (millis() - ev.triggerMs) * 1000UL);
+      // Follow-up never delays a waiting alert
+      if (ch->followup && uxQueueMessagesWaiting(ch->queue) == 0) {
+        Power::hold();
+        ch->followup(ev);
+        Power::release();
+      }
+    } else {
+      LOGE("DISPATCH", "✗ %s gave up on '%s'", ch->policy.name, ev.reason);
+      Metrics::count(M_ALERT_DROPPED);
+    }
+  }
+}
+
+/*
+ * Create channel queues and sender tasks
+ * Called once from Scheduler::initTasks() before AlertTask starts
+ */
+void Dispatcher::init() {
+  LOGI("DISPATCH", "Creating alert queues (depth %u)...", (unsigned)QUEUE_DEPTH);
+  telegramChannel.queue = xQueueCreate(QUEUE_DEPTH, sizeof(AlertEvent));
+  mqttChannel.queue = xQueueCreate(QUEUE_DEPTH, sizeof(AlertEvent));
+  
+  // Telegram sender needs room for TLS handshake; MQTT sender is small
+  xTaskCreatePinnedToCore(taskChannel, "TelegramTask", TASK_TELEGRAM_STACK, &telegramChannel, TASK_TELEGRAM_PRIO, NULL, TASK_TELEGRAM_CORE);
+  xTaskCreatePinnedToCore(taskChannel, "MqttAlertTask", TASK_MQTT_ALERT_STACK, &mqttChannel, TASK_MQTT_ALERT_PRIO, NULL, TASK_MQTT_ALERT_CORE);
+  LOGI("DISPATCH", "✓ Telegram and MQTT senders created");
+}
+
+/*
+ * Copy an event into every channel queue
+ */
+static bool broadcast(const AlertEvent &ev) {
+  bool ok = true;
+  Channel *channels[] = { &telegramChannel, &mqttChannel };
+  for (Channel *ch : channels) {
+    // Zero timeout: a full queue means the channel is badly backed up,
+    // and dropping is better than stalling the caller
+    if (xQueueSend(ch->queue, &ev, 0) != pdTRUE) {
+      LOGE("DISPATCH", "✗ %s queue full - dropping '%s'", ch->policy.name, ev.reason);
+      Metrics::count(M_ALERT_DROPPED);
+      ok = false;
+    }
+  }
+  return ok;
+}
+
+/*
+ * Queue an alert for delivery on all channels
+ * 
+ * Returns immediately - never blocks on the network. Strings are
+ * truncated to the AlertEvent field sizes.
+ * 
+ * @param reason: MQTT alert reason (e.g., "motion", "high_temperature")
+ * @param text: Telegram message or photo caption
+ * @param photoURL: Optional camera URL or JSON from CameraClient::capture()
+ * @param triggerMs: millis() of the motion edge, for latency metrics (0 = none)
+ * @param followupURL: Optional full-resolution photo for Telegram after delivery
+ * @return true if every channel accepted the event, false if a queue was full
+ */
+bool Dispatcher::enqueue(const char *reason, const char *text, const char *photoURL, unsigned long triggerMs,
+                         const char *followupURL) {
+  AlertEvent ev;
+  strlcpy(ev.reason, reason, sizeof(ev.reason));
+  strlcpy(ev.text, text, sizeof(ev.text));
+  strlcpy(ev.photoURL, photoURL, sizeof(ev.photoURL));
+  ev.raisedAt = millis();
+  ev.triggerMs = triggerMs;
+  strlcpy(ev.followupURL, followupURL, sizeof(ev.followupURL));
+  ev.extraCount = 0;
+  return broadcast(ev);
+}
+
+/*
+ * Queue a motion alert carrying every camera's frame
+ * 
+ * shots.urls[0] becomes the photo (and its follow-up); the other
+ * cameras' frames travel with it and Telegram sends them as an album.
+ * 
+ * @param shots: Result of CameraClient::captureAll()
+ * @return true if every channel accepted the event, false if a queue was full
+ */
+bool Dispatcher::enqueue(const char *reason, const char *text, const CaptureSet &shots, unsigned long triggerMs) {
+  AlertEvent ev;
+  strlcpy(ev.reason, reason, sizeof(ev.reason));
+  strlcpy(ev.text, text, sizeof(ev.text));
+  strlcpy(ev.photoURL, shots.count ? shots.urls[0] : "", sizeof(ev.photoURL));
+  ev.raisedAt = millis();
+  ev.triggerMs = triggerMs;
+  strlcpy(ev.followupURL, shots.followUrl, sizeof(ev.followupURL));
+  ev.extraCount = 0;
+  for (int i = 1; i < shots.count && i < CAM_MAX_NODES; i++) {
+    strlcpy(ev.extraURLs[ev.extraCount++], shots.urls[i], sizeof(ev.extraURLs[0]));
+  }
+  return broadcast(ev);
+}
@@ -0,0 +1,124 @@
+/*
+ * Frame Pool Module - Fixed-Slot JPEG Buffers in PSRAM
+ * 
+ * The board has octal PSRAM; internal SRAM is kept for the WiFi/TLS
+ * stacks and task stacks. init() takes FRAME_POOL_SLOTS buffers of
+ * FRAME_POOL_SLOT_SIZE (the largest camera JPEG) in a single
+ * heap_caps_malloc(MALLOC_CAP_SPIRAM) at boot, and they are never
+ * freed, so whole frames can be held without any allocation on the
+ * alert path and without fragmenting the internal heap.
+ * 
+ * The Telegram upload borrows a slot for the camera frame it relays:
+ * bytes are read from the camera straight into the slot and written to
+ * Telegram from there, and a failed upload is replayed from the slot
+ * instead of fetching the camera again.
+ * 
+ * When no slot is free (or the board has no PSRAM) borrow() refuses
+ * and the caller falls back to relaying through a small chunk buffer.
+ * Occupancy and refusals are reported by stats()/logSummary().
+ */
+
+#include "frame_pool.h"
+#include "config.h"
+#include "logging.h"
+#include "metrics.h"
+#include "esp_heap_caps.h"
+
+static portMUX_TYPE poolMux = portMUX_INITIALIZER_UNLOCKED;
+static uint8_t *poolBase = nullptr;  // FRAME_POOL_SLOTS * FRAME_POOL_SLOT_SIZE bytes in PSRAM
+static uint8_t slotCount = 0;
+static uint32_t busyMask = 0;        // Bit i set = slot i borrowed
+static FramePool::Stats poolStats = {};
+
+/*
+ * Allocate the pool
+ * 
+ * One PSRAM allocation for every slot, made before any task runs.
+ * Without PSRAM the pool stays empty and every borrow is refused.
+ */
+void FramePool::init() {
+  static_assert(FRAME_POOL_SLOTS <= 32, "busyMask holds 32 slots");
+  size_t total = (size_t)FRAME_POOL_SLOTS * FRAME_POOL_SLOT_SIZE;
+  poolBase = (uint8_t *)heap_caps_malloc(total, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+  if (!poolBase) {
+    LOGE("POOL", "✗ No %u KB in PSRAM for the frame pool - frames are relayed in chunks",
+         (unsigned)(total / 1024));
+    return;
+  }
+  slotCount = FRAME_POOL_SLOTS;
+  poolStats.slots = slotCount;
+  LOGI("POOL", "✓ Frame pool: %u x %u KB in PSRAM (%u KB PSRAM left)", (unsigned)slotCount,
+       (unsigned)(FRAME_POOL_SLOT_SIZE / 1024), (unsigned)(heap_caps_get_free_size(MALLOC_CAP_SPIRAM) / 1024));
+}
+
+/*
+ * Borrow a free slot
+ * 
+ * @param f: receives the slot (len 0); data is nullptr if refused
+ * @return false if there is no pool, or every slot is busy (counted in
+ *         M_FRAME_POOL_EMPTY)
+ */
+bool FramePool::borrow(FrameBuf &f) {
+  f.data = nullptr;
+  f.cap = 0;
+  f.len = 0;
+  f.slot = -1;
+  if (slotCount == 0) return false;  // No PSRAM: reported once by init()
+  portENTER_CRITICAL(&poolMux);
+  for (int i = 0; i < slotCount; i++) {
+    if (busyMask & (1UL << i)) continue;
+    busyMask |= 1UL << i;
+    f.slot = i;
+    poolStats.borrows++;
+    poolStats.inUse++;
+    if (poolStats.inUse > poolStats.peak) poolStats.peak = poolStats.inUse;
+    break;
+  }
+  if (f.slot < 0) poolStats.refused++;
+  portEXIT_CRITICAL(&poolMux);
+  
+  if (f.slot < 0) {
+    LOGW("POOL", "⚠ All %u frame slots busy", (unsigned)slotCount);
+    Metrics::count(M_FRAME_POOL_EMPTY);
+    return false;
+  }
+  f.data = poolBase + (size_t)f.slot * FRAME_POOL_SLOT_SIZE;
+  f.cap = FRAME_POOL_SLOT_SIZE;
+  return true;
+}
+
+/*
+ * Return a slot to the pool
+ * Leaves f empty, so a second call does nothing.
+ */
+void FramePool::giveBack(FrameBuf &f) {
+  if (f.slot < 0) return;
+  portENTER_CRITICAL(&poolMux);
+  if (busyMask & (1UL << f.slot)) {
+    busyMask &= ~(1UL << f.slot);
+    poolStats.inUse--;
+  }
+  portEXIT_CRITICAL(&poolMux);
+  f.data = nullptr;
+  f.cap = 0;
+  f.len = 0;
+  f.slot = -1;
+}
+
+FramePool::Stats FramePool::stats() {
+  portENTER_CRITICAL(&poolMux);
+  Stats s = poolStats;
+  portEXIT_CRITICAL(&poolMux);
+  return s;
+}
+
+/*
+ * Log occupancy and refusals
+ * Called with the periodic metrics dump from loop()
+ */
+void FramePool::logSummary() {
+  Stats s = stats();
+  if (s.slots == 0) return;
+  LOGI("POOL", "Frame slots: %u/%u in use (peak %u) | %u borrowed, %u refused", (unsigned)s.inUse,
+       (unsigned)s.slots, (unsigned)s.peak, (unsigned)s.borrows, (unsigned)s.refused);
+}
@@ -0,0 +1,242 @@
+/*
+ * HTTP Codec Module - Pure Encoding Helpers
+ * 
+ * URL encoding, private-address detection and multipart/form-data
+ * envelope assembly for the Telegram client.
+ * 
+ * Everything here works on caller-provided buffers with no heap
+ * use and no Arduino calls, so the same code is unit tested and
+ * benchmarked on the host ([env:native], see test/).
+ */
+
+#include "http_codec.h"
+#include <ctype.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/*
+ * URL-encode a string for safe transmission in HTTP GET parameters
+ * 
+ * Converts special characters to %XX format (e.g., space -> +)
+ * Preserves alphanumeric and safe characters (- _ . ~)
+ * Output is truncated on a character boundary if it does not fit.
+ * 
+ * @param in: Raw string to encode
+ * @param out: Receives the NUL-terminated encoded string
+ * @param cap: Size of out
+ * @return Length of the encoded string
+ */
+size_t HttpCodec::urlEncode(const char *in, char *out, size_t cap) {
+  static const char HEX_DIGITS[] = "0123456789ABCDEF";
+  size_t len = 0;
+  for (; *in; in++) {
+    unsigned char c = (unsigned char)*in;
+    bool plain = isalnum(c) || c == '-' || c == '_' || c == '.' || c == '~';
+    size_t need = (plain || c == ' ') ? 1 : 3;
+    if (len + need >= cap) break;  // Keep room for NUL
+    if (c == ' ') {
+      out[len++] = '+';  // Space becomes +
+    } else if (plain) {
+      out[len++] = c;  // Safe characters pass through
+    } else {
+      // Encode as %XX hexadecimal
+      out[len++] = '%';
+      out[len++] = HEX_DIGITS[c >> 4];
+      out[len++] = HEX_DIGITS[c & 0x0F];
+    }
+  }
+  if (cap > 0) out[len] = '\0';
+  return len;
+}
+
+/*
+ * Lowercase hex encoding (e.g., for HMAC signatures)
+ * 
+ * @return Length written (2 * len), 0 if out cannot hold it plus NUL
+ */
+size_t HttpCodec::hexEncode(const unsigned char *in, size_t len, char *out, size_t cap) {
+  static const char HEX_LOWER[] = "0123456789abcdef";
+  if (cap < len * 2 + 1) return 0;
+  for (size_t i = 0; i < len; i++) {
+    out[i * 2] = HEX_LOWER[in[i] >> 4];
+    out[i * 2 + 1] = HEX_LOWER[in[i] & 0x0F];
+  }
+  out[len * 2] = '\0';
+  return len * 2;
+}
+
+/*
+ * Detect URLs on local/private networks (10.x, 192.168.x, 172.16-31.x, 127.x)
+ * Telegram cannot fetch these, so their bytes must be uploaded
+ */
+bool HttpCodec::isPrivateHttpUrl(const char *u) {
+  const char *host;
+  if (strncmp(u, "http://", 7) == 0) host = u + 7;
+  else if (strncmp(u, "https://", 8) == 0) host = u + 8;
+  else return false;
+  
+  if (strncmp(host, "10.", 3) == 0 || strncmp(host, "192.168.", 8) == 0 || strncmp(host, "127.", 4) == 0) return true;
+  if (strncmp(host, "172.", 4) == 0) {
+    int second = atoi(host + 4);
+    return second >= 16 && second <= 31;
+  }
+  return false;
+}
+
+/*
+ * Split "http://host[:port][/path]" for a raw socket request
+ * 
+ * @param host: Receives the host name or IP
+ * @param port: Receives the port (80 if not given)
+ * @param path: Set to the path inside url ("/" if not given)
+ * @return false for non-http URLs or a host that does not fit
+ */
+bool HttpCodec::splitHttpUrl(const char *url, char *host, size_t hostCap, unsigned *port, const char **path) {
+  if (strncmp(url, "http://", 7) != 0) return false;
+  const char *h = url + 7;
+  size_t hostLen = strcspn(h, ":/");
+  if (hostLen == 0 || hostLen >= hostCap) return false;
+  memcpy(host, h, hostLen);
+  host[hostLen] = '\0';
+  
+  const char *rest = h + hostLen;
+  *port = 80;
+  if (*rest == ':') {
+    char *end;
+    unsigned long p = strtoul(rest + 1, &end, 10);
+    if (end == rest + 1 || p == 0 || p > 65535) return false;
+    *port = (unsigned)p;
+    rest = end;
+  }
+  if (*rest != '\0' && *rest != '/') return false;
+  *path = (*rest == '/') ? rest : "/";
+  return true;
+}
+
+/*
+ * Clamp an snprintf result to "bytes written", 0 if it did not fit
+ */
+static size_t fitted(int n, size_t cap) {
+  return (n < 0 || (size_t)n >= cap) ? 0 : (size_t)n;
+}
+
+/*
+ * Build a multipart boundary string
+ * 
+ * @param seed: Varies the boundary between requests (millis() on device)
+ * @return Length written, 0 if out is too small
+ */
+size_t HttpCodec::multipartBoundary(unsigned long seed, char *out, size_t cap) {
+  return fitted(snprintf(out, cap, "----ESP32Boundary%lu", seed), cap);
+}
+
+/*
+ * Build everything in a sendPhoto body that precedes the JPEG bytes:
+ * chat_id part, optional reply_to_message_id part, caption part and
+ * the photo part header
+ * 
+ * @param replyTo: Message to thread the photo under (0 = none)
+ * @return Length written, 0 if the envelope does not fit in out
+ */
+size_t HttpCodec::multipartPreamble(const char *boundary, const char *chatId, const char *caption,
+                                    long replyTo, char *out, size_t cap) {
+  size_t len = 0;
+  if (replyTo > 0) {
+    len = fitted(snprintf(out, cap,
+                "--%s\r\n"
+                "Content-Disposition: form-data; name=\"reply_to_message_id\"\r\n\r\n%ld\r\n",
+                boundary, replyTo), cap);
+    if (len == 0) return 0;
+  }
+  int n = snprintf(out + len, cap - len,
+                "--%s\r\n"
+                // Part 1: chat_id field
+                "Content-Disposition: form-data; name=\"chat_id\"\r\n\r\n%s\r\n"
+                "--%s\r\n"
+                // Part 2: caption field
+                "Content-Disposition: form-data; name=\"caption\"\r\n\r\n%s\r\n"
+                "--%s\r\n"
+                // Part 3: photo file field (bytes streamed after this header)
+                "Content-Disposition: form-data; name=\"photo\"; filename=\"image.jpg\"\r\n"
+                "Content-Type: image/jpeg\r\n\r\n",
+                boundary, chatId, boundary, caption, boundary);
+  size_t body = fitted(n, cap - len);
+  return body ? len + body : 0;
+}
+
+/*
+ * Build the closing delimiter that follows the JPEG bytes
+ * 
+ * @return Length written, 0 if out is too small
+ */
+size_t HttpCodec::multipartTrailer(const char *boundary, char *out, size_t cap) {
+  return fitted(snprintf(out, cap, "\r\n--%s--\r\n", boundary), cap);
+}
+
+/*
+ * Build one plain form field part
+ * 
+ * @return Length written, 0 if out is too small
+ */
+size_t HttpCodec::multipartField(const char *boundary, const char *name, const char *value,
+                                 char *out, size_t cap) {
+  return fitted(snprintf(out, cap,
+                "--%s\r\n"
+                "Content-Disposition: form-data; name=\"%s\"\r\n\r\n%s\r\n",
+                boundary, name, value), cap);
+}
+
+/*
+ * Build the header of a JPEG file part named <name>.jpg
+ * 
+ * Used for sendMediaGroup, where every photo is its own part and
+ * is referenced from the media array as attach://<name>.
+ * 
+ * @param leadingCrlf: Prefix the CRLF that closes the previous file part
+ * @return Length written, 0 if out is too small
+ */
+size_t HttpCodec::multipartFileHeader(const char *boundary, const char *name, bool leadingCrlf,
+                                      char *out, size_t cap) {
+  return fitted(snprintf(out, cap,
+                "%s--%s\r\n"
+                "Content-Disposition: form-data; name=\"%s\"; filename=\"%s.jpg\"\r\n"
+                "Content-Type: image/jpeg\r\n\r\n",
+                leadingCrlf ? "\r\n" : "", boundary, name, name), cap);
+}
+
+/*
+ * Escape a string for use inside a JSON string literal
+ * 
+ * Quotes and backslashes are backslash-escaped, control characters
+ * become \n, \r, \t or \u00XX. UTF-8 passes through unchanged.
+ * Output is truncated on an escape boundary if it does not fit.
+ * 
+ * @return Length of the escaped string
+ */
+size_t HttpCodec::jsonEscape(const char *in, char *out, size_t cap) {
+  if (cap == 0) return 0;
+  size_t o = 0;
+  for (const unsigned char *p = (const unsigned char *)in; *p; p++) {
+    char esc[7];
+    size_t n;
+    if (*p == '"' || *p == '\\') {
+      esc[0] = '\\'; esc[1] = *p; n = 2;
+    } else if (*p == '\n') {
+      esc[0] = '\\'; esc[1] = 'n'; n = 2;
+    } else if (*p == '\r') {
+      esc[0] = '\\'; esc[1] = 'r'; n = 2;
+    } else if (*p == '\t') {
+      esc[0] = '\\'; esc[1] = 't'; n = 2;
+    } else if (*p < 0x20) {
+      n = snprintf(esc, sizeof(esc), "\\u%04x", *p);
+    } else {
+      esc[0] = *p; n = 1;
+    }
+    if (o + n >= cap) break;
+    memcpy(out + o, esc, n);
+    o += n;
+  }
+  out[o] = '\0';
+  return o;
+}
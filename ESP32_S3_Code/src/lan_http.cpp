@@ -0,0 +1,140 @@
+/*
+ * LAN HTTP Module - Split Request/Response GETs
+ * 
+ * Minimal HTTP/1.0 client for the camera nodes. request() connects and
+ * writes the GET without waiting; response() reads the status line and
+ * headers later. Issuing every request first and collecting afterwards
+ * lets several cameras work at the same time on one task, with no
+ * worker stacks and no per-request HTTPClient objects.
+ * 
+ * HTTP/1.0 with Connection: close means no chunked replies: the body
+ * ends at Content-Length or when the camera closes the socket.
+ */
+
+#include "lan_http.h"
+#include "metrics.h"
+#include "http_codec.h"
+
+/*
+ * Write a buffer to a client, looping until every byte is accepted
+ * 
+ * @return true if all bytes were written, false if the socket stalled
+ */
+bool LanHttp::writeAll(Client &c, const uint8_t *data, size_t len) {
+  size_t sent = 0;
+  while (sent < len) {
+    size_t n = c.write(data + sent, len - sent);
+    if (n == 0) return false;  // Socket closed or send buffer stuck
+    sent += n;
+  }
+  return true;
+}
+
+/*
+ * Read a single CRLF-terminated line from the socket with a deadline
+ * 
+ * @return true if a full line was read before the deadline
+ */
+bool LanHttp::readLine(Client &c, char *buf, size_t cap, unsigned long deadline) {
+  size_t len = 0;
+  while ((long)(deadline - millis()) > 0) {
+    if (c.available() <= 0) {
+      if (!c.connected()) break;
+      delay(10);
+      continue;
+    }
+    int ch = c.read();
+    if (ch < 0) continue;
+    if (ch == '\n') {
+      if (len > 0 && buf[len - 1] == '\r') len--;  // Strip CR
+      buf[len] = '\0';
+      return true;
+    }
+    if (len + 1 < cap) buf[len++] = (char)ch;  // Truncate overlong lines
+  }
+  buf[len] = '\0';
+  return false;
+}
+
+/*
+ * Connect and send the GET request, without waiting for the response
+ * 
+ * @param url: http://<host>[:port]/path
+ * @param connectTimeoutMs: TCP connect timeout (0 = stack default)
+ * @return false if the URL is unusable or the device did not accept the connection
+ */
+bool LanHttp::request(HttpFetch &f, const char *url, int32_t connectTimeoutMs) {
+  char host[40];
+  unsigned port;
+  const char *path;
+  f.requested = false;
+  f.startUs = Metrics::now();
+  if (!HttpCodec::splitHttpUrl(url, host, sizeof(host), &port, &path)) return false;
+  
+  f.client.setTimeout(12000);  // 12-second socket timeout
+  int connected = connectTimeoutMs > 0 ? f.client.connect(host, port, connectTimeoutMs)
+                                       : f.client.connect(host, port);
+  if (!connected) return false;
+  char req[160];
+  int n = snprintf(req, sizeof(req), "GET %s HTTP/1.0\r\nHost: %s\r\nConnection: close\r\n\r\n", path, host);
+  if (n <= 0 || (size_t)n >= sizeof(req) || !writeAll(f.client, (const uint8_t*)req, n)) {
+    f.client.stop();
+    return false;
+  }
+  f.requested = true;
+  return true;
+}
+
+/*
+ * Read the status line and headers
+ * 
+ * @param contentLength: Receives Content-Length, or -1 if not sent
+ * @param deadline: millis() by which the headers must be in
+ * @return HTTP status code, or -1 if no valid response arrived
+ */
+int LanHttp::response(HttpFetch &f, long *contentLength, unsigned long deadline) {
+  char line[128];
+  *contentLength = -1;
+  
+  int code = -1;
+  if (readLine(f.client, line, sizeof(line), deadline)) {
+    const char *sp = strchr(line, ' ');
+    if (sp) code = atoi(sp + 1);
+    while (code > 0) {
+      if (!readLine(f.client, line, sizeof(line), deadline)) {
+        code = -1;  // Headers cut off
+        break;
+      }
+      if (line[0] == '\0') break; // Blank line ends headers
+      if (strncasecmp(line, "Content-Length:", 15) == 0) *contentLength = atol(line + 15);
+    }
+  }
+  return code;
+}
+
+/*
+ * Read a small response body into a buffer
+ * 
+ * Stops at Content-Length, when the device closes the socket, when out
+ * is full or at the deadline.
+ * 
+ * @param contentLength: From response(), -1 if unknown
+ * @return Bytes read (out is NUL-terminated)
+ */
+size_t LanHttp::readBody(HttpFetch &f, char *out, size_t cap, long contentLength, unsigned long deadline) {
+  size_t want = cap - 1;
+  if (contentLength >= 0 && (size_t)contentLength < want) want = (size_t)contentLength;
+  size_t len = 0;
+  while (len < want && (long)(deadline - millis()) > 0) {
+    int avail = f.client.available();
+    if (avail <= 0) {
+      if (!f.client.connected()) break;
+      delay(5);
+      continue;
+    }
+    int n = f.client.read((uint8_t *)out + len, want - len);
+    if (n > 0) len += n;
+  }
+  out[len] = '\0';
+  return len;
+}
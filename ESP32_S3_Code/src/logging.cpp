@@ -0,0 +1,162 @@
+/*
+ * Logging Module - Heap-Free, Non-Blocking Log Lines
+ * 
+ * Replaces "[TAG] " + String(x) concatenation, which allocates and
+ * frees heap blocks on every log call and fragments the heap over a
+ * long uptime. Each line is formatted into a stack buffer with
+ * vsnprintf.
+ * 
+ * Serial.println blocks once the UART TX FIFO is full (115200 baud is
+ * ~11 bytes/ms), so the formatted line is not written directly: it is
+ * copied into a lock-free multi-producer ring and LogTask, at idle
+ * priority, drains the ring to Serial. Callers never wait on the UART.
+ * When the ring is full the line is dropped and counted rather than
+ * blocking the caller.
+ * 
+ * Ring: bounded MPSC queue with a sequence number per slot. Producers
+ * claim a slot with one compare-and-swap on the write position; the
+ * slot's sequence tells the single consumer when the line is complete
+ * and tells producers when the slot is free again.
+ * 
+ * Levels are filtered at compile time by the LOG* macros in logging.h.
+ * Before init() (early boot) lines are written to Serial directly.
+ */
+
+#include "logging.h"
+#include "config.h"
+#include "scheduler.h"
+#include <stdarg.h>
+#include <atomic>
+
+static_assert((LOG_RING_SLOTS & (LOG_RING_SLOTS - 1)) == 0, "LOG_RING_SLOTS must be a power of two");
+
+struct LogSlot {
+  std::atomic<uint32_t> seq;  // == pos: free for writer at pos; == pos + 1: holds line pos
+  uint16_t len;
+  char text[LOG_LINE_MAX];
+};
+
+static LogSlot slots[LOG_RING_SLOTS];
+static std::atomic<uint32_t> writePos(0);   // Next position producers claim
+static std::atomic<uint32_t> readPos(0);    // Next position LogTask drains (written by LogTask only)
+static std::atomic<uint32_t> droppedCount(0);
+static std::atomic<bool> sinkRunning(false);
+
+static const TickType_t DRAIN_IDLE_TICKS = pdMS_TO_TICKS(POWER_MANAGED ? POWER_IDLE_POLL_MS : 20);  // Poll period when empty
+
+/*
+ * Claim a ring slot for one line
+ * 
+ * @return slot to fill, or nullptr if the ring is full
+ */
+static LogSlot *claimSlot(uint32_t &pos) {
+  pos = writePos.load(std::memory_order_relaxed);
+  for (;;) {
+    LogSlot *s = &slots[pos & (LOG_RING_SLOTS - 1)];
+    int32_t diff = (int32_t)(s->seq.load(std::memory_order_acquire) - pos);
+    if (diff == 0) {
+      // Slot free for this position - try to take it
+      if (writePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) return s;
+    } else if (diff < 0) {
+      return nullptr;  // Consumer has not drained this slot yet: full
+    } else {
+      pos = writePos.load(std::memory_order_relaxed);  // Another producer won, retry
+    }
+  }
+}
+
+/*
+ * Log Task - drains queued lines to the UART
+ * Only this task blocks on Serial when the TX FIFO is full.
+ */
+static void taskLog(void *pv) {
+  uint32_t reportedDrops = 0;
+  Scheduler::watchCurrentTask();
+  for (;;) {
+    Scheduler::feedWatchdog();
+    uint32_t pos = readPos.load(std::memory_order_relaxed);
+    LogSlot *s = &slots[pos & (LOG_RING_SLOTS - 1)];
+    if (s->seq.load(std::memory_order_acquire) != pos + 1) {
+      // Empty - report drops once the backlog is gone
+      uint32_t drops = droppedCount.load(std::memory_order_relaxed);
+      if (drops != reportedDrops) {
+        Serial.printf("[LOG] ⚠ %u lines dropped (ring full)\r\n", (unsigned)(drops - reportedDrops));
+        reportedDrops = drops;
+      }
+      vTaskDelay(DRAIN_IDLE_TICKS);
+      continue;
+    }
+    Serial.write((const uint8_t *)s->text, s->len);
+    s->seq.store(pos + LOG_RING_SLOTS, std::memory_order_release);  // Free for next lap
+    readPos.store(pos + 1, std::memory_order_release);
+  }
+}
+
+/*
+ * Start the drain task
+ * Called once from setup() right after Serial.begin()
+ */
+void Log::init() {
+  for (uint32_t i = 0; i < LOG_RING_SLOTS; i++) slots[i].seq.store(i, std::memory_order_relaxed);
+  // Idle priority on core 0: runs whenever the alert and sensor tasks are blocked
+  xTaskCreatePinnedToCore(taskLog, "LogTask", TASK_LOG_STACK, NULL, TASK_LOG_PRIO, NULL, TASK_LOG_CORE);
+  sinkRunning.store(true, std::memory_order_release);
+}
+
+/*
+ * Format and queue one log line
+ * 
+ * @param tag: Module tag printed in brackets (e.g., "MQTT"), or nullptr
+ * @param fmt: printf-style format for the message
+ */
+void Log::line(const char *tag, const char *fmt, ...) {
+  char buf[LOG_LINE_MAX];
+  int n = tag ? snprintf(buf, sizeof(buf), "[%s] ", tag) : 0;
+  if (n < 0) return;
+  
+  va_list args;
+  va_start(args, fmt);
+  int m = vsnprintf(buf + n, sizeof(buf) - n, fmt, args);
+  va_end(args);
+  if (m < 0) m = 0;
+  
+  size_t len = min((size_t)(n + m), sizeof(buf) - 3);  // Room for CRLF + NUL
+  buf[len++] = '\r';
+  buf[len++] = '\n';
+  
+  if (!sinkRunning.load(std::memory_order_acquire)) {
+    Serial.write((const uint8_t *)buf, len);  // Early boot: no drain task yet
+    return;
+  }
+  
+  uint32_t pos;
+  LogSlot *s = claimSlot(pos);
+  if (!s) {
+    droppedCount.fetch_add(1, std::memory_order_relaxed);
+    return;
+  }
+  memcpy(s->text, buf, len);
+  s->len = len;
+  s->seq.store(pos + 1, std::memory_order_release);  // Publish to LogTask
+}
+
+/*
+ * Block until every queued line has been written, or timeout
+ * Used before ESP.restart() so the last lines are not lost
+ */
+void Log::flush(uint32_t timeoutMs) {
+  if (!sinkRunning.load(std::memory_order_acquire)) return;
+  unsigned long start = millis();
+  while (readPos.load(std::memory_order_acquire) != writePos.load(std::memory_order_acquire) &&
+         millis() - start < timeoutMs) {
+    vTaskDelay(1);
+  }
+  Serial.flush();  // And out of the UART FIFO
+}
+
+/*
+ * @return lines dropped since boot because the ring was full
+ */
+uint32_t Log::dropped() {
+  return droppedCount.load(std::memory_order_relaxed);
+}
@@ -3,116 +3,134 @@
  * 
  * This file handles system initialization and main loop execution.
  * Key responsibilities:
- * - WiFi connection with retry and restart logic
- * - Sensor, MQTT, and camera initialization
+ * - Staged boot: local setup and motion arming first, then WiFi,
+ *   camera probing and MQTT in the background (see boot.cpp)
  * - FreeRTOS task creation for concurrent operation
  * - Periodic health monitoring
  */
 
 #include <Arduino.h>
-#include <WiFi.h>
 #include "config.h"
 #include "scheduler.h"
+#include "net_wifi.h"
 #include "net_mqtt.h"
 #include "telegram.h"
 #include "sensors.h"
 #include "motion.h"
-#include "camera_client.h"
+#include "store.h"
+#include "logging.h"
+#include "metrics.h"
+#include "power.h"
+#include "frame_pool.h"
+#include "alerts.h"
+#include "benchmark.h"
+#include "boot.h"
 
 void setup() {
-  // Initialize serial communication at 115200 baud for debugging
+  // Initialize serial communication at 115200 baud for debugging.
+  // No settle delay: log lines are queued and drained by LogTask, and
+  // every second here is a second with motion detection unarmed.
   Serial.begin(115200);
-  delay(1000);  // Allow serial to stabilize
+  Scheduler::initWatchdog();  // Before any watched task starts
+  Log::init();  // From here on, log lines are queued and drained by LogTask
+  Boot::init(); // Readiness flags, marked by the tasks below
   
   // Display startup banner with system information
-  Serial.println("\n\n");
-  Serial.println("╔════════════════════════════════════════════╗");
-  Serial.println("║   IoT Smart Home Security System v1.0     ║");
-  Serial.println("║   ESP32-S3 DevKit                         ║");
-  Serial.println("╚════════════════════════════════════════════╝");
-  Serial.println();
-  Serial.println("[BOOT] Starting initialization sequence...");
-  Serial.println("[BOOT] ESP32-S3 @ 240MHz");
-  Serial.println("[BOOT] Free Heap: " + String(ESP.getFreeHeap()) + " bytes");
-  Serial.println();
+  LOG_BANNER("\n\n");
+  LOG_BANNER("╔════════════════════════════════════════════╗");
+  LOG_BANNER("║   IoT Smart Home Security System v1.0     ║");
+  LOG_BANNER("║   ESP32-S3 DevKit                         ║");
+  LOG_BANNER("╚════════════════════════════════════════════╝");
+  LOG_BANNER("");
+  LOGI("BOOT", "Starting initialization sequence...");
+  LOGI("BOOT", "ESP32-S3 @ 240MHz");
+  LOGI("BOOT", "Free Heap: %u bytes", (unsigned)ESP.getFreeHeap());
+  LOG_BANNER("");
 
-  // === WiFi Connection Setup ===
-  Serial.println("=== WIFI CONNECTION ===");
-  Serial.println("[WIFI] Mode: Station (STA)");
-  Serial.println("[WIFI] SSID: " + String(WIFI_SSID));
-  
-  // Configure ESP32 as WiFi client (not access point)
-  WiFi.mode(WIFI_STA);
-  
-  // Attempt to connect with credentials from config.h
-  WiFi.begin(WIFI_SSID, WIFI_PASS);
-  
-  // Connection retry loop with timeout protection
-  Serial.print("[WIFI] Connecting");
-  int attempts = 0;
-  while (WiFi.status() != WL_CONNECTED) {
-    delay(500);
-    Serial.print(".");
-    attempts++;
-    
-    // Restart if connection fails after 60 attempts (30 seconds)
-    if (attempts > 60) {
-      Serial.println("\n[WIFI] ✗ Connection timeout!");
-      Serial.println("[WIFI] Restarting...");
-      ESP.restart();  // Hard restart to retry from clean state
-    }
-  }
-  
-  // Connection successful - display network info
-  Serial.println();
-  Serial.println("[WIFI] ✓ Connected!");
-  Serial.println("[WIFI] IP Address: " + WiFi.localIP().toString());
-  Serial.println("[WIFI] Signal Strength: " + String(WiFi.RSSI()) + " dBm");
-  Serial.println();
+  // ===== Stage 1: local only, ends with motion detection armed =====
+  // Nothing here waits on the network
 
+  // === Frame Pool ===
+  // PSRAM slots for relayed camera frames, allocated once before any task
+  FramePool::init();
+
+  // === Telegram Session Lock ===
+  // Must exist before any task can send an alert
+  Telegram::init();
+  
   // === Sensor Initialization ===
-  // Initialize DHT22 temperature/humidity sensor with stabilization delay
+  // Initialize DHT22 temperature/humidity sensor (non-blocking: the first
+  // read waits out the power-on settle time)
   Sensors::init();
   
-  // === MQTT Client Initialization ===
-  // Connect to Adafruit IO for cloud data publishing
-  NetMQTT::init();
+  // === Offline Buffer ===
+  // Resumes any readings spooled to flash before the last reboot
+  Store::init();
   
-  // === Camera Initialization and Connection Check ===
-  Serial.println("=== CAMERA INITIALIZATION ===");
-  Serial.println("[CAMERA] Mode: " + String(CameraClient::isMockMode() ? "MOCK" : "REAL"));
-  Serial.println("[CAMERA] Target IP: " + String(CAM_IP));
+  // === Weather Limits ===
+  // Saved runtime limits; dashboard changes arrive through MqttTask
+  Alerts::init();
+  NetMQTT::setConfigHandler(Alerts::configureWeather);
   
-  // Only check connection if not in mock mode
-  if (!CameraClient::isMockMode()) {
-    bool cameraOnline = CameraClient::checkConnection();
-    if (!cameraOnline) {
-      // Camera unavailable but system continues with degraded functionality
-      Serial.println("[CAMERA] ⚠ WARNING: Camera not detected!");
-      Serial.println("[CAMERA] System will continue but camera features unavailable");
-      Serial.println("[CAMERA] To use mock camera instead, call CameraClient::setMockMode(true)");
-    }
-  } else {
-    Serial.println("[CAMERA] Mock mode active - using placeholder images");
-  }
+  // === MQTT Client Initialization ===
+  // Publish queue and MqttTask; it connects once WiFi is up
+  NetMQTT::init();
   
   // === FreeRTOS Task Initialization ===
-  // Create and start sensor monitoring and alert handling tasks
+  // PIR interrupt, alert queues, AlertTask and SensorTask. Alerts raised
+  // from here on are queued until the network stages are ready.
   Scheduler::initTasks();
+  Boot::ready(BOOT_ARMED);
   
-  Serial.println("\n✓✓✓ SYSTEM FULLY OPERATIONAL ✓✓✓\n");
+  LOG_BANNER("\n✓✓✓ MOTION DETECTION ARMED ✓✓✓\n");
+  
+#ifdef BENCHMARK_MODE
+  // Synthetic PIR edges through the full alert pipeline (selects the
+  // camera mode, so before BootTask reads it; starts once the camera is)
+  Bench::start();
+#endif
+
+  // ===== Stage 2: network, in the background =====
+  // WiFi (cached AP first), power management, NTP and camera probing in
+  // BootTask, alongside the sensor warm-up and the MQTT connection
+  Boot::startNetwork();
+  
+  Scheduler::watchCurrentTask();
 }
 
 void loop() {
-  // Main loop runs on Core 0 - tasks run on Core 1
+  // loopTask runs on core 1 beside the alert pipeline (cores per task
+  // in config.h, Task Topology)
   // Keep this minimal to avoid blocking the scheduler
   vTaskDelay(pdMS_TO_TICKS(10000));  // Sleep for 10 seconds
+  Scheduler::feedWatchdog();
   
   // Periodic health check every 10 seconds
   static unsigned long lastHealthCheck = 0;
   if (millis() - lastHealthCheck > 10000) {
     // Log system uptime and available heap memory
-    Serial.println("[HEALTH] System uptime: " + String(millis() / 1000) + "s | Free heap: " + String(ESP.getFreeHeap()) + " bytes");
+    LOGI("HEALTH", "System uptime: %lus | Free heap: %u bytes | Log drops: %u", millis() / 1000, (unsigned)ESP.getFreeHeap(), (unsigned)Log::dropped());
+    Telegram::SessionStats ts = Telegram::sessionStats();
+    LOGI("HEALTH", "Telegram TLS: %u handshakes, %u saved, %u stale", (unsigned)ts.handshakes, (unsigned)ts.reused, (unsigned)ts.staleSessions);
+    LOGI("HEALTH", "MQTT link: %s | Buffered: %u (%u dropped)", NetMQTT::connected() ? "up" : "down",
+         (unsigned)Store::pending(), (unsigned)Store::dropped());
     lastHealthCheck = millis();
   }
+  
+  // Metrics dump to the log and a compact summary to the dashboard
+  static unsigned long lastMetrics = 0;
+  if (millis() - lastMetrics >= METRICS_PUBLISH_MS) {
+    Metrics::logSummary();
+    Power::logSummary();
+    NetWiFi::logSummary();
+    Boot::logSummary();
+    FramePool::logSummary();
+    char summary[112];
+    Metrics::summary(summary, sizeof(summary));
+    NetMQTT::publishMetrics(summary);
+    lastMetrics = millis();
+  }
+  
+  // Keep the Telegram TLS session warm between alerts
+  Telegram::keepWarm();
 }
@@ -0,0 +1,242 @@
+/*
+ * Metrics Module - On-Device Counters and Latency Histograms
+ * 
+ * Replaces one-off "[PERF] ... took: Xms" prints with figures that
+ * accumulate for the whole uptime:
+ * - Counters for retries, failures and drops
+ * - Fixed-bucket latency histograms (microseconds, esp_timer based)
+ * - Heap low-water mark and per-task stack high-water marks
+ * 
+ * Recording is a few instructions under a spinlock, so it is safe
+ * from any task. loop() prints the full set periodically and hands a
+ * compact summary to NetMQTT for the Adafruit IO metrics feed.
+ */
+
+#include "metrics.h"
+#include "logging.h"
+#include "config.h"
+#include <esp_timer.h>
+
+// Bucket upper bounds (us): 1-2-5 steps from 1 ms to 30 s, then overflow
+static const uint32_t BUCKET_US[] = {
+  1000, 2000, 5000, 10000, 20000, 50000, 100000, 200000, 500000,
+  1000000, 2000000, 5000000, 10000000, 20000000, 30000000
+};
+static const uint8_t BUCKET_COUNT = sizeof(BUCKET_US) / sizeof(BUCKET_US[0]) + 1;
+
+struct Histogram {
+  uint32_t buckets[BUCKET_COUNT];
+  uint32_t count;
+  uint64_t sumUs;
+  uint32_t maxUs;
+};
+
+static const char *COUNTER_NAMES[M_COUNTER_COUNT] = {
+  "motion", "cooldown", "tg_fetch_fail", "tg_retry", "tg_fail", "mqtt_fail", "mqtt_reconn", "alert_drop", "cam_offline", "cam_none", "cam_late", "dht_fail", "motion_unconfirmed", "pool_empty", "wifi_drop"
+};
+static const char *HIST_NAMES[M_HIST_COUNT] = {
+  "sense", "capture", "tg_get", "tg_upload", "tg_send", "cam_push", "mqtt_pub", "mqtt_alert", "motion_first", "motion_tg", "motion_mqtt", "motion_wake", "wifi_conn"
+};
+
+static portMUX_TYPE metricsMux = portMUX_INITIALIZER_UNLOCKED;
+static uint32_t counters[M_COUNTER_COUNT];
+static Histogram hists[M_HIST_COUNT];
+static TaskHandle_t watched[METRICS_MAX_TASKS];
+static uint8_t watchedCount = 0;
+static void (*observer)(MetricHist, uint32_t) = nullptr;
+
+uint64_t Metrics::now() {
+  return (uint64_t)esp_timer_get_time();
+}
+
+void Metrics::count(MetricCounter c, uint32_t n) {
+  portENTER_CRITICAL(&metricsMux);
+  counters[c] += n;
+  portEXIT_CRITICAL(&metricsMux);
+}
+
+/*
+ * Record one latency sample
+ * 
+ * @param h: histogram to update
+ * @param us: duration in microseconds
+ */
+void Metrics::observe(MetricHist h, uint32_t us) {
+  uint8_t b = 0;
+  while (b < BUCKET_COUNT - 1 && us > BUCKET_US[b]) b++;
+  
+  portENTER_CRITICAL(&metricsMux);
+  Histogram &hg = hists[h];
+  hg.buckets[b]++;
+  hg.count++;
+  hg.sumUs += us;
+  if (us > hg.maxUs) hg.maxUs = us;
+  portEXIT_CRITICAL(&metricsMux);
+  
+  if (observer) observer(h, us);
+}
+
+void Metrics::observeSince(MetricHist h, uint64_t startUs) {
+  uint64_t d = now() - startUs;
+  observe(h, d > UINT32_MAX ? UINT32_MAX : (uint32_t)d);
+}
+
+/*
+ * Current value of an event counter
+ */
+uint32_t Metrics::counter(MetricCounter c) {
+  portENTER_CRITICAL(&metricsMux);
+  uint32_t v = counters[c];
+  portEXIT_CRITICAL(&metricsMux);
+  return v;
+}
+
+const char *Metrics::counterName(MetricCounter c) {
+  return c < M_COUNTER_COUNT ? COUNTER_NAMES[c] : "?";
+}
+
+const char *Metrics::histName(MetricHist h) {
+  return h < M_HIST_COUNT ? HIST_NAMES[h] : "?";
+}
+
+/*
+ * Install a callback that sees every raw sample (outside the lock)
+ * Used by the benchmark to compute exact percentiles
+ */
+void Metrics::setObserver(void (*fn)(MetricHist h, uint32_t us)) {
+  observer = fn;
+}
+
+/*
+ * Register the calling task for stack high-water reporting
+ * Called once per long-running task, via Scheduler::watchCurrentTask()
+ */
+void Metrics::watchCurrentTask() {
+  TaskHandle_t self = xTaskGetCurrentTaskHandle();
+  portENTER_CRITICAL(&metricsMux);
+  if (watchedCount < METRICS_MAX_TASKS) watched[watchedCount++] = self;
+  portEXIT_CRITICAL(&metricsMux);
+}
+
+uint8_t Metrics::taskCount() {
+  return watchedCount;
+}
+
+const char *Metrics::taskName(uint8_t i) {
+  return i < watchedCount ? pcTaskGetName(watched[i]) : "";
+}
+
+uint32_t Metrics::taskStackFree(uint8_t i) {
+  return i < watchedCount ? (uint32_t)uxTaskGetStackHighWaterMark(watched[i]) : 0;
+}
+
+/*
+ * Estimate a percentile from the histogram buckets
+ * 
+ * @return upper bound of the bucket holding the pct-th sample (us),
+ *         the recorded max for the overflow bucket, 0 if no samples
+ */
+uint32_t Metrics::percentileUs(MetricHist h, uint8_t pct) {
+  portENTER_CRITICAL(&metricsMux);
+  Histogram hg = hists[h];
+  portEXIT_CRITICAL(&metricsMux);
+  if (hg.count == 0) return 0;
+  
+  uint32_t rank = (hg.count * pct + 99) / 100;  // 1-based rank, rounded up
+  uint32_t seen = 0;
+  for (uint8_t b = 0; b < BUCKET_COUNT; b++) {
+    seen += hg.buckets[b];
+    if (seen >= rank) return b < BUCKET_COUNT - 1 ? min(BUCKET_US[b], hg.maxUs) : hg.maxUs;
+  }
+  return hg.maxUs;
+}
+
+// Room for the text after "[METRICS] <label>: " in one LOG_LINE_MAX line
+static const size_t LIST_LINE_MAX = LOG_LINE_MAX - 40;
+
+/*
+ * Add "name=value" to a space-separated list line
+ * 
+ * Lists outgrow one log line as counters and tasks are added: the line
+ * is logged and restarted before an item would be cut off.
+ */
+static void listItem(char *line, size_t &n, const char *label, const char *name, unsigned value) {
+  char item[48];
+  int len = snprintf(item, sizeof(item), "%s=%u", name, value);
+  if (n > 0 && n + 1 + len >= LIST_LINE_MAX) {
+    LOGI("METRICS", "%s: %s", label, line);
+    n = 0;
+  }
+  n += snprintf(line + n, LIST_LINE_MAX - n, "%s%s", n ? " " : "", item);
+}
+
+/*
+ * Print every counter, histogram and stack high-water mark
+ */
+void Metrics::logSummary() {
+  uint32_t c[M_COUNTER_COUNT];
+  portENTER_CRITICAL(&metricsMux);
+  memcpy(c, counters, sizeof(c));
+  portEXIT_CRITICAL(&metricsMux);
+  
+  char line[LIST_LINE_MAX];
+  size_t n = 0;
+  for (uint8_t i = 0; i < M_COUNTER_COUNT; i++) {
+    listItem(line, n, "Counters", COUNTER_NAMES[i], (unsigned)c[i]);
+  }
+  if (n > 0) LOGI("METRICS", "Counters: %s", line);
+  
+  for (uint8_t h = 0; h < M_HIST_COUNT; h++) {
+    portENTER_CRITICAL(&metricsMux);
+    uint32_t count = hists[h].count;
+    uint64_t sum = hists[h].sumUs;
+    uint32_t maxUs = hists[h].maxUs;
+    portEXIT_CRITICAL(&metricsMux);
+    if (count == 0) continue;
+    LOGI("METRICS", "%-11s n=%u avg=%.1fms p50=%.1fms p95=%.1fms p99=%.1fms max=%.1fms", HIST_NAMES[h], (unsigned)count,
+         sum / 1000.0 / count, percentileUs((MetricHist)h, 50) / 1000.0, percentileUs((MetricHist)h, 95) / 1000.0,
+         percentileUs((MetricHist)h, 99) / 1000.0, maxUs / 1000.0);
+  }
+  
+  LOGI("METRICS", "Heap: free=%u min=%u largest=%u", (unsigned)ESP.getFreeHeap(), (unsigned)ESP.getMinFreeHeap(),
+       (unsigned)ESP.getMaxAllocHeap());
+  n = 0;
+  for (uint8_t i = 0; i < watchedCount; i++) {
+    unsigned freeBytes = (unsigned)uxTaskGetStackHighWaterMark(watched[i]);
+    listItem(line, n, "Stack free (min bytes)", pcTaskGetName(watched[i]), freeBytes);
+    if (freeBytes < TASK_STACK_MIN_FREE) {
+      LOGW("METRICS", "⚠ %s stack nearly exhausted (%u bytes free) - raise its TASK_*_STACK", pcTaskGetName(watched[i]), freeBytes);
+    }
+  }
+  if (n > 0) LOGI("METRICS", "Stack free (min bytes): %s", line);
+}
+
+/*
+ * Compact summary for the Adafruit IO metrics feed
+ * 
+ * Kept short so it fits one Adafruit_MQTT packet, e.g.:
+ *   "up=3600 hmin=201k stk=812 tg=5 p50=812 p95=2300 max=2911 fail=0/1/0"
+ * (alert latencies in ms; fail = telegram/mqtt/dropped)
+ * 
+ * @return characters written
+ */
+size_t Metrics::summary(char *buf, size_t cap) {
+  uint32_t minStack = UINT32_MAX;
+  for (uint8_t i = 0; i < watchedCount; i++) {
+    minStack = min(minStack, (uint32_t)uxTaskGetStackHighWaterMark(watched[i]));
+  }
+  portENTER_CRITICAL(&metricsMux);
+  uint32_t tgCount = hists[H_MOTION_TO_TG].count;
+  uint32_t tgMax = hists[H_MOTION_TO_TG].maxUs;
+  uint32_t tgFail = counters[M_TG_SEND_FAIL];
+  uint32_t mqttFail = counters[M_MQTT_PUBLISH_FAIL];
+  uint32_t dropped = counters[M_ALERT_DROPPED];
+  portEXIT_CRITICAL(&metricsMux);
+  
+  int n = snprintf(buf, cap, "up=%lu hmin=%uk stk=%u tg=%u p50=%u p95=%u max=%u fail=%u/%u/%u",
+                   millis() / 1000, (unsigned)(ESP.getMinFreeHeap() / 1024),
+                   (unsigned)(watchedCount ? minStack : 0), (unsigned)tgCount,
+                   (unsigned)(percentileUs(H_MOTION_TO_TG, 50) / 1000), (unsigned)(percentileUs(H_MOTION_TO_TG, 95) / 1000),
+                   (unsigned)(tgMax / 1000), (unsigned)tgFail, (unsigned)mqttFail, (unsigned)dropped);
+  return n > 0 ? min((size_t)n, cap - 1) : 0;
+}
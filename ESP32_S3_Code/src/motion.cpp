@@ -2,15 +2,30 @@
  * Motion Detection Module - PIR Sensor Interface
  * 
  * Implements interrupt-driven motion detection with debouncing.
- * Uses a volatile flag set by ISR and checked by AlertTask.
+ * The ISR wakes the listening AlertTask directly via a FreeRTOS task
+ * notification, so trigger-to-capture latency is not bounded by a
+ * polling interval. Every PIR edge is counted, including those that
+ * are debounced or arrive while an event is still unconsumed.
+ * 
+ * With POWER_MANAGED the PIR pin is also the light-sleep wake source.
  */
 
 #include "motion.h"
+#include "config.h"
+#include "logging.h"
+#include "esp_timer.h"
+#include "esp_sleep.h"
+#include "driver/gpio.h"
+#include "hal/gpio_ll.h"
 
-// Volatile variables for ISR communication
-// Must be volatile because they're modified in ISR and read in main code
-volatile bool motionFlag = false;  // Set to true when motion detected
-volatile unsigned long lastTriggerTime = 0;  // Timestamp of last trigger for debouncing
+// State shared between ISR and task - guarded by motionMux
+static portMUX_TYPE motionMux = portMUX_INITIALIZER_UNLOCKED;
+static TaskHandle_t listener = nullptr;          // Task to notify on motion
+static volatile unsigned long lastTriggerTime = 0; // Timestamp of last trigger for debouncing
+static volatile bool eventPending = false;       // Event raised but not yet taken
+static volatile unsigned long eventTriggerMs = 0; // Trigger time of pending event
+static volatile uint64_t eventTriggerUs = 0;     // Same, in esp_timer microseconds
+static volatile uint32_t edgeCount = 0;          // Edges since last event was taken
 
 /*
  * Interrupt Service Routine (ISR) for motion detection
@@ -22,16 +37,61 @@ volatile unsigned long lastTriggerTime = 0;  // Timestamp of last trigger for de
  * - PIR sensor oscillation after detection
  * - Multiple rapid movements
  * - Electrical noise
+ * 
+ * Debounced edges are still counted so the next event reports them.
  */
 void IRAM_ATTR onMotion() { 
   unsigned long now = millis();  // Current time in milliseconds
+  bool notify = false;
   
-  // Debounce logic: only set flag if >5 seconds since last trigger
+  portENTER_CRITICAL_ISR(&motionMux);
+  edgeCount++;
+  // Debounce logic: only raise an event if >5 seconds since last trigger
   if (now - lastTriggerTime > 5000) {
-    motionFlag = true;  // Signal to AlertTask that motion was detected
+    if (!eventPending) {
+      eventPending = true;
+      eventTriggerMs = now;  // Keep the first trigger time of this event
+      eventTriggerUs = esp_timer_get_time();
+    }
     lastTriggerTime = now;  // Record trigger time for next debounce check
+    notify = true;
+  }
+  // If < 5 seconds, edge is only counted (debounce suppression)
+  portEXIT_CRITICAL_ISR(&motionMux);
+  
+  if (notify && listener) {
+    BaseType_t woken = pdFALSE;
+    vTaskNotifyGiveFromISR(listener, &woken);  // Wake AlertTask
+    portYIELD_FROM_ISR(woken);  // Switch to it right away if higher priority
+  }
+}
+
+/*
+ * Level ISR used when the PIR pin is a light-sleep wake source
+ * 
+ * Light sleep only wakes on a GPIO level, and arming the pin for wake
+ * turns its interrupt into a level interrupt. Flipping the armed level
+ * on every interrupt turns the pair back into edges: HIGH is the rising
+ * edge (motion), LOW only re-arms for the next one. The chip therefore
+ * wakes at most twice per PIR pulse instead of spinning on the level.
+ * 
+ * The wake enable itself is set once in Motion::init. The GPIO ISR
+ * service runs with the flash cache off (NVS writes, LittleFS spills),
+ * so the flip only rewrites the pin's interrupt type through the
+ * inline HAL register access - gpio_wakeup_enable() lives in flash.
+ */
+static int pirPin = -1;
+static volatile bool armedHigh = true;
+
+static void IRAM_ATTR onPirLevel() {
+  if (armedHigh) {
+    gpio_ll_set_intr_type(&GPIO, (gpio_num_t)pirPin, GPIO_INTR_LOW_LEVEL);
+    armedHigh = false;
+    onMotion();
+  } else {
+    gpio_ll_set_intr_type(&GPIO, (gpio_num_t)pirPin, GPIO_INTR_HIGH_LEVEL);
+    armedHigh = true;
   }
-  // If < 5 seconds, ignore this trigger (debounce suppression)
 }
 
 /*
@@ -43,10 +103,13 @@ void IRAM_ATTR onMotion() {
  * 1. Enable internal pull-down resistor for stable LOW state
  * 2. Attach interrupt on RISING edge (LOW->HIGH transition)
  * 3. ISR debounces triggers to prevent false positives
+ * 
+ * With POWER_MANAGED step 2 uses a level interrupt that is also enabled
+ * as a GPIO wake source (see onPirLevel).
  */
 void Motion::init(int pin) {
-  Serial.println("\n=== MOTION SENSOR INIT ===");
-  Serial.println("[MOTION] Configuring PIR on pin: " + String(pin));
+  LOG_BANNER("\n=== MOTION SENSOR INIT ===");
+  LOGI("MOTION", "Configuring PIR on pin: %d", pin);
   
   // Configure pin with internal pull-down resistor
   // Pull-down ensures pin reads LOW when PIR is idle
@@ -58,26 +121,62 @@ void Motion::init(int pin) {
   // Attach interrupt handler to this pin
   // Triggers on RISING edge (LOW->HIGH) when PIR detects motion
   // onMotion() ISR will be called automatically by hardware
-  attachInterrupt(pin, onMotion, RISING);
-  
-  Serial.println("[MOTION] Interrupt attached on RISING edge with pull-down");
-  Serial.println("[MOTION] Debounce time: 5 seconds");
-  Serial.println("[MOTION] Sensor ready");
+  if (POWER_MANAGED) {
+    pirPin = pin;
+    attachInterrupt(pin, onPirLevel, ONHIGH);
+    gpio_wakeup_enable((gpio_num_t)pin, GPIO_INTR_HIGH_LEVEL);
+    esp_sleep_enable_gpio_wakeup();
+    LOGI("MOTION", "Level interrupt attached, pin armed as light-sleep wake source");
+  } else {
+    attachInterrupt(pin, onMotion, RISING);
+    LOGI("MOTION", "Interrupt attached on RISING edge with pull-down");
+  }
+  LOGI("MOTION", "Debounce time: 5 seconds");
+  LOGI("MOTION", "Sensor ready");
+}
+
+/*
+ * Register the task woken by the ISR on motion
+ * 
+ * Called by AlertTask itself at startup. If an event was raised before
+ * the listener existed, the task is notified immediately.
+ * 
+ * @param task: Handle of the task that calls waitForEvent()
+ */
+void Motion::setListener(TaskHandle_t task) {
+  portENTER_CRITICAL(&motionMux);
+  listener = task;
+  bool pending = eventPending;
+  portEXIT_CRITICAL(&motionMux);
+  if (pending) xTaskNotifyGive(task);
 }
 
 /*
- * Check if motion was detected since last check
+ * Block until the ISR signals motion or the timeout expires
  * 
- * Returns true if motion flag was set by ISR, false otherwise.
- * Automatically clears the flag after returning true (single-shot behavior).
+ * Fills ev with the trigger time and the number of PIR edges folded
+ * into the event, then resets the pending state (single-shot behavior).
+ * Several notifications taken at once collapse into one event.
  * 
- * Called by AlertTask every second to poll for motion events.
+ * @param ev: Receives the motion event
+ * @param timeout: Max ticks to wait (default: forever)
+ * @return true if an event was taken, false on timeout
  */
-bool Motion::motionDetected() {
-  if (motionFlag) {
-    Serial.println("\n⚠️  [MOTION] DETECTED! Flag was set by interrupt");
-    motionFlag = false;  // Clear flag so we don't re-process this event
-    return true;
+bool Motion::waitForEvent(MotionEvent &ev, TickType_t timeout) {
+  if (ulTaskNotifyTake(pdTRUE, timeout) == 0) return false;  // Timed out
+  
+  portENTER_CRITICAL(&motionMux);
+  bool pending = eventPending;
+  if (pending) {
+    ev.triggerMs = eventTriggerMs;
+    ev.triggerUs = eventTriggerUs;
+    ev.edges = edgeCount;
+    edgeCount = 0;
+    eventPending = false;
   }
-  return false;  // No motion detected
-}
\ No newline at end of file
+  portEXIT_CRITICAL(&motionMux);
+  
+  if (!pending) return false;
+  LOGW("MOTION", "⚠️  DETECTED! Woken by interrupt (%u edge(s), %lums after trigger)", (unsigned)ev.edges, millis() - ev.triggerMs);
+  return true;
+}
@@ -0,0 +1,109 @@
+/*
+ * Motion Digest Module - Cooldown Event Aggregation
+ * 
+ * Pure logic behind the motion cooldown (scheduler.cpp AlertTask),
+ * kept free of I/O so it can be unit tested on the host ([env:native]).
+ * 
+ * After a motion alert, further events within ALERT_COOLDOWN_MS used to
+ * be dropped, so a sustained intrusion produced one alert and then
+ * silence. The digest keeps counting them instead: the trigger times of
+ * the last DIGEST_MAX_EVENTS events and the newest DIGEST_MAX_PHOTOS
+ * frame handles sit in fixed rings, and older entries are only counted.
+ * When the window ends, describe() turns it into one short caption.
+ */
+
+#include "motion_digest.h"
+
+/*
+ * Start an empty digest
+ * 
+ * @param windowStartMs: millis() of the alert that opened the window;
+ *                       describe() reports event times relative to it
+ */
+void Digest::open(MotionDigest &d, unsigned long windowStartMs) {
+  memset(&d, 0, sizeof(d));
+  d.windowStartMs = windowStartMs;
+}
+
+/*
+ * Fold one event into the digest
+ * 
+ * @param triggerMs: millis() of the event's PIR edge
+ * @param edges: PIR edges behind the event (debounced ones included)
+ * @param photoUrl: frame handle for the event, "" or nullptr if none;
+ *                  truncated to DIGEST_URL_LEN
+ */
+void Digest::add(MotionDigest &d, unsigned long triggerMs, uint32_t edges, const char *photoUrl) {
+  d.events++;
+  d.edges += edges;
+  d.times[d.nextTime] = triggerMs;
+  d.nextTime = (d.nextTime + 1) % DIGEST_MAX_EVENTS;
+  if (photoUrl && photoUrl[0]) {
+    snprintf(d.photos[d.nextPhoto], DIGEST_URL_LEN, "%s", photoUrl);
+    d.nextPhoto = (d.nextPhoto + 1) % DIGEST_MAX_PHOTOS;
+    d.photosTaken++;
+  }
+}
+
+// Frames held in the ring
+int Digest::photoCount(const MotionDigest &d) {
+  return d.photosTaken < DIGEST_MAX_PHOTOS ? (int)d.photosTaken : DIGEST_MAX_PHOTOS;
+}
+
+/*
+ * Kept frame handle, oldest first
+ * 
+ * @param i: 0 .. photoCount() - 1
+ * @return frame handle, "" if i is out of range
+ */
+const char *Digest::photo(const MotionDigest &d, int i) {
+  int n = photoCount(d);
+  if (i < 0 || i >= n) return "";
+  int first = d.photosTaken < DIGEST_MAX_PHOTOS ? 0 : d.nextPhoto;
+  return d.photos[(first + i) % DIGEST_MAX_PHOTOS];
+}
+
+/*
+ * Summary caption
+ * 
+ * First line counts events and frames ("12 more motion events, 3
+ * photos", PIR edges too when the debounce folded some); the second
+ * lists the kept trigger times in seconds after the window opened. Times
+ * that do not fit in cap are replaced by "…", so the caption always fits.
+ * 
+ * @param out: receives the NUL-terminated caption
+ * @param cap: size of out
+ * @return length written
+ */
+size_t Digest::describe(const MotionDigest &d, char *out, size_t cap) {
+  if (cap == 0) return 0;
+  int photos = photoCount(d);
+  int len = snprintf(out, cap, "%u more motion event%s", (unsigned)d.events, d.events == 1 ? "" : "s");
+  if (d.edges > d.events && len < (int)cap) {
+    len += snprintf(out + len, cap - len, " (%u PIR edges)", (unsigned)d.edges);
+  }
+  if (photos > 0 && len < (int)cap) {
+    len += snprintf(out + len, cap - len, ", %d photo%s", photos, photos == 1 ? "" : "s");
+  }
+  if (len >= (int)cap) return cap - 1;
+  
+  // Trigger times, oldest kept first; older ones were only counted
+  uint32_t kept = d.events < DIGEST_MAX_EVENTS ? d.events : DIGEST_MAX_EVENTS;
+  int first = d.events < DIGEST_MAX_EVENTS ? 0 : d.nextTime;
+  const char *more = " …";
+  const size_t moreLen = strlen(more);
+  for (uint32_t i = 0; i < kept; i++) {
+    char item[16];
+    unsigned long at = d.times[(first + i) % DIGEST_MAX_EVENTS] - d.windowStartMs;
+    int n = snprintf(item, sizeof(item), "%s+%lus", i == 0 ? (d.events > kept ? "\n… " : "\n") : " ", at / 1000);
+    // Room for this one, and for the ellipsis if more follow
+    size_t need = n + (i + 1 < kept ? moreLen : 0);
+    if (len + need >= cap) {
+      if (i > 0 && len + moreLen < cap) len += snprintf(out + len, cap - len, "%s", more);
+      break;
+    }
+    memcpy(out + len, item, n + 1);
+    len += n;
+  }
+  return len;
+}
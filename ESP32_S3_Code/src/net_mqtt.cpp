@@ -1,151 +1,550 @@
 /*
  * MQTT Network Module - Adafruit IO Cloud Integration
  * 
- * Handles all MQTT communication with Adafruit IO cloud service.
+ * Handles all MQTT communication with Adafruit IO cloud service, or
+ * with a self-hosted broker (MQTT_BACKEND, see below).
  * Publishes sensor data to three separate feeds:
  * - temperature (°C values)
  * - humidity (% values)
  * - alerts (text event messages)
  * 
- * Implements connection retry logic and rate limiting to comply
+ * Implements connection management and rate limiting to comply
  * with Adafruit IO free tier restrictions (30 data points/minute).
+ * 
+ * Publishing is asynchronous: callers only enqueue and return. A single
+ * MqttTask owns the client and drains the queue through a token bucket,
+ * so the 30/min limit is enforced globally instead of by scattered
+ * delays. Temperature and humidity go out together as one Adafruit IO
+ * group message.
+ * 
+ * Readings are spooled through Store (RAM ring + LittleFS), so an
+ * outage only delays them. After reconnect the backlog drains oldest
+ * first under the same token bucket, with each point back-dated to
+ * its recording time via created_at.
+ * 
+ * The IO_CONFIG_FEED feed is subscribed to; its values are handed to
+ * the config handler (weather limits, see Alerts::configureWeather).
+ * 
+ * The broker link is kept by a small state machine (disconnected,
+ * connecting, connected, backoff) stepped from MqttTask. Failed connects
+ * back off exponentially with jitter instead of delay(5000), and an
+ * idle link is kept alive with MQTT pings.
+ * 
+ * Broker backend (MQTT_BACKEND_BROKER): the same task and queues talk
+ * to BROKER_HOST over TLS (WiFiClientSecure) with QoS 1. Each reading
+ * is one packed binary message (Telemetry::encode) with a sequence
+ * number plus RSSI, free heap and uptime, so one sensor cycle is one
+ * publish and nothing needs spacing out; the token bucket only guards
+ * against bursts there. A QoS 1 publish waits for its PUBACK inside
+ * MqttTask, which is the only task that ever waits on the broker.
  */
 
 #include "net_mqtt.h"
 #include "config.h"
+#include "store.h"
+#include "utils.h"
+#include "logging.h"
+#include "metrics.h"
+#include "scheduler.h"
+#include "telemetry.h"
+#include "boot.h"
 #include <WiFi.h>
+#include <WiFiClientSecure.h>
 #include <Adafruit_MQTT.h>
 #include <Adafruit_MQTT_Client.h>
 
+#if MQTT_BACKEND == MQTT_BACKEND_BROKER
+// Self-hosted broker: TLS by default, QoS 1 on every topic
+#if BROKER_TLS
+WiFiClientSecure client;
+#else
+WiFiClient client;
+#endif
+Adafruit_MQTT_Client mqtt(&client, BROKER_HOST, BROKER_PORT, BROKER_USER, BROKER_USER, BROKER_PASS);
+#define MQTT_SERVER_NAME BROKER_HOST
+#define MQTT_SERVER_PORT BROKER_PORT
+
+Adafruit_MQTT_Publish telemetryTopic = Adafruit_MQTT_Publish(&mqtt, BROKER_TOPIC "/telemetry", MQTT_QOS_1);
+Adafruit_MQTT_Publish alertFeed = Adafruit_MQTT_Publish(&mqtt, BROKER_TOPIC "/alert", MQTT_QOS_1);
+Adafruit_MQTT_Publish metricsFeed = Adafruit_MQTT_Publish(&mqtt, BROKER_TOPIC "/metrics", MQTT_QOS_1);
+Adafruit_MQTT_Subscribe configFeed = Adafruit_MQTT_Subscribe(&mqtt, BROKER_TOPIC "/config", MQTT_QOS_1);
+static uint32_t telemetrySeq = 0;  // Advanced only once the broker acknowledged a message
+
+static const uint32_t RATE_PER_MIN = BROKER_RATE_PER_MIN;
+static const uint32_t MQTT_BUCKET_SIZE = 20;
+#else
 // Adafruit IO MQTT Setup
 WiFiClient client;  // WiFi client for TCP connection
 Adafruit_MQTT_Client mqtt(&client, "io.adafruit.com", 1883, IO_USERNAME, IO_KEY);
+#define MQTT_SERVER_NAME "io.adafruit.com"
+#define MQTT_SERVER_PORT 1883
 
 // Adafruit IO Feeds - one per data type
 // Feed names must match your Adafruit IO dashboard configuration
-Adafruit_MQTT_Publish tempFeed = Adafruit_MQTT_Publish(&mqtt, IO_USERNAME "/feeds/temperature");
-Adafruit_MQTT_Publish humFeed = Adafruit_MQTT_Publish(&mqtt, IO_USERNAME "/feeds/humidity");
+// Temperature and humidity are published through the group topic, which
+// sets several feeds of the group in one message
+Adafruit_MQTT_Publish envGroup = Adafruit_MQTT_Publish(&mqtt, IO_USERNAME "/groups/" IO_GROUP);
 Adafruit_MQTT_Publish alertFeed = Adafruit_MQTT_Publish(&mqtt, IO_USERNAME "/feeds/alerts");
 
+// Backlog points go to the per-feed /json topics, which accept a
+// created_at field so the dashboard shows when they were recorded
+Adafruit_MQTT_Publish tempJson = Adafruit_MQTT_Publish(&mqtt, IO_USERNAME "/feeds/temperature/json");
+Adafruit_MQTT_Publish humJson = Adafruit_MQTT_Publish(&mqtt, IO_USERNAME "/feeds/humidity/json");
+Adafruit_MQTT_Publish alertJson = Adafruit_MQTT_Publish(&mqtt, IO_USERNAME "/feeds/alerts/json");
+
+Adafruit_MQTT_Publish metricsFeed = Adafruit_MQTT_Publish(&mqtt, IO_USERNAME "/feeds/" IO_METRICS_FEED);
+
+// Runtime configuration from the dashboard (subscriptions cost no data points)
+Adafruit_MQTT_Subscribe configFeed = Adafruit_MQTT_Subscribe(&mqtt, IO_USERNAME "/feeds/" IO_CONFIG_FEED);
+
+static const uint32_t RATE_PER_MIN = IO_RATE_PER_MIN;
+static const uint32_t MQTT_BUCKET_SIZE = 4;
+#endif
+
+static bool (*configHandler)(const char *command) = nullptr;
+static const int16_t SUBSCRIBE_POLL_MS = 10;  // Wait for an incoming packet per MqttTask cycle
+
+// ---- Latest metrics summary (replaced, not queued) ----
+static portMUX_TYPE metricsMux = portMUX_INITIALIZER_UNLOCKED;
+static char pendingMetrics[112];
+static bool metricsPending = false;
+
+// ---- Live alert queue (overflow goes to Store) ----
+static QueueHandle_t alertQueue = nullptr; // char[ALERT_REASON_LEN] items
+
+static const size_t ALERT_REASON_LEN = 24;
+static const UBaseType_t ALERT_QUEUE_DEPTH = 8;
+static const uint32_t LIVE_AGE_S = 90;        // Younger records are sent without created_at
+static const uint8_t DRAIN_BATCH = 8;         // Store records sent per MqttTask cycle
+
+// ---- Token bucket (Adafruit IO data points) ----
+// Holds up to MQTT_BUCKET_SIZE points, refilled at RATE_PER_MIN.
+// Kept in milli-tokens so refill is exact with integer math.
+static uint32_t bucketMilli = MQTT_BUCKET_SIZE * 1000;
+static unsigned long bucketLastRefill = 0;
+
+static void bucketRefill() {
+  unsigned long now = millis();
+  // 64-bit: the first refill after an outage spans the whole outage,
+  // which overflows 32 bits within minutes at RATE_PER_MIN
+  uint64_t earned = (uint64_t)(now - bucketLastRefill) * RATE_PER_MIN * 1000 / 60000;
+  if (earned == 0) return;  // Keep remainder time until a whole milli-token accrues
+  bucketLastRefill = now;
+  uint64_t filled = bucketMilli + earned;
+  bucketMilli = filled > MQTT_BUCKET_SIZE * 1000 ? MQTT_BUCKET_SIZE * 1000 : (uint32_t)filled;
+}
+
+// Take `points` tokens if available
+static bool bucketTake(uint32_t points) {
+  if (bucketMilli < points * 1000) return false;
+  bucketMilli -= points * 1000;
+  return true;
+}
+
+// ---- Connection manager ----
+// DISCONNECTED -> CONNECTING -> CONNECTED
+//       ^              |            |
+//       +-- BACKOFF <--+------------+  (failed connect / lost link)
+enum MqttState { MQTT_DISCONNECTED, MQTT_CONNECTING, MQTT_CONNECTED, MQTT_BACKOFF };
+static MqttState mqttState = MQTT_DISCONNECTED;
+static uint8_t connectFailures = 0;       // Consecutive failed attempts
+static unsigned long backoffUntil = 0;    // millis() when BACKOFF ends
+static unsigned long lastActivity = 0;    // Last successful publish/ping
+static bool everConnected = false;        // Later connects count as reconnects
+
+static const unsigned long BACKOFF_BASE_MS = 1000;
+static const unsigned long BACKOFF_MAX_MS = 60000;
+static const unsigned long PING_INTERVAL_MS = 60000;  // Well inside the 300s MQTT keep-alive
+
+static const char *stateName(MqttState s) {
+  switch (s) {
+    case MQTT_DISCONNECTED: return "disconnected";
+    case MQTT_CONNECTING:   return "connecting";
+    case MQTT_CONNECTED:    return "connected";
+    default:                return "backoff";
+  }
+}
+
+static void setState(MqttState s) {
+  if (s == mqttState) return;
+  LOGI("MQTT", "State: %s -> %s", stateName(mqttState), stateName(s));
+  mqttState = s;
+}
+
 /*
- * Connect to MQTT broker with retry logic
+ * Enter BACKOFF after a failed attempt or a dropped link
  * 
- * Attempts connection up to 3 times with 5-second delays.
- * If connection fails, logs error but continues (graceful degradation).
- * System will retry on next publish attempt.
+ * Delay is full-jitter exponential: random in [base/2, base*2^n],
+ * capped at BACKOFF_MAX_MS, so a broker outage is not hammered and
+ * several devices do not reconnect in lockstep.
  */
-void MQTT_connect() {
-  if (mqtt.connected()) {
-    Serial.println("[MQTT] Already connected");
-    return;
-  }
-  
-  Serial.println("\n=== MQTT CONNECTION ===");
-  Serial.println("[MQTT] Connecting to io.adafruit.com:1883");
-  Serial.println("[MQTT] Username: " + String(IO_USERNAME));
-  int8_t ret;
-  uint8_t retries = 3;
-  
-  while ((ret = mqtt.connect()) != 0) {
-    Serial.print("[MQTT] Connection failed: ");
-    Serial.println(mqtt.connectErrorString(ret));
-    Serial.println("[MQTT] Retry attempt " + String(4 - retries) + "/3");
-    Serial.println("[MQTT] Waiting 5 seconds before retry...");
-    mqtt.disconnect();
-    delay(5000);
-    retries--;
-    if (retries == 0) {
-      Serial.println("[MQTT] ERROR: Connection failed after 3 attempts. Continuing anyway.");
-      return;
+static void enterBackoff() {
+  mqtt.disconnect();
+  if (connectFailures < 16) connectFailures++;
+  unsigned long ceiling = min(BACKOFF_BASE_MS << (connectFailures - 1), BACKOFF_MAX_MS);
+  unsigned long wait = BACKOFF_BASE_MS / 2 + esp_random() % (ceiling - BACKOFF_BASE_MS / 2 + 1);
+  backoffUntil = millis() + wait;
+  LOGI("MQTT", "Retry %u in %lums", (unsigned)connectFailures, wait);
+  setState(MQTT_BACKOFF);
+}
+
+/*
+ * Advance the connection state machine by one step
+ * 
+ * Never sleeps: each call makes at most one connect attempt (bounded
+ * by the TCP/CONNACK timeout of the client) or one ping, then returns.
+ * 
+ * @return true if the link is up and publishing may proceed
+ */
+static bool connectionStep() {
+  switch (mqttState) {
+    case MQTT_DISCONNECTED:
+      if (WiFi.status() != WL_CONNECTED) return false;  // Wait for Wi-Fi
+      setState(MQTT_CONNECTING);
+      // fall through
+    case MQTT_CONNECTING: {
+      LOGI("MQTT", "Connecting to %s:%u", MQTT_SERVER_NAME, (unsigned)MQTT_SERVER_PORT);
+      int8_t ret = mqtt.connect();
+      if (ret != 0) {
+        LOGE("MQTT", "✗ Connection failed: %d", ret);
+        enterBackoff();
+        return false;
+      }
+      LOGI("MQTT", "✓ Connected successfully!");
+      connectFailures = 0;
+      lastActivity = millis();
+      if (everConnected) Metrics::count(M_MQTT_RECONNECT);
+      everConnected = true;
+      Boot::ready(BOOT_MQTT);
+      setState(MQTT_CONNECTED);
+      return true;
     }
+    case MQTT_CONNECTED:
+      if (!mqtt.connected()) {
+        LOGW("MQTT", "⚠ Link lost");
+        enterBackoff();
+        return false;
+      }
+      if (millis() - lastActivity >= PING_INTERVAL_MS) {
+        if (!mqtt.ping()) {
+          LOGW("MQTT", "⚠ Ping failed");
+          enterBackoff();
+          return false;
+        }
+        lastActivity = millis();
+      }
+      return true;
+    case MQTT_BACKOFF:
+      if ((long)(millis() - backoffUntil) >= 0) setState(MQTT_DISCONNECTED);
+      return false;
   }
-  Serial.println("[MQTT] ✓ Connected successfully!");
-  Serial.println("[MQTT] Ready to publish data");
+  return false;
 }
 
+#if MQTT_BACKEND == MQTT_BACKEND_BROKER
 /*
- * Initialize MQTT connection
- * Called once during setup()
+ * Publish an alert to BROKER_TOPIC/alert
+ * Payload: {"reason":"motion","epoch":1736922645} (epoch 0 = clock not synced)
  */
-void NetMQTT::init() {
-  MQTT_connect();
+static bool publishAlertNow(const char *reason, uint32_t epoch) {
+  char payload[64];
+  snprintf(payload, sizeof(payload), "{\"reason\":\"%s\",\"epoch\":%u}", reason, (unsigned)epoch);
+  return alertFeed.publish(payload);
 }
 
 /*
- * Publish environmental sensor data to Adafruit IO
+ * Publish one buffered record to the broker
  * 
- * Publishes temperature and humidity to separate feeds with:
- * - NaN validation (skips invalid readings)
- * - 1-second delay between publishes (rate limit compliance)
- * - Performance logging
+ * Readings become one TELEMETRY_LEN-byte message; records older than
+ * LIVE_AGE_S are flagged TLM_BACKLOG. The sequence number only advances
+ * once the broker acknowledged, so a retried message keeps its number
+ * and the collector can drop the duplicate.
  * 
- * @param d: SensorData struct with temp, humidity, timestamp
+ * @return true if the broker acknowledged (QoS 1 PUBACK)
  */
-void NetMQTT::publishEnv(SensorData d) {
-  unsigned long startTime = millis();
-  Serial.println("\n=== PUBLISHING SENSOR DATA ===");
-  MQTT_connect();  // Ensure connection is active
+static bool sendRecord(const StoreRecord &r) {
+  time_t now = Utils::epoch();
+  if (r.kind == STORE_ALERT) {
+    const char *reason = Store::reasonName(r.reason);
+    LOGI("MQTT", "Publishing buffered alert: %s", reason);
+    return publishAlertNow(reason, r.epoch);
+  }
   
-  // Publish temperature and humidity to separate feeds
-  if (!isnan(d.temp)) {
-    Serial.print("[MQTT] Publishing temperature: ");
-    Serial.print(d.temp);
-    Serial.println("°C");
-    if (tempFeed.publish(d.temp)) {
-      Serial.println("[MQTT] ✓ Temperature published successfully");
-    } else {
-      Serial.println("[MQTT] ✗ Failed to publish temperature");
-    }
-    delay(1000); // 1 second delay between publishes (rate limit: 2 per second)
+  TelemetryReading t;
+  t.flags = (r.epoch != 0 ? TLM_CLOCK : 0);
+  if (r.epoch != 0 && now != 0 && (uint32_t)(now - r.epoch) > LIVE_AGE_S) t.flags |= TLM_BACKLOG;
+  t.seq = telemetrySeq;
+  t.epoch = r.epoch;
+  t.temp10 = r.temp10;
+  t.hum10 = r.hum10;
+  t.rssi = (int8_t)WiFi.RSSI();
+  t.freeHeap = ESP.getFreeHeap();
+  t.uptimeS = millis() / 1000;
+  uint8_t msg[TELEMETRY_LEN];
+  size_t len = Telemetry::encode(t, msg, sizeof(msg));
+  bool ok = telemetryTopic.publish(msg, (uint16_t)len);
+  if (ok) {
+    telemetrySeq++;
+    LOGD("MQTT", "✓ Telemetry #%u%s", (unsigned)t.seq, (t.flags & TLM_BACKLOG) ? " (backlog)" : "");
   } else {
-    Serial.println("[MQTT] ⚠ Temperature reading is NaN, skipping");
+    LOGE("MQTT", "✗ Telemetry #%u not acknowledged - kept in buffer", (unsigned)t.seq);
   }
+  return ok;
+}
+
+// One message per record, whatever it holds
+static uint32_t recordCost(const StoreRecord &) {
+  return 1;
+}
+#else
+/*
+ * Publish a live alert to the alerts feed
+ */
+static bool publishAlertNow(const char *reason, uint32_t) {
+  return alertFeed.publish(reason);  // Adafruit IO stamps live alerts on arrival
+}
+
+/*
+ * Publish one value with its recording time
+ * Payload: {"value":"23.4","created_at":"2025-01-15T06:30:45Z"}
+ */
+static bool publishDated(Adafruit_MQTT_Publish &feed, const char *value, uint32_t epoch) {
+  char when[24];
+  char payload[96];
+  Utils::formatIso(epoch, when, sizeof(when));
+  snprintf(payload, sizeof(payload), "{\"value\":\"%s\",\"created_at\":\"%s\"}", value, when);
+  return feed.publish(payload);
+}
+
+/*
+ * Publish one buffered record
+ * 
+ * Fresh readings go out as one Adafruit IO group message:
+ *   {"feeds":{"temperature":"23.4","humidity":"55.0"}}
+ * Backlog records (older than LIVE_AGE_S) are sent per feed with
+ * created_at. NaN values are left out. If the second feed of a dated
+ * reading fails, the whole record is retried and the first point may
+ * be sent twice.
+ * 
+ * @return true if the broker accepted every publish
+ */
+static bool sendRecord(const StoreRecord &r) {
+  time_t now = Utils::epoch();
+  bool dated = r.epoch != 0 && now != 0 && (uint32_t)(now - r.epoch) > LIVE_AGE_S;
+  bool hasTemp = r.temp10 != STORE_NAN_TEMP;
+  bool hasHum = r.hum10 != STORE_NAN_HUM;
+  char temp[8], hum[8];
+  snprintf(temp, sizeof(temp), "%.1f", r.temp10 / 10.0f);
+  snprintf(hum, sizeof(hum), "%.1f", r.hum10 / 10.0f);
+  bool ok;
   
-  if (!isnan(d.hum)) {
-    Serial.print("[MQTT] Publishing humidity: ");
-    Serial.print(d.hum);
-    Serial.println("%");
-    if (humFeed.publish(d.hum)) {
-      Serial.println("[MQTT] ✓ Humidity published successfully");
-    } else {
-      Serial.println("[MQTT] ✗ Failed to publish humidity");
-    }
+  if (r.kind == STORE_ALERT) {
+    const char *reason = Store::reasonName(r.reason);
+    LOGI("MQTT", "Publishing buffered alert: %s", reason);
+    ok = dated ? publishDated(alertJson, reason, r.epoch) : alertFeed.publish(reason);
+  } else if (dated) {
+    LOGI("MQTT", "Publishing backlog reading from %us ago", (unsigned)(now - r.epoch));
+    ok = (!hasTemp || publishDated(tempJson, temp, r.epoch)) &&
+         (!hasHum || publishDated(humJson, hum, r.epoch));
   } else {
-    Serial.println("[MQTT] ⚠ Humidity reading is NaN, skipping");
+    char payload[80];  // Longest payload is ~55 bytes
+    int n = snprintf(payload, sizeof(payload), "{\"feeds\":{");
+    if (hasTemp) n += snprintf(payload + n, sizeof(payload) - n, "\"temperature\":\"%s\"%s", temp, hasHum ? "," : "");
+    if (hasHum) n += snprintf(payload + n, sizeof(payload) - n, "\"humidity\":\"%s\"", hum);
+    snprintf(payload + n, sizeof(payload) - n, "}}");
+    LOGI("MQTT", "Publishing sensor group: %s", payload);
+    ok = envGroup.publish(payload);
   }
   
-  unsigned long elapsed = millis() - startTime;
-  Serial.println("[PERF] MQTT publish took: " + String(elapsed) + "ms");
+  if (ok) {
+    LOGI("MQTT", "✓ Published successfully");
+  } else {
+    LOGE("MQTT", "✗ Publish failed - kept in buffer");
+  }
+  return ok;
+}
+
+/*
+ * Number of Adafruit IO data points a record costs (one per feed set)
+ */
+static uint32_t recordCost(const StoreRecord &r) {
+  if (r.kind == STORE_ALERT) return 1;
+  return (r.temp10 == STORE_NAN_TEMP ? 0 : 1) + (r.hum10 == STORE_NAN_HUM ? 0 : 1);
 }
+#endif
 
 /*
- * Publish alert event to Adafruit IO alerts feed
+ * MQTT Task - sole owner of the MQTT client
  * 
- * Formats and publishes alert messages to dashboard.
- * Photo URLs are not included (Telegram-only for images).
+ * Every 200ms:
+ * 1. Step the connection state machine (never blocks on backoff)
+ * 2. Refill the token bucket
+ * 3. Hand any IO_CONFIG_FEED value to the config handler
+ * 4. Send queued alerts first, then the latest metrics summary, then
+ *    up to DRAIN_BATCH buffered records (oldest first), each only if
+ *    enough tokens are available
  * 
- * @param reason: Alert type (e.g., "motion", "high_temperature")
- * @param photoURL: Image URL (not used for MQTT, kept for API consistency)
+ * Failed publishes stay queued and are retried on a later cycle.
  */
-void NetMQTT::publishAlert(String reason, String photoURL) {
-  Serial.println("\n=== PUBLISHING ALERT ===");
-  Serial.println("[MQTT] Alert reason: " + reason);
-  MQTT_connect();
+static void taskMqtt(void *) {
+  LOGI("TASK", "MqttTask started");
+  Scheduler::watchCurrentTask();
+  bucketLastRefill = millis();
+  char reason[ALERT_REASON_LEN];
   
-  // Send alert as formatted string
-  String alertMsg = reason;
-  if (photoURL.length() > 0) {
-    Serial.println("[MQTT] Photo URL: " + photoURL);
-    alertMsg += " | Photo: " + photoURL;
-  } else {
-    Serial.println("[MQTT] No photo URL provided");
+  for (;;) {
+    Scheduler::feedWatchdog();
+    if (connectionStep()) {
+      bucketRefill();
+      
+      // === Incoming configuration ===
+      Adafruit_MQTT_Subscribe *sub;
+      while ((sub = mqtt.readSubscription(SUBSCRIBE_POLL_MS)) != nullptr) {
+        if (sub != &configFeed) continue;
+        LOGI("MQTT", "Config received: %s", (const char *)configFeed.lastread);
+        if (configHandler) configHandler((const char *)configFeed.lastread);
+        lastActivity = millis();
+      }
+      
+      // === Alerts: highest priority, one point each ===
+      while (xQueuePeek(alertQueue, reason, 0) == pdTRUE && bucketTake(1)) {
+        LOGI("MQTT", "Publishing alert: %s", reason);
+        uint64_t startUs = Metrics::now();
+        bool sent = publishAlertNow(reason, (uint32_t)Utils::epoch());
+        Metrics::observeSince(H_MQTT_ALERT, startUs);
+        if (!sent) {
+          LOGE("MQTT", "✗ Failed to publish alert - will retry");
+          Metrics::count(M_MQTT_PUBLISH_FAIL);
+          bucketMilli += 1000;  // Refund; the point was not used
+          break;
+        }
+        xQueueReceive(alertQueue, reason, 0);  // Sent - drop from queue
+        lastActivity = millis();
+        LOGI("MQTT", "✓ Alert published successfully");
+      }
+      
+      // === Metrics summary: one point, latest only ===
+      if (metricsPending && bucketTake(1)) {
+        char payload[sizeof(pendingMetrics)];
+        portENTER_CRITICAL(&metricsMux);
+        memcpy(payload, pendingMetrics, sizeof(payload));
+        metricsPending = false;
+        portEXIT_CRITICAL(&metricsMux);
+        if (metricsFeed.publish(payload)) {
+          lastActivity = millis();
+        } else {
+          Metrics::count(M_MQTT_PUBLISH_FAIL);  // Dropped; the next summary supersedes it
+        }
+      }
+      
+      // === Buffered readings and overflow alerts, oldest first ===
+      StoreRecord r;
+      for (uint8_t n = 0; n < DRAIN_BATCH && Store::peek(r); n++) {
+        uint32_t cost = recordCost(r);
+        if (!bucketTake(cost)) break;  // Resume when tokens refill
+        uint64_t startUs = Metrics::now();
+        bool sent = sendRecord(r);
+        Metrics::observeSince(H_MQTT_PUBLISH, startUs);
+        if (!sent) {
+          Metrics::count(M_MQTT_PUBLISH_FAIL);
+          bucketMilli += cost * 1000;  // Refund
+          break;
+        }
+        Store::pop();
+        lastActivity = millis();
+        LOGD("MQTT", "%u records left in buffer", (unsigned)Store::pending());
+      }
+    }
+    
+    // Slower polling lets a power-managed chip stay asleep between polls
+    vTaskDelay(pdMS_TO_TICKS(POWER_MANAGED ? POWER_IDLE_POLL_MS : 200));
   }
-  
-  Serial.println("[MQTT] Publishing to alerts feed...");
-  if (alertFeed.publish(alertMsg.c_str())) {
-    Serial.println("[MQTT] ✓ Alert published successfully");
-    Serial.println("[MQTT] Message: " + alertMsg);
+}
+
+/*
+ * Initialize MQTT publishing
+ * Creates the alert queue and the MqttTask, which connects to the
+ * broker in the background. Called once during setup()
+ */
+void NetMQTT::init() {
+  alertQueue = xQueueCreate(ALERT_QUEUE_DEPTH, ALERT_REASON_LEN);
+#if MQTT_BACKEND == MQTT_BACKEND_BROKER && BROKER_TLS
+  if (BROKER_CA_PEM[0]) {
+    client.setCACert(BROKER_CA_PEM);
   } else {
-    Serial.println("[MQTT] ✗ Failed to publish alert");
+    LOGW("MQTT", "⚠ BROKER_CA_PEM empty - broker certificate not verified");
+    client.setInsecure();
   }
-}
\ No newline at end of file
+#endif
+  mqtt.subscribe(&configFeed);  // Sent with every (re)connect
+  xTaskCreatePinnedToCore(taskMqtt, "MqttTask", TASK_MQTT_STACK, NULL, TASK_MQTT_PRIO, NULL, TASK_MQTT_CORE);
+  LOGI("MQTT", "Publish queue ready for %s (%u messages/min)", MQTT_SERVER_NAME, (unsigned)RATE_PER_MIN);
+}
+
+/*
+ * Set the function receiving IO_CONFIG_FEED values
+ * Runs in MqttTask; must not block on the network
+ */
+void NetMQTT::setConfigHandler(bool (*handler)(const char *command)) {
+  configHandler = handler;
+}
+
+/*
+ * Buffer environmental sensor data for Adafruit IO
+ * 
+ * Returns immediately. The reading is timestamped and kept in Store
+ * until MqttTask delivers it, so nothing is lost while offline.
+ * 
+ * @param d: SensorData struct with temp, humidity, timestamp
+ */
+void NetMQTT::publishEnv(SensorData d) {
+  if (isnan(d.temp) && isnan(d.hum)) {
+    LOGW("MQTT", "⚠ Both readings are NaN, skipping");
+    return;
+  }
+  Store::push(Store::envRecord(d));
+  LOGI("MQTT", "Sensor reading buffered (%u pending)", (unsigned)Store::pending());
+}
+
+/*
+ * Queue alert event for Adafruit IO alerts feed
+ * 
+ * Returns immediately. Alerts normally take the live queue, which is
+ * sent ahead of buffered readings. If it is full (e.g., long outage)
+ * the alert is buffered in Store with its timestamp instead.
+ * Photo URLs are not included (Telegram-only for images).
+ * 
+ * @param reason: Alert type (e.g., "motion", "high_temperature")
+ * @return true if the alert was queued or buffered
+ */
+bool NetMQTT::publishAlert(const char *reason) {
+  char item[ALERT_REASON_LEN];
+  strlcpy(item, reason, sizeof(item));
+  if (xQueueSend(alertQueue, item, 0) == pdTRUE) {
+    LOGI("MQTT", "Alert queued: %s", item);
+    return true;
+  }
+  LOGW("MQTT", "⚠ Alert queue full - buffering: %s", item);
+  Store::push(Store::alertRecord(item));
+  return true;
+}
+
+/*
+ * Queue a metrics summary for the Adafruit IO metrics feed
+ * Replaces any summary not yet sent. Returns immediately.
+ * 
+ * @param summary: one-line text from Metrics::summary()
+ */
+void NetMQTT::publishMetrics(const char *summary) {
+  portENTER_CRITICAL(&metricsMux);
+  strlcpy(pendingMetrics, summary, sizeof(pendingMetrics));
+  metricsPending = true;
+  portEXIT_CRITICAL(&metricsMux);
+}
+
+/*
+ * @return true while the broker link is up (for health reporting)
+ */
+bool NetMQTT::connected() {
+  return mqttState == MQTT_CONNECTED;
+}
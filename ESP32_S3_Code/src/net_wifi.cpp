@@ -0,0 +1,241 @@
+/*
+ * Wi-Fi Module - Station Connectivity Manager
+ *
+ * Replaces the scan-and-poll loop in setup() (and the ESP.restart()
+ * after 30 s) with an event-driven station:
+ * - The channel and BSSID of the last AP are kept in NVS. A boot or a
+ *   reconnect goes straight to that AP on that channel, skipping the
+ *   all-channel scan (a few hundred ms instead of 2-3 s)
+ * - After WIFI_FAST_RETRIES misses on the cached AP (moved channel,
+ *   replaced hotspot) the next attempts do a full scan; whatever AP
+ *   answers becomes the new cache entry
+ * - Optional static IP (WIFI_STATIC_IP) skips the DHCP exchange
+ * - Disconnects are handled in the WiFi event task: reconnect at once,
+ *   then back off from WIFI_RETRY_MIN_MS to WIFI_RETRY_MAX_MS. Nothing
+ *   restarts; MQTT, Telegram and the camera checks wait for the link
+ *   the way they already do
+ *
+ * Every association is timed from the drop (or from init() at boot) to
+ * the IP: H_WIFI_CONNECT in Metrics, drops in M_WIFI_DROP.
+ */
+
+#include "net_wifi.h"
+#include "config.h"
+#include "logging.h"
+#include "metrics.h"
+#include <WiFi.h>
+#include <Preferences.h>
+#include "esp_wifi.h"
+#include "esp_timer.h"
+
+static const char *NVS_NAMESPACE = "wifi";
+static const char *NVS_KEY = "ap";
+
+// Last AP the station associated with
+struct ApCache {
+  uint8_t bssid[6];
+  uint8_t channel;   // 0 = nothing cached
+};
+static ApCache cache = {};
+
+static volatile bool linkUp = false;
+static bool everUp = false;
+static bool usingCache = false;          // Current attempts are pinned to the cached AP
+static unsigned long downSince = 0;      // millis() of the drop (or of init())
+static uint32_t attempts = 0;            // Failed attempts since downSince
+static uint32_t drops = 0;
+static unsigned long lastConnectMs = 0;  // Drop (or boot) -> IP of the last association
+static esp_timer_handle_t retryTimer = nullptr;
+
+/*
+ * Point the station config at the cached AP, or at any AP with the SSID
+ *
+ * Only called while disconnected: changing the STA config of a
+ * connected station makes the driver drop the link.
+ */
+static void setTarget(bool cached) {
+  wifi_config_t conf;
+  if (esp_wifi_get_config(WIFI_IF_STA, &conf) != ESP_OK) return;
+  usingCache = cached && cache.channel != 0;
+  conf.sta.bssid_set = usingCache;
+  conf.sta.channel = usingCache ? cache.channel : 0;
+  if (usingCache) memcpy(conf.sta.bssid, cache.bssid, sizeof(cache.bssid));
+  esp_wifi_set_config(WIFI_IF_STA, &conf);
+}
+
+/*
+ * Keep the AP we just associated with for the next fast connect
+ * NVS is only written when the AP or its channel changed.
+ */
+static void saveCache() {
+  const uint8_t *bssid = WiFi.BSSID();
+  int32_t channel = WiFi.channel();
+  if (!bssid || channel <= 0) return;
+  if (cache.channel == channel && memcmp(cache.bssid, bssid, sizeof(cache.bssid)) == 0) return;
+
+  memcpy(cache.bssid, bssid, sizeof(cache.bssid));
+  cache.channel = (uint8_t)channel;
+  Preferences prefs;
+  if (!prefs.begin(NVS_NAMESPACE, false) || prefs.putBytes(NVS_KEY, &cache, sizeof(cache)) != sizeof(cache)) {
+    LOGW("WIFI", "⚠ AP cache not saved - next boot scans all channels");
+  }
+  prefs.end();
+  LOGI("WIFI", "AP cached: %s on channel %d", WiFi.BSSIDstr().c_str(), (int)channel);
+}
+
+static void retryNow(void *) {
+  esp_wifi_connect();
+}
+
+static void onConnected() {
+  lastConnectMs = millis() - downSince;
+  Metrics::observe(H_WIFI_CONNECT, lastConnectMs > UINT32_MAX / 1000 ? UINT32_MAX : (uint32_t)(lastConnectMs * 1000));
+  if (everUp) {
+    LOGI("WIFI", "✓ Reconnected in %lu ms (%s, %u attempt(s))", lastConnectMs,
+         usingCache ? "cached AP" : "full scan", (unsigned)attempts + 1);
+  }
+  everUp = true;
+  attempts = 0;
+  linkUp = true;
+  saveCache();
+}
+
+/*
+ * Association failed or the link dropped: schedule the next attempt
+ *
+ * The driver reports each failed attempt as another disconnect, so this
+ * is also the retry loop. The first attempt after a drop is immediate.
+ *
+ * @param reason: wifi_err_reason_t from the driver
+ */
+static void onDisconnected(uint8_t reason) {
+  if (linkUp) {
+    linkUp = false;
+    downSince = millis();
+    attempts = 0;
+    drops++;
+    Metrics::count(M_WIFI_DROP);
+    LOGW("WIFI", "⚠ Link lost (reason %u) - reconnecting", (unsigned)reason);
+    setTarget(true);
+    esp_wifi_connect();
+    return;
+  }
+
+  attempts++;
+  if (usingCache && attempts >= WIFI_FAST_RETRIES) {
+    LOGI("WIFI", "Cached AP not answering (reason %u) - scanning all channels", (unsigned)reason);
+    setTarget(false);
+  }
+  uint32_t shift = attempts > 5 ? 5 : attempts - 1;
+  uint32_t waitMs = WIFI_RETRY_MIN_MS << shift;
+  if (waitMs > WIFI_RETRY_MAX_MS) waitMs = WIFI_RETRY_MAX_MS;
+  if (attempts % 5 == 0) LOGD("WIFI", "Attempt %u failed (reason %u), next in %lu ms", (unsigned)attempts, (unsigned)reason, (unsigned long)waitMs);
+  if (retryTimer) {
+    esp_timer_stop(retryTimer);
+    esp_timer_start_once(retryTimer, (uint64_t)waitMs * 1000);
+  } else {
+    esp_wifi_connect();
+  }
+}
+
+static void onWiFiEvent(arduino_event_id_t event, arduino_event_info_t info) {
+  switch (event) {
+    case ARDUINO_EVENT_WIFI_STA_GOT_IP:
+      onConnected();
+      break;
+    case ARDUINO_EVENT_WIFI_STA_DISCONNECTED:
+      onDisconnected(info.wifi_sta_disconnected.reason);
+      break;
+    default:
+      break;
+  }
+}
+
+/*
+ * Start the station
+ *
+ * Loads the cached AP, applies the static IP if one is configured and
+ * starts associating. Returns immediately; the WiFi event task does the
+ * rest for the whole uptime.
+ */
+void NetWiFi::init() {
+  LOG_BANNER("=== WIFI CONNECTION ===");
+  LOGI("WIFI", "Mode: Station (STA)");
+  LOGI("WIFI", "SSID: %s", WIFI_SSID);
+
+  Preferences prefs;
+  if (prefs.begin(NVS_NAMESPACE, true)) {
+    if (prefs.getBytesLength(NVS_KEY) != sizeof(cache) || prefs.getBytes(NVS_KEY, &cache, sizeof(cache)) != sizeof(cache)) {
+      cache = {};
+    }
+    prefs.end();
+  }
+
+  esp_timer_create_args_t timerArgs = {};
+  timerArgs.callback = retryNow;
+  timerArgs.name = "wifi_retry";
+  if (esp_timer_create(&timerArgs, &retryTimer) != ESP_OK) retryTimer = nullptr;
+
+  WiFi.persistent(false);        // Credentials come from config.h; no flash write per begin()
+  WiFi.setAutoReconnect(false);  // Reconnects are ours (onDisconnected)
+  WiFi.mode(WIFI_STA);
+  WiFi.onEvent(onWiFiEvent);
+
+  if (WIFI_STATIC_IP[0]) {
+    IPAddress ip, gateway, subnet, dns;
+    if (ip.fromString(WIFI_STATIC_IP) && gateway.fromString(WIFI_GATEWAY) && subnet.fromString(WIFI_SUBNET) && dns.fromString(WIFI_DNS)) {
+      WiFi.config(ip, gateway, subnet, dns);
+      LOGI("WIFI", "Static IP %s (no DHCP)", WIFI_STATIC_IP);
+    } else {
+      LOGW("WIFI", "⚠ Invalid static IP settings - using DHCP");
+    }
+  }
+
+  downSince = millis();
+  usingCache = cache.channel != 0;
+  if (usingCache) {
+    LOGI("WIFI", "Connecting to cached AP on channel %u...", (unsigned)cache.channel);
+    WiFi.begin(WIFI_SSID, WIFI_PASS, cache.channel, cache.bssid);
+  } else {
+    LOGI("WIFI", "Connecting (full scan)...");
+    WiFi.begin(WIFI_SSID, WIFI_PASS);
+  }
+}
+
+/*
+ * Block until the station has an IP
+ *
+ * @param timeoutMs: longest wait
+ * @return true if connected (network info is logged once, at boot)
+ */
+bool NetWiFi::waitConnected(uint32_t timeoutMs) {
+  unsigned long start = millis();
+  while (!linkUp) {
+    if (millis() - start >= timeoutMs) return false;
+    vTaskDelay(pdMS_TO_TICKS(20));
+  }
+  static bool reported = false;
+  if (!reported) {
+    reported = true;
+    LOG_BANNER("");
+    LOGI("WIFI", "✓ Connected in %lu ms (%s)", lastConnectMs, usingCache ? "cached AP" : "full scan");
+    LOGI("WIFI", "IP Address: %s", WiFi.localIP().toString().c_str());
+    LOGI("WIFI", "Signal Strength: %d dBm", (int)WiFi.RSSI());
+    LOG_BANNER("");
+  }
+  return true;
+}
+
+bool NetWiFi::connected() {
+  return linkUp;
+}
+
+void NetWiFi::logSummary() {
+  if (linkUp) {
+    LOGI("WIFI", "Link up, %d dBm, channel %d | %u drop(s), last connect %lu ms", (int)WiFi.RSSI(),
+         (int)WiFi.channel(), (unsigned)drops, lastConnectMs);
+  } else {
+    LOGW("WIFI", "⚠ Link down for %lus (%u attempt(s)) | %u drop(s)", (millis() - downSince) / 1000,
+         (unsigned)attempts, (unsigned)drops);
+  }
+}
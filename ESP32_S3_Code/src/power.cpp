@@ -0,0 +1,165 @@
+/*
+ * Power Module - Power-Managed Operation for Battery Units
+ * 
+ * With POWER_MANAGED set, the S3 spends the time between sensor cycles
+ * and alerts at a low clock or in light sleep:
+ * - Dynamic frequency scaling between POWER_MIN_MHZ and POWER_MAX_MHZ
+ * - Automatic light sleep whenever every task is blocked (tickless
+ *   idle; needs a core built with CONFIG_FREERTOS_USE_TICKLESS_IDLE,
+ *   otherwise only DFS and modem sleep are active)
+ * - WiFi modem sleep (WIFI_PS_MIN_MODEM): the radio wakes for each DTIM
+ *   beacon and the AP buffers traffic in between
+ * - The PIR pin is a light-sleep wake source (see Motion::init)
+ * 
+ * The alert path holds a CPU_FREQ_MAX lock (hold/release) from the PIR
+ * event until Telegram/MQTT delivery, so capture and upload run at full
+ * clock and the chip cannot sleep in the middle of an alert.
+ * 
+ * Waking costs latency (sleep exit, clock ramp, radio asleep until the
+ * next DTIM). Each motion event is classed by whether the PIR woke the
+ * chip from light sleep, its trigger-to-Telegram time is averaged per
+ * class, and logSummary() reports the difference as the wake penalty.
+ */
+
+#include "power.h"
+#include "config.h"
+#include "logging.h"
+#include "metrics.h"
+#include "esp_pm.h"
+#include "esp_sleep.h"
+#include "esp_wifi.h"
+
+static esp_pm_lock_handle_t alertLock = nullptr;
+static bool lightSleep = false;  // Automatic light sleep actually enabled
+
+// Per-class wake statistics: [0] chip was awake, [1] PIR woke it from light sleep
+struct WakeClass {
+  uint32_t events;
+  uint64_t wakeUsTotal;     // PIR ISR -> AlertTask running
+  uint32_t delivered;
+  uint64_t toTelegramMsTotal; // PIR edge -> Telegram accepted
+};
+static WakeClass classes[2];
+static unsigned long lastTriggerMs = 0;  // Event the class below belongs to
+static int lastClass = -1;
+static portMUX_TYPE powerMux = portMUX_INITIALIZER_UNLOCKED;
+
+/*
+ * Enable power management
+ * 
+ * Called from BootTask right after the WiFi stage is ready (modem
+ * sleep needs the station up). Without POWER_MANAGED this only logs the mode, and
+ * hold()/release() do nothing.
+ */
+void Power::init() {
+  if (!POWER_MANAGED) {
+    LOGI("POWER", "Always-on mode (POWER_MANAGED 0)");
+    return;
+  }
+  LOG_BANNER("\n=== POWER MANAGEMENT ===");
+  
+  if (esp_pm_lock_create(ESP_PM_CPU_FREQ_MAX, 0, "alert", &alertLock) != ESP_OK) alertLock = nullptr;
+  
+  esp_pm_config_esp32s3_t pm = {};
+  pm.max_freq_mhz = POWER_MAX_MHZ;
+  pm.min_freq_mhz = POWER_MIN_MHZ;
+#if CONFIG_FREERTOS_USE_TICKLESS_IDLE
+  pm.light_sleep_enable = true;
+#else
+  pm.light_sleep_enable = false;  // Core built without tickless idle
+#endif
+  esp_err_t err = esp_pm_configure(&pm);
+  if (err != ESP_OK) {
+    LOGE("POWER", "✗ esp_pm_configure failed: %s - staying at full clock", esp_err_to_name(err));
+    return;
+  }
+  lightSleep = pm.light_sleep_enable;
+  
+  esp_wifi_set_ps(WIFI_PS_MIN_MODEM);
+  LOGI("POWER", "✓ DFS %d-%d MHz, WiFi modem sleep on DTIM", POWER_MIN_MHZ, POWER_MAX_MHZ);
+  if (lightSleep) {
+    LOGI("POWER", "✓ Automatic light sleep, PIR on GPIO %d wakes the chip", PIRPIN);
+  } else {
+    LOGW("POWER", "⚠ No light sleep: core lacks CONFIG_FREERTOS_USE_TICKLESS_IDLE");
+  }
+  if (!alertLock) LOGW("POWER", "⚠ No PM lock - alerts may run at %d MHz", POWER_MIN_MHZ);
+}
+
+/*
+ * Keep the CPU at full clock (and awake) for the alert path
+ * Nests: every hold() needs a matching release()
+ */
+void Power::hold() {
+  if (alertLock) esp_pm_lock_acquire(alertLock);
+}
+
+void Power::release() {
+  if (alertLock) esp_pm_lock_release(alertLock);
+}
+
+/*
+ * AlertTask picked up a PIR event (lock already held)
+ * 
+ * The PIR woke the chip if the last light-sleep exit was a GPIO wake:
+ * AlertTask is ready right after the ISR, so the chip cannot have slept
+ * again in between.
+ * 
+ * @param triggerMs: millis() of the PIR edge (matches AlertEvent::triggerMs)
+ * @param triggerUs: esp_timer time of the PIR edge, taken in the ISR
+ */
+void Power::noteWake(unsigned long triggerMs, uint64_t triggerUs) {
+  uint64_t wakeUs = Metrics::now() - triggerUs;
+  Metrics::observe(H_MOTION_WAKE, wakeUs > UINT32_MAX ? UINT32_MAX : (uint32_t)wakeUs);
+  int cls = (lightSleep && esp_sleep_get_wakeup_cause() == ESP_SLEEP_WAKEUP_GPIO) ? 1 : 0;
+  
+  portENTER_CRITICAL(&powerMux);
+  classes[cls].events++;
+  classes[cls].wakeUsTotal += wakeUs;
+  lastTriggerMs = triggerMs;
+  lastClass = cls;
+  portEXIT_CRITICAL(&powerMux);
+  LOGD("POWER", "PIR event %s (ISR->task %uus)", cls ? "woke the chip" : "while awake", (unsigned)wakeUs);
+}
+
+/*
+ * Telegram accepted a motion alert: add its latency to the event's class
+ * 
+ * Alerts are at least ALERT_COOLDOWN_MS apart, so the last classified
+ * event is the one being delivered; anything else is ignored.
+ */
+void Power::noteDelivered(unsigned long triggerMs) {
+  unsigned long latencyMs = millis() - triggerMs;
+  portENTER_CRITICAL(&powerMux);
+  if (lastClass >= 0 && triggerMs == lastTriggerMs) {
+    classes[lastClass].delivered++;
+    classes[lastClass].toTelegramMsTotal += latencyMs;
+    lastClass = -1;  // Count each event once
+  }
+  portEXIT_CRITICAL(&powerMux);
+}
+
+/*
+ * Log wake counts and the measured trigger-to-Telegram wake penalty
+ * Called with the periodic metrics dump
+ */
+void Power::logSummary() {
+  if (!POWER_MANAGED) return;
+  WakeClass c[2];
+  portENTER_CRITICAL(&powerMux);
+  memcpy(c, classes, sizeof(c));
+  portEXIT_CRITICAL(&powerMux);
+  
+  unsigned wakeAwake = c[0].events ? (unsigned)(c[0].wakeUsTotal / c[0].events) : 0;
+  unsigned wakeSlept = c[1].events ? (unsigned)(c[1].wakeUsTotal / c[1].events) : 0;
+  LOGI("POWER", "PIR events: %u woke the chip, %u while awake | ISR->task avg %uus / %uus",
+       (unsigned)c[1].events, (unsigned)c[0].events, wakeSlept, wakeAwake);
+  if (c[0].delivered && c[1].delivered) {
+    long slept = (long)(c[1].toTelegramMsTotal / c[1].delivered);
+    long awake = (long)(c[0].toTelegramMsTotal / c[0].delivered);
+    LOGI("POWER", "Trigger->Telegram avg %ldms after light sleep vs %ldms awake (wake penalty %+ldms)",
+         slept, awake, slept - awake);
+  } else if (c[1].delivered) {
+    LOGI("POWER", "Trigger->Telegram avg %ldms after light sleep (no awake baseline yet)",
+         (long)(c[1].toTelegramMsTotal / c[1].delivered));
+  }
+}
@@ -2,10 +2,18 @@
  * Task Scheduler - FreeRTOS Task Management
  * 
  * This module creates and manages two concurrent tasks:
- * 1. SensorTask: Periodic environmental monitoring (every 30s)
+ * 1. SensorTask: Periodic environmental monitoring (every SENSOR_PERIOD_MS)
  * 2. AlertTask: Motion detection and alert handling
  * 
- * Both tasks are pinned to Core 1, leaving Core 0 for main loop
+ * Core, priority and stack of these and every other task come from
+ * the task topology in config.h: AlertTask outranks SensorTask on
+ * core 1, so a sensor cycle never delays a capture.
+ * Alert delivery runs in the Dispatcher's sender tasks, so AlertTask
+ * only captures and hands off.
+ * 
+ * Every long-running task is also under the task watchdog
+ * (watchCurrentTask/feedWatchdog): a task stuck for TASK_WDT_TIMEOUT_S
+ * resets the board.
  */
 
 #include "scheduler.h"
@@ -14,7 +22,15 @@
 #include "camera_client.h"
 #include "net_mqtt.h"
 #include "alerts.h"
+#include "dispatcher.h"
 #include "config.h"
+#include "logging.h"
+#include "metrics.h"
+#include "power.h"
+#include "motion_digest.h"
+#include "boot.h"
+#include "esp_task_wdt.h"
+#include "esp_idf_version.h"
 
 // Task handles for FreeRTOS task management
 TaskHandle_t sensorTask, alertTask;
@@ -23,37 +39,79 @@ TaskHandle_t sensorTask, alertTask;
 void taskSensor(void *pv);
 void taskAlert(void *pv);
 
+/*
+ * Set the task watchdog timeout
+ * 
+ * Called first thing in setup(), before any task is created. The core
+ * has already started the watchdog for the idle tasks; this only
+ * lengthens the timeout to TASK_WDT_TIMEOUT_S and makes it panic
+ * (reset) instead of just printing.
+ */
+void Scheduler::initWatchdog() {
+#if ESP_IDF_VERSION_MAJOR >= 5
+  esp_task_wdt_config_t cfg = { TASK_WDT_TIMEOUT_S * 1000, (1 << portNUM_PROCESSORS) - 1, true };
+  if (esp_task_wdt_init(&cfg) == ESP_ERR_INVALID_STATE) esp_task_wdt_reconfigure(&cfg);
+#else
+  esp_task_wdt_init(TASK_WDT_TIMEOUT_S, true);  // Reconfigures if already running
+#endif
+}
+
+/*
+ * Put the calling task under the task watchdog
+ * 
+ * Called once at the top of each long-running task. Also registers the
+ * task for stack high-water reporting (Metrics::watchCurrentTask). From
+ * here on the task must call feedWatchdog() at least every
+ * TASK_WDT_TIMEOUT_S, so its blocking waits use TASK_WDT_FEED_MS
+ * timeouts instead of portMAX_DELAY.
+ */
+void Scheduler::watchCurrentTask() {
+  Metrics::watchCurrentTask();
+  if (esp_task_wdt_add(NULL) != ESP_OK) {
+    LOGW("SCHEDULER", "⚠ %s not under the task watchdog", pcTaskGetName(NULL));
+  }
+}
+
+void Scheduler::feedWatchdog() {
+  esp_task_wdt_reset();
+}
+
 /*
  * Initialize and start all FreeRTOS tasks
- * Called once during setup() after WiFi and sensors are ready
+ * Called once during setup(), before WiFi: this is what arms motion
+ * detection, so it depends on nothing from the network stages
  */
 void Scheduler::initTasks() {
-  Serial.println("\n=== INITIALIZING TASKS ===");
+  LOG_BANNER("\n=== INITIALIZING TASKS ===");
   
   // Initialize motion sensor BEFORE creating tasks to avoid race conditions
-  // The interrupt must be configured before AlertTask starts polling
+  // The interrupt must be configured before AlertTask starts waiting
   Motion::init(PIRPIN);
-  Serial.println("[SCHEDULER] Motion detection enabled on GPIO 15");
+  LOGI("SCHEDULER", "Motion detection enabled on GPIO 15");
   delay(100); // Small delay after interrupt setup for stability
   
-  // Create SensorTask on Core 1
-  // Parameters: function, name, stack(8KB), params, priority(1), handle, core(1)
-  Serial.println("[SCHEDULER] Creating SensorTask on Core 1...");
-  xTaskCreatePinnedToCore(taskSensor, "SensorTask", 8192, NULL, 1, &sensorTask, 1);
-  Serial.println("[SCHEDULER] ✓ SensorTask created");
+  // Start alert channel senders before anything can enqueue alerts
+  Dispatcher::init();
+  
+  // Create SensorTask (low priority: telemetry)
+  // Parameters: function, name, stack, params, priority, handle, core
+  LOGI("SCHEDULER", "Creating SensorTask on Core %d (prio %d)...", TASK_SENSOR_CORE, TASK_SENSOR_PRIO);
+  xTaskCreatePinnedToCore(taskSensor, "SensorTask", TASK_SENSOR_STACK, NULL, TASK_SENSOR_PRIO, &sensorTask, TASK_SENSOR_CORE);
+  LOGI("SCHEDULER", "✓ SensorTask created");
   
-  // Create AlertTask on Core 1
-  Serial.println("[SCHEDULER] Creating AlertTask on Core 1...");
-  xTaskCreatePinnedToCore(taskAlert,  "AlertTask",  8192, NULL, 1, &alertTask,  1);
-  Serial.println("[SCHEDULER] ✓ AlertTask created");
+  // Create AlertTask (highest application priority)
+  LOGI("SCHEDULER", "Creating AlertTask on Core %d (prio %d)...", TASK_ALERT_CORE, TASK_ALERT_PRIO);
+  xTaskCreatePinnedToCore(taskAlert,  "AlertTask",  TASK_ALERT_STACK,  NULL, TASK_ALERT_PRIO,  &alertTask,  TASK_ALERT_CORE);
+  LOGI("SCHEDULER", "✓ AlertTask created");
+  LOGI("SCHEDULER", "Task watchdog: %ds", TASK_WDT_TIMEOUT_S);
   
-  Serial.println("[SCHEDULER] All tasks initialized and running");
-  Serial.println("=== SYSTEM READY ===");
-  Serial.println();
+  LOGI("SCHEDULER", "All tasks initialized and running");
+  LOG_BANNER("=== SYSTEM READY ===");
+  LOG_BANNER("");
 }
 
 /*
- * Sensor Task - Runs every 30 seconds
+ * Sensor Task - Runs every SENSOR_PERIOD_MS (10 s)
  * 
  * Responsibilities:
  * 1. Read temperature and humidity from DHT22
@@ -63,31 +121,40 @@ void Scheduler::initTasks() {
  * Uses vTaskDelayUntil for fixed-period scheduling (no drift)
  */
 void taskSensor(void *pv) {
-  Serial.println("[TASK] SensorTask started");
+  LOGI("TASK", "SensorTask started");
+  Scheduler::watchCurrentTask();
   
   // Initialize timing for fixed-period scheduling
   TickType_t xLastWakeTime = xTaskGetTickCount();  // Current tick count
-  const TickType_t xPeriod = pdMS_TO_TICKS(30000); // 30 second period
+  const TickType_t xPeriod = pdMS_TO_TICKS(SENSOR_PERIOD_MS); // One DHT transaction per cycle
   
   for (;;) {  // Infinite loop - task never exits
-    Serial.println("\n--- Sensor Task Cycle ---");
+    Scheduler::feedWatchdog();
+    LOG_BANNER("\n--- Sensor Task Cycle ---");
     
     // Step 1: Read temperature and humidity from DHT22
     // Returns struct with temp, humidity, and timestamp
     auto data = Sensors::readAll();
+    if (!isnan(data.temp) && !isnan(data.hum)) Boot::ready(BOOT_SENSORS);
     
     // Step 2: Publish sensor data to Adafruit IO
-    // Includes NaN validation and rate-limit spacing (1s between feeds)
-    NetMQTT::publishEnv(data);
+    // Only on a change beyond the deadband or when the heartbeat is due;
+    // buffered, MqttTask sends it under the Adafruit IO rate limit.
+    // A self-hosted broker has no quota: every cycle is one message.
+    if (MQTT_BACKEND == MQTT_BACKEND_BROKER || Sensors::publishDue(data)) {
+      NetMQTT::publishEnv(data);
+    } else {
+      LOGD("TASK", "Reading within deadband - not published");
+    }
     
     // Step 3: Check for extreme weather conditions
     // Triggers alerts if temp > 34°C or humidity > 90%
     Alerts::checkWeatherAlerts(data);
     
-    Serial.println("[TASK] Sensor task sleeping for 30 seconds...");
+    LOGD("TASK", "Sensor task sleeping for %lu seconds...", (unsigned long)(SENSOR_PERIOD_MS / 1000));
     
     // Sleep until next scheduled wake time
-    // vTaskDelayUntil maintains exact 30s intervals regardless of work duration
+    // vTaskDelayUntil maintains exact intervals regardless of work duration
     // xLastWakeTime is automatically advanced by xPeriod each cycle
     vTaskDelayUntil(&xLastWakeTime, xPeriod);
   }
@@ -97,47 +164,106 @@ void taskSensor(void *pv) {
  * Alert Task - Monitors motion detection
  * 
  * Responsibilities:
- * 1. Poll motion detection flag every second
+ * 1. Sleep until the PIR ISR sends a task notification
  * 2. When motion detected, capture photo from camera
- * 3. Send alert to Telegram (with photo) and MQTT
+ * 3. Queue alert for Telegram (with photo) and MQTT
  * 4. Enforce 60-second cooldown between alerts
+ * 5. With COOLDOWN_DIGEST, fold motion seen during the cooldown into a
+ *    digest (count, trigger times, a few pinned frames) and send it as
+ *    one summary when the window ends; the summary opens the next
+ *    window, so a sustained intrusion reports once per cooldown
  * 
- * Runs continuously with 1-second polling interval
+ * Event-driven: no polling interval between trigger and capture
  */
 void taskAlert(void *pv) {
-  Serial.println("[TASK] AlertTask started - monitoring for motion");
+  LOGI("TASK", "AlertTask started - monitoring for motion");
+  Scheduler::watchCurrentTask();
+  
+  // Register for ISR wake-ups before waiting on the first event
+  Motion::setListener(xTaskGetCurrentTaskHandle());
   
-  // Track last alert time for cooldown enforcement
+  // Track last alert time for cooldown enforcement; no cooldown before
+  // the first alert, so motion right after boot takes the live path
   unsigned long lastAlertTime = 0;
-  const unsigned long ALERT_COOLDOWN = 60000; // 60 seconds cooldown
+  bool alertSent = false;
+  const unsigned long ALERT_COOLDOWN = ALERT_COOLDOWN_MS; // 60 seconds (0 in benchmark builds)
+  static MotionDigest digest;  // Motion seen during the current cooldown
+  Digest::open(digest, 0);
   
+  MotionEvent ev;
   for (;;) {  // Infinite loop - task never exits
-    // Check if motion was detected (flag set by ISR)
-    if (Motion::motionDetected()) {
-      unsigned long now = millis();
+    // Block until the ISR signals motion, waking to feed the watchdog
+    // or when the cooldown ends with a digest to send
+    Scheduler::feedWatchdog();
+    unsigned long waitMs = TASK_WDT_FEED_MS;
+    if (alertSent && digest.events > 0) {
+      unsigned long inWindow = millis() - lastAlertTime;
+      waitMs = inWindow >= ALERT_COOLDOWN ? 0 : min(waitMs, ALERT_COOLDOWN - inWindow);
+    }
+    bool motion = Motion::waitForEvent(ev, pdMS_TO_TICKS(waitMs));
+    
+    if (alertSent && digest.events > 0 && millis() - lastAlertTime >= ALERT_COOLDOWN) {
+      Alerts::handleMotionSummary(digest);
+      lastAlertTime = millis();  // Next window collects what follows
+      Digest::open(digest, lastAlertTime);
+    }
+    if (!motion) continue;
+    
+    // Full clock, no light sleep, until the alert is queued; the
+    // dispatcher holds its own lock for delivery
+    Power::hold();
+    Power::noteWake(ev.triggerMs, ev.triggerUs);
+    unsigned long now = millis();
+    Metrics::count(M_MOTION_EVENTS);
+    if (ev.edges > 1) {
+      LOGI("ALERT", "Event coalesced %u PIR edges (%u suppressed)", (unsigned)ev.edges, (unsigned)(ev.edges - 1));
+    }
+    
+    // Only process alert if cooldown period has elapsed
+    if (!alertSent || now - lastAlertTime >= ALERT_COOLDOWN) {
+      // Step 1: Capture photos from every online camera (real or mock)
+      // Returns URLs or JSON with image location; each camera's frame
+      // ring is asked for the frame closest to the PIR edge
+      CaptureSet shots;
+      CameraClient::captureAll(ev.triggerMs, shots);
+      LOGD("ALERT", "Trigger-to-capture latency: %lums", millis() - ev.triggerMs);
+      if (CAM_VERIFY_MOTION && !shots.confirmed) {
+        // PIR fired but the picture did not change: a false trigger, or
+        // motion the camera cannot make out. Never dropped - it goes out
+        // as a text-only alert, so no photo is uploaded
+        LOGW("ALERT", "⚠ PIR trigger not confirmed by the camera - text-only alert");
+        Metrics::count(M_MOTION_UNCONFIRMED);
+      }
+      
+      // Step 2: Queue alerts for multiple channels (non-blocking)
+      // Telegram receives photo + caption
+      // MQTT receives text-only alert
+      Alerts::handleMotionAlert(shots, ev.triggerMs);
       
-      // Only process alert if cooldown period has elapsed
-      if (now - lastAlertTime >= ALERT_COOLDOWN) {
-        // Step 1: Capture photo from camera (real or mock)
-        // Returns URL or JSON with image location
-        String photoURL = CameraClient::capture();
-        
-        // Step 2: Send alerts via multiple channels
-        // Telegram receives photo + caption
-        // MQTT receives text-only alert
-        Alerts::handleMotionAlert(photoURL);
-        
-        // Update last alert time to start new cooldown period
-        lastAlertTime = now;
-        Serial.println("[ALERT] Cooldown active for 60 seconds");
+      // Update last alert time to start new cooldown period
+      lastAlertTime = now;
+      alertSent = true;
+      Digest::open(digest, now);
+      LOGI("ALERT", "Cooldown active for %lu seconds", ALERT_COOLDOWN / 1000);
+    } else if (COOLDOWN_DIGEST) {
+      // In cooldown: pin one frame and keep the event for the summary
+      char url[CAM_URL_LEN];
+      bool confirmed = true;
+      CameraClient::capture(ev.triggerMs, url, sizeof(url), nullptr, 0, &confirmed);
+      Metrics::count(M_MOTION_COOLDOWN);
+      if (CAM_VERIFY_MOTION && !confirmed) {
+        LOGI("ALERT", "Motion in cooldown not confirmed by the camera - not counted");
+        Metrics::count(M_MOTION_UNCONFIRMED);
       } else {
-        // Motion detected but still in cooldown - ignore
-        Serial.println("[ALERT] Motion detected but in cooldown period - ignoring");
+        Digest::add(digest, ev.triggerMs, ev.edges, url);
+        LOGI("ALERT", "Motion in cooldown - %u event(s) held for the summary in %lus", (unsigned)digest.events,
+             (ALERT_COOLDOWN - (now - lastAlertTime)) / 1000);
       }
+    } else {
+      // Motion detected but still in cooldown - ignore
+      LOGI("ALERT", "Motion detected but in cooldown period - ignoring");
+      Metrics::count(M_MOTION_COOLDOWN);
     }
-    
-    // Sleep for 1 second before next check
-    // Polling-based approach (could be optimized with task notifications)
-    vTaskDelay(pdMS_TO_TICKS(1000));
+    Power::release();
   }
 }
@@ -0,0 +1,110 @@
+/*
+ * Sensor Filter Module - Reading Filter and Publish Deadband
+ * 
+ * Pure logic behind the sensor sampling engine (sensors.cpp), kept
+ * free of I/O so it can be unit tested on the host ([env:native]).
+ * 
+ * SensorFilter: a median over the last valid samples rejects single
+ * bad readings (a DHT22 bit error that still passes the checksum, a
+ * one-off spike); an EMA on top of it smooths sensor noise. Failed
+ * reads are skipped, and only a run of them makes the output NaN.
+ * 
+ * PublishGate: a value is worth a data point only if it moved beyond
+ * the deadband, or the heartbeat interval passed. This keeps the
+ * Adafruit IO quota for changes instead of identical readings.
+ */
+
+#include "sensor_filter.h"
+
+/*
+ * Reset a filter
+ * 
+ * @param window: Median window length (clamped to 1..FILTER_MAX_WINDOW)
+ * @param alpha: EMA weight of each new median, 0 < alpha <= 1
+ * @param maxMisses: Failed samples in a row before the output goes NaN
+ */
+void Filter::init(SensorFilter &f, uint8_t window, float alpha, uint8_t maxMisses) {
+  memset(&f, 0, sizeof(f));
+  f.size = window < 1 ? 1 : (window > FILTER_MAX_WINDOW ? FILTER_MAX_WINDOW : window);
+  f.alpha = alpha;
+  f.maxMisses = maxMisses;
+  f.value = NAN;
+}
+
+/*
+ * Median of the valid samples held (mean of the middle two if even)
+ */
+static float median(const SensorFilter &f) {
+  float v[FILTER_MAX_WINDOW];
+  memcpy(v, f.window, f.count * sizeof(float));
+  for (uint8_t i = 1; i < f.count; i++) {  // Insertion sort: at most 9 values
+    float x = v[i];
+    int j = i - 1;
+    while (j >= 0 && v[j] > x) {
+      v[j + 1] = v[j];
+      j--;
+    }
+    v[j + 1] = x;
+  }
+  uint8_t mid = f.count / 2;
+  return (f.count & 1) ? v[mid] : (v[mid - 1] + v[mid]) / 2.0f;
+}
+
+/*
+ * Add one sample
+ * 
+ * A NaN sample only counts as a miss. After maxMisses in a row the
+ * window is emptied and the output goes NaN, so a sensor that comes
+ * back starts fresh instead of blending with stale values.
+ * 
+ * @return filtered value (NaN until the first valid sample)
+ */
+float Filter::push(SensorFilter &f, float raw) {
+  if (isnan(raw)) {
+    if (++f.misses >= f.maxMisses) {
+      f.count = 0;
+      f.next = 0;
+      f.value = NAN;
+    }
+    return f.value;
+  }
+  f.misses = 0;
+  f.window[f.next] = raw;
+  f.next = (uint8_t)((f.next + 1) % f.size);
+  if (f.count < f.size) f.count++;
+  
+  float m = median(f);
+  f.value = isnan(f.value) ? m : f.value + f.alpha * (m - f.value);
+  return f.value;
+}
+
+void Filter::initGate(PublishGate &g, float deadband, uint32_t maxIntervalMs) {
+  g.deadband = deadband;
+  g.maxIntervalMs = maxIntervalMs;
+  g.last = NAN;
+  g.lastMs = 0;
+  g.published = false;
+}
+
+/*
+ * Whether a value should be published now
+ * 
+ * @return true for the first valid value, a change of at least the
+ *         deadband, or when maxIntervalMs passed; never for NaN
+ */
+bool Filter::due(const PublishGate &g, float value, uint32_t nowMs) {
+  if (isnan(value)) return false;
+  if (!g.published) return true;
+  if (fabsf(value - g.last) >= g.deadband) return true;
+  return nowMs - g.lastMs >= g.maxIntervalMs;
+}
+
+/*
+ * Record a published value (NaN leaves the gate unchanged)
+ */
+void Filter::mark(PublishGate &g, float value, uint32_t nowMs) {
+  if (isnan(value)) return;
+  g.last = value;
+  g.lastMs = nowMs;
+  g.published = true;
+}
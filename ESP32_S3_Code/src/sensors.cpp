@@ -1,104 +1,210 @@
 /*
  * Sensors Module - DHT22 Temperature and Humidity Sensor Interface
  * 
- * Handles initialization and reading of the DHT22 digital sensor.
- * Provides data validation, timestamp generation, and error handling.
+ * Sampling engine for the DHT22 digital sensor:
+ * - One transaction per SensorTask cycle, timed by the RMT peripheral
+ *   so interrupts stay enabled (the DHT library bit-bangs with them
+ *   off); decoding lives in DhtFrame
+ * - Median + EMA filter per value (SensorFilter); a failed read keeps
+ *   the last value for a few cycles instead of producing NaN
+ * - Change-based publishing (publishDue): a reading goes to Adafruit IO
+ *   only when it moved beyond the deadband or the heartbeat expired
+ * 
+ * Nothing blocks at boot: the power-on settle time is waited out by
+ * the first read, in SensorTask.
  */
 
 #include "sensors.h"
 #include <DHT.h>
 #include "config.h"
+#include "dht_frame.h"
+#include "sensor_filter.h"
 #include "utils.h"
+#include "logging.h"
+#include "metrics.h"
+#include "power.h"
+#include "driver/rmt.h"
+#include "driver/gpio.h"
 
-// Create DHT sensor object with pin and type from config.h
+// DHT library: used only when RMT capture is off or unavailable
 static DHT dht(DHTPIN, DHTTYPE);
+static bool useRmt = false;
+static RingbufHandle_t rmtRing = nullptr;
+
+static SensorFilter tempFilter, humFilter;
+static PublishGate tempGate, humGate;
+static unsigned long initMs = 0;
+
+static const rmt_channel_t RMT_CH = (rmt_channel_t)DHT_RMT_CHANNEL;
+static const uint16_t FRAME_IDLE_US = 200;      // No edge for this long ends the reply
+static const uint32_t START_LOW_US = 1100;      // Host start signal (>= 1 ms)
+static const TickType_t FRAME_TIMEOUT = pdMS_TO_TICKS(20); // Full reply takes ~5 ms
+static const size_t MAX_PULSES = 96;            // One RMT memory block of items
+
+/*
+ * Set up RMT receive on the DHT pin
+ * 
+ * The pin is open drain with its input still enabled: the host drives
+ * the start signal on it and RMT times the sensor's reply on the same
+ * line, 1 us per tick.
+ * 
+ * @return true if capture is ready
+ */
+static bool initRmt() {
+  rmt_config_t rx = RMT_DEFAULT_CONFIG_RX((gpio_num_t)DHTPIN, RMT_CH);
+  rx.clk_div = 80;  // 80 MHz APB -> 1 us ticks
+  rx.rx_config.filter_en = true;
+  rx.rx_config.filter_ticks_thresh = 80;  // Ignore glitches under 1 us (APB cycles)
+  rx.rx_config.idle_threshold = FRAME_IDLE_US;
+  if (rmt_config(&rx) != ESP_OK || rmt_driver_install(RMT_CH, 1024, 0) != ESP_OK) return false;
+  if (rmt_get_ringbuf_handle(RMT_CH, &rmtRing) != ESP_OK || !rmtRing) return false;
+  
+  gpio_set_direction((gpio_num_t)DHTPIN, GPIO_MODE_INPUT_OUTPUT_OD);
+  gpio_set_pull_mode((gpio_num_t)DHTPIN, GPIO_PULLUP_ONLY);
+  gpio_set_level((gpio_num_t)DHTPIN, 1);  // Released: line idles high
+  return true;
+}
+
+/*
+ * One DHT22 transaction over RMT
+ * 
+ * Interrupts stay on throughout; the task only busy-waits for the
+ * 1.1 ms start signal and then blocks until RMT hands over the reply.
+ */
+static DhtStatus readRmt(float &temp, float &hum) {
+  size_t len = 0;
+  void *stale;
+  while ((stale = xRingbufferReceive(rmtRing, &len, 0)) != nullptr) vRingbufferReturnItem(rmtRing, stale);
+  
+  gpio_set_level((gpio_num_t)DHTPIN, 0);
+  delayMicroseconds(START_LOW_US);
+  rmt_rx_start(RMT_CH, true);
+  gpio_set_level((gpio_num_t)DHTPIN, 1);  // Release: the sensor answers
+  
+  rmt_item32_t *items = (rmt_item32_t *)xRingbufferReceive(rmtRing, &len, FRAME_TIMEOUT);
+  rmt_rx_stop(RMT_CH);
+  if (!items) return DHT_NO_RESPONSE;
+  
+  uint16_t highUs[MAX_PULSES];
+  size_t n = 0;
+  for (size_t i = 0; i < len / sizeof(rmt_item32_t) && n + 2 <= MAX_PULSES; i++) {
+    if (items[i].level0 && items[i].duration0) highUs[n++] = items[i].duration0;
+    if (items[i].level1 && items[i].duration1) highUs[n++] = items[i].duration1;
+  }
+  vRingbufferReturnItem(rmtRing, items);
+  return DhtFrame::decode(highUs, n, temp, hum);
+}
+
+/*
+ * One DHT22 transaction through the DHT library (fallback)
+ * read() fetches both values at once; the getters then return them
+ * from the library's cache instead of starting a second transaction.
+ */
+static DhtStatus readLibrary(float &temp, float &hum) {
+  if (!dht.read(true)) return DHT_NO_RESPONSE;
+  temp = dht.readTemperature();
+  hum = dht.readHumidity();
+  return (isnan(temp) || isnan(hum)) ? DHT_NO_RESPONSE : DHT_OK;
+}
 
 /*
  * Initialize DHT22 sensor
  * 
- * The DHT22 requires a stabilization period after power-on.
- * This function waits 5 seconds before the sensor is ready for readings.
+ * Returns immediately. The DHT22 needs DHT_WARMUP_MS after power-on
+ * before its first reading; readAll() waits out whatever is left of
+ * that, so boot is not held up.
  */
 void Sensors::init() {
-  Serial.println("\n=== DHT SENSOR INIT ===");
-  Serial.println("[DHT] Type: DHT22");
-  Serial.println("[DHT] Pin: " + String(DHTPIN));
+  LOG_BANNER("\n=== DHT SENSOR INIT ===");
+  LOGI("DHT", "Type: DHT22");
+  LOGI("DHT", "Pin: %d", DHTPIN);
   
-  // Initialize the DHT library and configure the pin
-  dht.begin();
-  Serial.println("[DHT] Sensor initialized");
+  Filter::init(tempFilter, SENSOR_MEDIAN_WINDOW, SENSOR_EMA_ALPHA, SENSOR_MAX_MISSES);
+  Filter::init(humFilter, SENSOR_MEDIAN_WINDOW, SENSOR_EMA_ALPHA, SENSOR_MAX_MISSES);
+  Filter::initGate(tempGate, TEMP_DEADBAND, SENSOR_PUBLISH_MAX_MS);
+  Filter::initGate(humGate, HUM_DEADBAND, SENSOR_PUBLISH_MAX_MS);
+  initMs = millis();
   
-  Serial.println("[DHT] Waiting for sensor to stabilize...");
-  // DHT22 needs 5 seconds to stabilize after power-on
-  // Without this delay, first readings may be NaN or inaccurate
-  delay(5000);
-  Serial.println("[DHT] Sensor ready");
+  useRmt = DHT_USE_RMT && initRmt();
+  if (useRmt) {
+    LOGI("DHT", "✓ RMT capture on channel %d (interrupts stay on)", DHT_RMT_CHANNEL);
+  } else {
+    if (DHT_USE_RMT) LOGW("DHT", "⚠ RMT unavailable - using the DHT library");
+    dht.begin();
+  }
+  LOGI("DHT", "Median of %d, EMA %.2f | publish on %.1f°C / %.1f%% change or every %lus",
+       SENSOR_MEDIAN_WINDOW, SENSOR_EMA_ALPHA, TEMP_DEADBAND, HUM_DEADBAND, (unsigned long)(SENSOR_PUBLISH_MAX_MS / 1000));
 }
 
 /*
- * Read all sensor values (temperature, humidity, timestamp)
+ * Take one sample and return the filtered values with a timestamp
  * 
  * Returns a SensorData struct containing:
- * - temp: Temperature in Celsius (float, may be NaN on error)
- * - hum: Humidity in percent (float, may be NaN on error)
- * - ts: ISO 8601 timestamp string
+ * - temp: Filtered temperature in Celsius (NaN after SENSOR_MAX_MISSES failed reads)
+ * - hum: Filtered humidity in percent (same)
+ * - ts: Unix time of the reading (0 until NTP has synced)
  * 
- * Validates readings and logs warnings if thresholds are exceeded.
+ * Limits are checked by the weather rules (Alerts), not here.
  */
 SensorData Sensors::readAll() {
-  unsigned long startTime = millis();  // Track execution time
-  Serial.println("\n=== READING SENSORS ===");
-  SensorData s;  // Create struct to hold sensor data
+  unsigned long sinceInit = millis() - initMs;
+  if (sinceInit < DHT_WARMUP_MS) vTaskDelay(pdMS_TO_TICKS(DHT_WARMUP_MS - sinceInit));
   
-  // === Read Temperature ===
-  Serial.println("[DHT] Reading temperature...");
-  s.temp = dht.readTemperature();  // Returns Celsius, or NaN on failure
+  uint64_t startUs = Metrics::now();  // Track execution time
+  LOG_BANNER("\n=== READING SENSORS ===");
   
-  // Validate temperature reading
-  if (isnan(s.temp)) {
-    // Sensor communication failed or sensor not ready
-    Serial.println("[DHT] ✗ Temperature read failed (NaN)");
-  } else {
-    // Valid reading - display and check against threshold
-    Serial.print("[DHT] ✓ Temperature: ");
-    Serial.print(s.temp);
-    Serial.println("°C");
-    
-    // Warn if temperature exceeds configured limit
-    if (s.temp > TEMP_LIMIT) {
-      Serial.println("[DHT] ⚠️  WARNING: Temperature above limit (" + String(TEMP_LIMIT) + "°C)");
-    }
+  // === One Transaction ===
+  // Power lock: RMT stops in light sleep, and the wait for the reply
+  // would otherwise let the chip doze off mid-frame
+  float rawTemp = NAN, rawHum = NAN;
+  Power::hold();
+  DhtStatus st = useRmt ? readRmt(rawTemp, rawHum) : readLibrary(rawTemp, rawHum);
+  Power::release();
+  if (st != DHT_OK) {
+    LOGE("DHT", "✗ Read failed (%s)", DhtFrame::statusName(st));
+    Metrics::count(M_DHT_FAIL);
+    rawTemp = rawHum = NAN;
   }
   
-  // === Read Humidity ===
-  Serial.println("[DHT] Reading humidity...");
-  s.hum = dht.readHumidity();  // Returns percentage, or NaN on failure
+  // === Filter ===
+  SensorData s;
+  s.temp = Filter::push(tempFilter, rawTemp);
+  s.hum = Filter::push(humFilter, rawHum);
   
-  // Validate humidity reading
-  if (isnan(s.hum)) {
-    // Sensor communication failed or sensor not ready
-    Serial.println("[DHT] ✗ Humidity read failed (NaN)");
+  if (isnan(s.temp) || isnan(s.hum)) {
+    LOGE("DHT", "✗ No valid reading for %u cycles", (unsigned)tempFilter.misses);
   } else {
-    // Valid reading - display and check against threshold
-    Serial.print("[DHT] ✓ Humidity: ");
-    Serial.print(s.hum);
-    Serial.println("%");
-    
-    // Warn if humidity exceeds configured limit
-    if (s.hum > HUM_LIMIT) {
-      Serial.println("[DHT] ⚠️  WARNING: Humidity above limit (" + String(HUM_LIMIT) + "%)");
-    }
+    LOGI("DHT", "✓ Temperature: %.2f°C | Humidity: %.2f%% (raw %.1f°C %.1f%%)", s.temp, s.hum, rawTemp, rawHum);
   }
   
   // === Add Timestamp ===
-  // Generate ISO 8601 format timestamp for data logging
-  s.ts = Utils::timestamp();
-  Serial.println("[DHT] Timestamp: " + s.ts);
+  // Unix time; formatted only for the log line
+  s.ts = Utils::epoch();
+  char when[24];
+  Utils::timestamp(s.ts, when, sizeof(when));
+  LOGI("DHT", "Timestamp: %s", s.ts ? when : "(clock not synced)");
   
-  // === Performance Logging ===
-  // Measure and log how long the sensor read took
-  unsigned long elapsed = millis() - startTime;
-  Serial.println("[PERF] Sensor reading took: " + String(elapsed) + "ms");
+  // === Performance Tracking ===
+  // Record how long the sensor read took
+  Metrics::observeSince(H_SENSOR_READ, startUs);
   
-  return s;  // Return populated struct (may contain NaN values)
-}
\ No newline at end of file
+  return s;  // Filtered values (may be NaN)
+}
+
+/*
+ * Decide whether a reading is worth an Adafruit IO data point
+ * 
+ * Due when either value moved at least its deadband (TEMP_DEADBAND,
+ * HUM_DEADBAND) since the last published reading, or
+ * SENSOR_PUBLISH_MAX_MS passed. A due reading is marked as published:
+ * NetMQTT buffers it, so it is not lost if the broker is down.
+ * 
+ * @return true if the caller should publish d
+ */
+bool Sensors::publishDue(const SensorData &d) {
+  uint32_t now = millis();
+  if (!Filter::due(tempGate, d.temp, now) && !Filter::due(humGate, d.hum, now)) return false;
+  Filter::mark(tempGate, d.temp, now);
+  Filter::mark(humGate, d.hum, now);
+  return true;
+}
@@ -0,0 +1,335 @@
+/*
+ * Store-and-Forward Buffer - Offline Telemetry Spool
+ * 
+ * Keeps sensor readings and overflow alerts while Wi-Fi or Adafruit IO
+ * is down, so an outage delays data instead of dropping it.
+ * 
+ * Layout:
+ * - RAM ring of STORE_RAM_RECORDS fixed-size records (newest data)
+ * - Optional LittleFS spool file (older data, survives reboot)
+ * 
+ * When the RAM ring fills, its oldest STORE_SPILL_BATCH records are
+ * delta-encoded into one block (StoreCodec) and appended to the spool
+ * in one write. The spool is always older than the RAM ring, so
+ * peek()/pop() drain it first, one decoded block at a time, and order
+ * is kept. Without flash (or once the spool is full) the oldest record
+ * is dropped.
+ */
+
+#include "store.h"
+#include "config.h"
+#include "utils.h"
+#include "logging.h"
+#include <LittleFS.h>
+
+static const char *SPOOL_FILE = "/spool.bin";
+static const char *SPOOL_INDEX = "/spool.idx";   // SpoolIndex
+static const uint32_t INDEX_SAVE_EVERY = 16;     // Records popped between index saves
+
+static_assert(STORE_SPILL_BATCH > 0 && STORE_SPILL_BATCH <= 255, "a spool block holds 1-255 records");
+
+// Drain position kept on flash: block being read, records done in it
+struct __attribute__((packed)) SpoolIndex {
+  uint32_t offset;
+  uint8_t done;
+};
+
+static StoreRecord ring[STORE_RAM_RECORDS];
+static uint32_t ringHead = 0;       // Oldest record
+static uint32_t ringCount = 0;
+static SemaphoreHandle_t storeMutex = nullptr;
+
+static bool flashReady = false;
+static uint32_t spoolRecords = 0;   // Records written to the spool file
+static uint32_t spoolRead = 0;      // Records already drained from it
+static uint32_t readOffset = 0;     // Byte offset of the block being drained
+static uint8_t readDone = 0;        // Its records already drained
+static uint32_t popsSinceSave = 0;
+static uint32_t droppedCount = 0;
+
+// Block being drained, decoded; spill and drain share the byte buffer
+// (both under storeMutex)
+static StoreRecord block[STORE_SPILL_BATCH];
+static uint8_t blockCount = 0;      // 0 = nothing decoded
+static uint16_t blockLen = 0;
+static uint8_t blockBuf[STORE_BLOCK_BYTES(STORE_SPILL_BATCH)];
+static StoreRecord spillBatch[STORE_SPILL_BATCH];
+
+// Reason table for STORE_ALERT records (code 0 = unknown)
+static const char *REASONS[] = { "alert", "motion", "high_temperature", "high_humidity", "temperature_rising", "humidity_rising", "motion_summary" };
+static const uint8_t REASON_COUNT = sizeof(REASONS) / sizeof(REASONS[0]);
+
+static void saveIndex() {
+  File f = LittleFS.open(SPOOL_INDEX, FILE_WRITE);
+  if (!f) return;
+  SpoolIndex idx = { readOffset, readDone };
+  f.write((const uint8_t *)&idx, sizeof(idx));
+  f.close();
+  popsSinceSave = 0;
+}
+
+static void clearSpool() {
+  LittleFS.remove(SPOOL_FILE);
+  LittleFS.remove(SPOOL_INDEX);
+  spoolRecords = 0;
+  spoolRead = 0;
+  readOffset = 0;
+  readDone = 0;
+  blockCount = 0;
+  popsSinceSave = 0;
+}
+
+/*
+ * Decode the spool block at readOffset, unless it already is
+ * 
+ * @return false if the block is unreadable
+ */
+static bool loadBlock() {
+  if (blockCount > 0) return readDone < blockCount;
+  File f = LittleFS.open(SPOOL_FILE, FILE_READ);
+  if (!f) return false;
+  uint8_t count = 0;
+  size_t len = 0;
+  if (f.seek(readOffset) && f.read(blockBuf, STORE_BLOCK_HEADER) == STORE_BLOCK_HEADER) {
+    len = StoreCodec::blockLength(blockBuf, &count);
+  }
+  bool ok = len > 0 && len <= sizeof(blockBuf) &&
+            f.read(blockBuf + STORE_BLOCK_HEADER, len - STORE_BLOCK_HEADER) == len - STORE_BLOCK_HEADER;
+  f.close();
+  blockCount = ok ? StoreCodec::decodeBlock(blockBuf, len, block, STORE_SPILL_BATCH) : 0;
+  blockLen = (uint16_t)len;
+  return blockCount > 0 && readDone < blockCount;
+}
+
+/*
+ * Count the records in a spool left by a previous boot
+ * 
+ * Walks the block headers and resumes from the saved index; a missing
+ * or stale index replays the spool from the start. A spool that does
+ * not parse (older format, torn write) is discarded.
+ */
+static void resumeSpool() {
+  SpoolIndex idx = { 0, 0 };
+  File i = LittleFS.open(SPOOL_INDEX, FILE_READ);
+  if (i && i.read((uint8_t *)&idx, sizeof(idx)) != sizeof(idx)) idx = { 0, 0 };
+  if (i) i.close();
+  
+  File f = LittleFS.open(SPOOL_FILE, FILE_READ);
+  if (!f) return;
+  uint32_t size = f.size();
+  uint32_t offset = 0;
+  bool resumed = false;
+  while (offset < size) {
+    uint8_t header[STORE_BLOCK_HEADER];
+    uint8_t count = 0;
+    size_t len = 0;
+    if (f.seek(offset) && f.read(header, sizeof(header)) == sizeof(header)) {
+      len = StoreCodec::blockLength(header, &count);
+    }
+    if (len == 0 || offset + len > size) break;
+    if (offset == idx.offset && idx.done < count) {
+      readOffset = offset;
+      readDone = idx.done;
+      spoolRead = spoolRecords + idx.done;
+      resumed = true;
+    }
+    spoolRecords += count;
+    offset += len;
+  }
+  f.close();
+  
+  if (offset < size) {
+    LOGW("STORE", "⚠ Spool unreadable at byte %u of %u - discarding it", (unsigned)offset, (unsigned)size);
+    clearSpool();
+  } else if (!resumed) {
+    readOffset = 0;
+    readDone = 0;
+    spoolRead = 0;
+  }
+}
+
+/*
+ * Move the oldest RAM records to the spool file
+ * 
+ * @return true if room was made in the RAM ring
+ */
+static bool spillOldest() {
+  if (!flashReady) return false;
+  uint32_t n = min((uint32_t)STORE_SPILL_BATCH, ringCount);
+  if (spoolRecords + n > STORE_FLASH_MAX_RECORDS) return false;
+  
+  for (uint32_t i = 0; i < n; i++) spillBatch[i] = ring[(ringHead + i) % STORE_RAM_RECORDS];
+  size_t len = StoreCodec::encodeBlock(spillBatch, (uint8_t)n, blockBuf, sizeof(blockBuf));
+  blockCount = 0;  // blockBuf reused: decode again on the next peek()
+  if (len == 0) return false;
+  
+  File f = LittleFS.open(SPOOL_FILE, FILE_APPEND);
+  if (!f) return false;
+  bool written = f.write(blockBuf, len) == len;
+  f.close();
+  if (!written) return false;
+  
+  ringHead = (ringHead + n) % STORE_RAM_RECORDS;
+  ringCount -= n;
+  spoolRecords += n;
+  LOGI("STORE", "Spilled %u records to flash in %u bytes (%u on flash)", (unsigned)n, (unsigned)len,
+       (unsigned)(spoolRecords - spoolRead));
+  return true;
+}
+
+/*
+ * Initialize buffer and mount the spool filesystem
+ * Records left on flash by a previous boot are resumed from the saved
+ * index (up to INDEX_SAVE_EVERY of them may be sent twice).
+ */
+void Store::init() {
+  storeMutex = xSemaphoreCreateMutex();
+  
+#if STORE_FLASH_SPILL
+  flashReady = LittleFS.begin(true);  // Format on first use
+  if (!flashReady) {
+    LOGW("STORE", "⚠ LittleFS mount failed - RAM buffer only");
+  } else if (LittleFS.exists(SPOOL_FILE)) {
+    resumeSpool();
+  }
+#endif
+  
+  LOGI("STORE", "Buffer ready: %u records in RAM, %s (%u carried over)", (unsigned)STORE_RAM_RECORDS,
+       flashReady ? "flash spill on" : "no flash spill", (unsigned)(spoolRecords - spoolRead));
+}
+
+/*
+ * Append a record
+ * 
+ * @param r: record to store
+ * @return false if an older record had to be dropped to make room
+ */
+bool Store::push(const StoreRecord &r) {
+  bool kept = true;
+  xSemaphoreTake(storeMutex, portMAX_DELAY);
+  if (ringCount == STORE_RAM_RECORDS && !spillOldest()) {
+    // No room anywhere: drop the oldest RAM record
+    ringHead = (ringHead + 1) % STORE_RAM_RECORDS;
+    ringCount--;
+    droppedCount++;
+    kept = false;
+  }
+  ring[(ringHead + ringCount) % STORE_RAM_RECORDS] = r;
+  ringCount++;
+  xSemaphoreGive(storeMutex);
+  
+  if (!kept) LOGW("STORE", "⚠ Buffer full - dropped oldest record (%u total)", (unsigned)droppedCount);
+  return kept;
+}
+
+/*
+ * Read the oldest buffered record without removing it
+ * 
+ * @param r: receives the record
+ * @return false if the buffer is empty
+ */
+bool Store::peek(StoreRecord &r) {
+  bool ok = false;
+  xSemaphoreTake(storeMutex, portMAX_DELAY);
+  if (spoolRead < spoolRecords) {
+    ok = loadBlock();
+    if (ok) {
+      r = block[readDone];
+    } else {
+      LOGE("STORE", "✗ Spool unreadable - discarding it");
+      droppedCount += spoolRecords - spoolRead;
+      clearSpool();
+    }
+  }
+  if (!ok && ringCount > 0) {
+    r = ring[ringHead];
+    ok = true;
+  }
+  xSemaphoreGive(storeMutex);
+  return ok;
+}
+
+/*
+ * Remove the oldest record (after it was delivered)
+ */
+void Store::pop() {
+  xSemaphoreTake(storeMutex, portMAX_DELAY);
+  if (spoolRead < spoolRecords) {
+    // Decoded by the peek() before this; fails only if the spool went
+    // bad, and the next peek() discards it
+    if (loadBlock()) {
+      spoolRead++;
+      if (++readDone == blockCount) {
+        readOffset += blockLen;
+        readDone = 0;
+        blockCount = 0;
+      }
+      if (spoolRead == spoolRecords) {
+        clearSpool();  // Spool fully drained
+      } else if (++popsSinceSave >= INDEX_SAVE_EVERY) {
+        saveIndex();
+      }
+    }
+  } else if (ringCount > 0) {
+    ringHead = (ringHead + 1) % STORE_RAM_RECORDS;
+    ringCount--;
+  }
+  xSemaphoreGive(storeMutex);
+}
+
+/*
+ * @return records waiting in RAM and on flash
+ */
+uint32_t Store::pending() {
+  xSemaphoreTake(storeMutex, portMAX_DELAY);
+  uint32_t n = ringCount + (spoolRecords - spoolRead);
+  xSemaphoreGive(storeMutex);
+  return n;
+}
+
+/*
+ * @return records lost because the buffer was full
+ */
+uint32_t Store::dropped() {
+  return droppedCount;
+}
+
+/*
+ * Pack a sensor reading with its own timestamp
+ */
+StoreRecord Store::envRecord(const SensorData &d) {
+  StoreRecord r;
+  r.epoch = (uint32_t)d.ts;
+  r.kind = STORE_ENV;
+  r.reason = 0;
+  r.temp10 = isnan(d.temp) ? STORE_NAN_TEMP : (int16_t)lroundf(constrain(d.temp, -3000.0f, 3000.0f) * 10);
+  r.hum10 = isnan(d.hum) ? STORE_NAN_HUM : (uint16_t)lroundf(constrain(d.hum, 0.0f, 100.0f) * 10);
+  return r;
+}
+
+/*
+ * Pack an alert, stamped with the current time
+ */
+StoreRecord Store::alertRecord(const char *reason) {
+  StoreRecord r;
+  r.epoch = (uint32_t)Utils::epoch();
+  r.kind = STORE_ALERT;
+  r.reason = reasonCode(reason);
+  r.temp10 = STORE_NAN_TEMP;
+  r.hum10 = STORE_NAN_HUM;
+  return r;
+}
+
+/*
+ * Map an alert reason to its record code (0 if not in the table)
+ */
+uint8_t Store::reasonCode(const char *reason) {
+  for (uint8_t i = 1; i < REASON_COUNT; i++) {
+    if (strcmp(reason, REASONS[i]) == 0) return i;
+  }
+  return 0;
+}
+
+const char *Store::reasonName(uint8_t code) {
+  return code < REASON_COUNT ? REASONS[code] : REASONS[0];
+}
@@ -0,0 +1,224 @@
+/*
+ * Store Codec - Delta-Encoded Spool Blocks
+ * 
+ * Pure logic behind the flash spool of the store-and-forward buffer
+ * (store.cpp), kept free of I/O so it can be unit tested on the host
+ * ([env:native]).
+ * 
+ * Each spill of the RAM ring becomes one self-contained block, so the
+ * spool can be resumed or discarded block by block:
+ * 
+ *   0  u8   version (STORE_BLOCK_VERSION)
+ *   1  u8   record count
+ *   2  u16  block length in bytes, header included
+ *   4  records, each a tag byte and its fields:
+ *        tag bits 0-1  kind (StoreKind)
+ *        tag bits 2-3  time: 0 = u8 seconds since the previous record,
+ *                      1 = u16 seconds, 2 = u32 epoch
+ *        tag bits 4-5  STORE_ENV values: 0 = one byte of 4-bit deltas
+ *                      (temp low nibble, hum high), 1 = i8 temp, i8 hum
+ *                      deltas, 2 = i16 temp10, u16 hum10
+ *        then the time field, then the values (STORE_ENV) or the
+ *        reason byte (any other kind)
+ * 
+ * Deltas are against the previous valid STORE_ENV record in the block;
+ * the first record, a clock jump and a NaN reading are written in full.
+ * A 30 s reading takes 3-4 bytes instead of 10. STORE_ENV records come
+ * back with reason 0 and other kinds with NaN values, as
+ * Store::envRecord() / alertRecord() make them. All fields little-endian.
+ */
+
+#include "store_codec.h"
+
+#define TAG_KIND_MASK   0x03
+#define TAG_TIME_SHIFT  2
+#define TAG_VALUE_SHIFT 4
+enum : uint8_t { TIME_U8 = 0, TIME_U16 = 1, TIME_ABS = 2 };
+enum : uint8_t { VALUE_NIBBLE = 0, VALUE_I8 = 1, VALUE_ABS = 2 };
+
+static void put16(uint8_t *p, uint16_t v) {
+  p[0] = v & 0xFF;
+  p[1] = v >> 8;
+}
+
+static void put32(uint8_t *p, uint32_t v) {
+  for (int i = 0; i < 4; i++) p[i] = (v >> (8 * i)) & 0xFF;
+}
+
+static uint16_t get16(const uint8_t *p) {
+  return (uint16_t)(p[0] | (p[1] << 8));
+}
+
+static uint32_t get32(const uint8_t *p) {
+  return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+static bool validValues(int16_t temp10, uint16_t hum10) {
+  return temp10 != STORE_NAN_TEMP && hum10 != STORE_NAN_HUM;
+}
+
+static int nibble(uint8_t v) {
+  return v >= 8 ? (int)v - 16 : (int)v;
+}
+
+/*
+ * Encode records into one block
+ * 
+ * @param recs: records, oldest first
+ * @param n: number of records (1-255)
+ * @param out: receives the block
+ * @param cap: size of out, at least STORE_BLOCK_BYTES(n)
+ * @return block length, or 0 if n is 0 or cap is too small
+ */
+size_t StoreCodec::encodeBlock(const StoreRecord *recs, uint8_t n, uint8_t *out, size_t cap) {
+  if (n == 0 || cap < STORE_BLOCK_BYTES(n)) return 0;
+  
+  size_t len = STORE_BLOCK_HEADER;
+  bool haveTime = false, haveValues = false;
+  uint32_t lastEpoch = 0;
+  int16_t lastTemp = 0;
+  uint16_t lastHum = 0;
+  for (uint8_t i = 0; i < n; i++) {
+    const StoreRecord &r = recs[i];
+    uint8_t *tag = out + len++;
+    *tag = r.kind & TAG_KIND_MASK;
+    
+    uint32_t dt = r.epoch - lastEpoch;
+    uint8_t timeMode = !haveTime || r.epoch < lastEpoch ? TIME_ABS : dt <= 0xFF ? TIME_U8 : dt <= 0xFFFF ? TIME_U16 : TIME_ABS;
+    if (timeMode == TIME_U8) {
+      out[len++] = (uint8_t)dt;
+    } else if (timeMode == TIME_U16) {
+      put16(out + len, (uint16_t)dt);
+      len += 2;
+    } else {
+      put32(out + len, r.epoch);
+      len += 4;
+    }
+    *tag |= timeMode << TAG_TIME_SHIFT;
+    haveTime = true;
+    lastEpoch = r.epoch;
+    
+    if (r.kind != STORE_ENV) {
+      out[len++] = r.reason;
+      continue;
+    }
+    bool valid = validValues(r.temp10, r.hum10);
+    int32_t dTemp = (int32_t)r.temp10 - lastTemp;
+    int32_t dHum = (int32_t)r.hum10 - lastHum;
+    uint8_t valueMode = VALUE_ABS;
+    if (valid && haveValues && dTemp >= -8 && dTemp <= 7 && dHum >= -8 && dHum <= 7) {
+      out[len++] = (uint8_t)((dTemp & 0x0F) | ((dHum & 0x0F) << 4));
+      valueMode = VALUE_NIBBLE;
+    } else if (valid && haveValues && dTemp >= INT8_MIN && dTemp <= INT8_MAX && dHum >= INT8_MIN && dHum <= INT8_MAX) {
+      out[len++] = (uint8_t)(int8_t)dTemp;
+      out[len++] = (uint8_t)(int8_t)dHum;
+      valueMode = VALUE_I8;
+    } else {
+      put16(out + len, (uint16_t)r.temp10);
+      put16(out + len + 2, r.hum10);
+      len += 4;
+    }
+    *tag |= valueMode << TAG_VALUE_SHIFT;
+    if (valid) {
+      haveValues = true;
+      lastTemp = r.temp10;
+      lastHum = r.hum10;
+    }
+  }
+  
+  out[0] = STORE_BLOCK_VERSION;
+  out[1] = n;
+  put16(out + 2, (uint16_t)len);
+  return len;
+}
+
+/*
+ * Read a block header
+ * 
+ * @param header: first STORE_BLOCK_HEADER bytes of the block
+ * @param count: receives the record count
+ * @return block length, or 0 if this is not a block header
+ */
+size_t StoreCodec::blockLength(const uint8_t *header, uint8_t *count) {
+  if (header[0] != STORE_BLOCK_VERSION || header[1] == 0) return 0;
+  size_t len = get16(header + 2);
+  if (len <= STORE_BLOCK_HEADER || len > STORE_BLOCK_BYTES(header[1])) return 0;
+  *count = header[1];
+  return len;
+}
+
+/*
+ * Decode a block produced by encodeBlock()
+ * 
+ * @param in: the whole block
+ * @param len: its length
+ * @param recs: receives the records
+ * @param cap: room in recs
+ * @return records decoded, 0 if the block is malformed or does not fit
+ */
+uint8_t StoreCodec::decodeBlock(const uint8_t *in, size_t len, StoreRecord *recs, uint8_t cap) {
+  uint8_t count = 0;
+  if (len < STORE_BLOCK_HEADER || blockLength(in, &count) != len || count > cap) return 0;
+  
+  size_t pos = STORE_BLOCK_HEADER;
+  bool haveTime = false, haveValues = false;
+  uint32_t lastEpoch = 0;
+  int16_t lastTemp = 0;
+  uint16_t lastHum = 0;
+  for (uint8_t i = 0; i < count; i++) {
+    if (pos >= len) return 0;
+    uint8_t tag = in[pos++];
+    StoreRecord &r = recs[i];
+    r.kind = tag & TAG_KIND_MASK;
+    
+    uint8_t timeMode = (tag >> TAG_TIME_SHIFT) & 0x03;
+    if (timeMode == TIME_ABS) {
+      if (pos + 4 > len) return 0;
+      r.epoch = get32(in + pos);
+      pos += 4;
+    } else if (timeMode == TIME_U8 || timeMode == TIME_U16) {
+      size_t width = timeMode == TIME_U8 ? 1 : 2;
+      if (!haveTime || pos + width > len) return 0;
+      r.epoch = lastEpoch + (width == 1 ? in[pos] : get16(in + pos));
+      pos += width;
+    } else {
+      return 0;
+    }
+    haveTime = true;
+    lastEpoch = r.epoch;
+    
+    if (r.kind != STORE_ENV) {
+      if (pos + 1 > len) return 0;
+      r.reason = in[pos++];
+      r.temp10 = STORE_NAN_TEMP;
+      r.hum10 = STORE_NAN_HUM;
+      continue;
+    }
+    r.reason = 0;
+    uint8_t valueMode = (tag >> TAG_VALUE_SHIFT) & 0x03;
+    if (valueMode == VALUE_NIBBLE) {
+      if (!haveValues || pos + 1 > len) return 0;
+      r.temp10 = (int16_t)(lastTemp + nibble(in[pos] & 0x0F));
+      r.hum10 = (uint16_t)(lastHum + nibble(in[pos] >> 4));
+      pos += 1;
+    } else if (valueMode == VALUE_I8) {
+      if (!haveValues || pos + 2 > len) return 0;
+      r.temp10 = (int16_t)(lastTemp + (int8_t)in[pos]);
+      r.hum10 = (uint16_t)(lastHum + (int8_t)in[pos + 1]);
+      pos += 2;
+    } else if (valueMode == VALUE_ABS) {
+      if (pos + 4 > len) return 0;
+      r.temp10 = (int16_t)get16(in + pos);
+      r.hum10 = get16(in + pos + 2);
+      pos += 4;
+    } else {
+      return 0;
+    }
+    if (validValues(r.temp10, r.hum10)) {
+      haveValues = true;
+      lastTemp = r.temp10;
+      lastHum = r.hum10;
+    }
+  }
+  return pos == len ? count : 0;
+}
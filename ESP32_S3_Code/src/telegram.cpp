@@ -8,47 +8,662 @@
  *    - Fast and simple, minimal ESP32 processing
  * 
  * 2. Multipart Upload Method (for private LAN images):
- *    - ESP32 fetches image bytes from local camera
- *    - Uploads to Telegram via multipart/form-data
+ *    - ESP32 streams image bytes from local camera
+ *    - Pipes them into a multipart/form-data upload as they arrive,
+ *      through a borrowed PSRAM frame slot (FramePool) so a failed
+ *      upload is replayed without fetching the camera again; without
+ *      a free slot, through one small chunk buffer
  *    - Required because Telegram cannot access private IPs
  * 
+ * 3. Album (multi-camera motion alerts):
+ *    - Frames from every camera that answered are requested in
+ *      parallel and piped one after another into a single
+ *      sendMediaGroup upload
+ * 
+ * All requests share one keep-alive TLS session (see connection
+ * manager below), so most alerts skip the TLS handshake.
+ * 
  * Includes robust retry logic, timeout handling, and fallback to
  * text-only alerts if image delivery fails.
  */
 
 #include "telegram.h"
 #include "config.h"
-#include <HTTPClient.h>
 #include <WiFiClient.h>
+#include <WiFiClientSecure.h>
 #include <ArduinoJson.h>
+#include <limits.h>
+#include "logging.h"
+#include "metrics.h"
+#include "http_codec.h"
+#include "camera_client.h"
+#include "lan_http.h"
+#include "frame_pool.h"
+
+// Streaming upload tuning
+// One TCP segment per read/write; without a frame slot this keeps peak
+// internal memory at a single small buffer regardless of frame size.
+static const size_t UPLOAD_CHUNK_SIZE = 1460;
+static const unsigned long STREAM_IDLE_MS = 12000;   // Max wait for camera bytes
+static const unsigned long RESPONSE_TIMEOUT_MS = 20000; // Max wait for Telegram reply
+
+/*
+ * Write one piece of the request body
+ * 
+ * When the camera did not declare a Content-Length the upload uses
+ * chunked transfer encoding, so each piece is framed as an HTTP chunk.
+ */
+static bool writeBodyPart(Client &c, bool chunked, const uint8_t *data, size_t len) {
+  if (len == 0) return true;
+  if (chunked) {
+    char hdr[12];
+    int n = snprintf(hdr, sizeof(hdr), "%X\r\n", (unsigned)len);
+    if (!LanHttp::writeAll(c, (const uint8_t*)hdr, n)) return false;
+  }
+  if (!LanHttp::writeAll(c, data, len)) return false;
+  if (chunked) return LanHttp::writeAll(c, (const uint8_t*)"\r\n", 2);
+  return true;
+}
+
+// ---- Telegram connection manager ----
+// One TLS session to api.telegram.org is kept open with HTTP/1.1
+// keep-alive and shared by sendMessage and sendPhoto, so only the first
+// request (or the first after the server drops the session) pays for a
+// full handshake. Access is serialized with tgMutex.
+static WiFiClientSecure tgClient;
+static SemaphoreHandle_t tgMutex = nullptr;
+static Telegram::SessionStats tgStats = {0, 0, 0, 0};
+static unsigned long tgLastUse = 0;   // millis() when the session was last released
+static bool tgReused = false;         // Current request rides on a warm session
+
+static const size_t RESPONSE_BODY_KEEP = 512; // Response bytes kept for logging/JSON
+static const size_t PATH_MAX_LEN = 960;       // Bot API GET path incl. encoded query
+
+/*
+ * Acquire the shared session, opening a new TLS connection if needed
+ * 
+ * @param waitTicks: How long to wait for another task's request to finish
+ * @param warmOnly: Only use a session that is still open, never handshake
+ * @return true with tgMutex held and tgClient connected;
+ *         false if the lock or the connection could not be obtained
+ */
+static bool sessionOpen(TickType_t waitTicks = portMAX_DELAY, bool warmOnly = false) {
+  if (xSemaphoreTake(tgMutex, waitTicks) != pdTRUE) return false;
+  
+  if (tgClient.connected()) {
+    tgReused = true;  // Counted as saved only once a response arrives (noteResponse)
+    return true;
+  }
+  if (warmOnly) {
+    xSemaphoreGive(tgMutex);
+    return false;
+  }
+  
+  tgClient.stop();  // Clear any half-closed socket state
+  tgClient.setInsecure(); // No CA pinning (same trust model as before)
+  unsigned long t0 = millis();
+  if (!tgClient.connect("api.telegram.org", 443)) {
+    LOGE("TELEGRAM", "✗ TLS connect to api.telegram.org failed");
+    xSemaphoreGive(tgMutex);
+    return false;
+  }
+  tgReused = false;
+  tgStats.handshakes++;
+  tgStats.handshakeMsTotal += millis() - t0;
+  LOGI("TELEGRAM", "TLS session opened in %lums", millis() - t0);
+  return true;
+}
+
+/*
+ * A response arrived: on a warm session that is a handshake saved
+ * A stale session fails before this, so it is never counted as reused.
+ */
+static void noteResponse(int code) {
+  if (code > 0 && tgReused) tgStats.reused++;
+}
+
+/*
+ * Release the shared session
+ * 
+ * @param keep: Leave the connection open for the next request; false
+ *              closes it (error, or server asked for Connection: close)
+ */
+static void sessionClose(bool keep) {
+  if (!keep) tgClient.stop();
+  tgLastUse = millis();
+  xSemaphoreGive(tgMutex);
+}
+
+/*
+ * Read an HTTP/1.1 response completely so the session can be reused
+ * 
+ * Handles Content-Length and chunked bodies. Bodies without either are
+ * read until the server closes, which also ends the session.
+ * 
+ * @param c: Connected client
+ * @param body: Receives the start of the body, NUL-terminated (may be null)
+ * @param bodyCap: Size of body
+ * @param keepAlive: Set to whether the connection may be reused
+ * @return HTTP status code, or -3 if the response was missing or broken
+ */
+static int readResponse(Client &c, char *body, size_t bodyCap, bool *keepAlive) {
+  char line[160];
+  unsigned long deadline = millis() + RESPONSE_TIMEOUT_MS;
+  size_t kept = 0;
+  *keepAlive = false;
+  if (body && bodyCap) body[0] = '\0';
+  
+  // Status line: "HTTP/1.1 200 OK"
+  if (!LanHttp::readLine(c, line, sizeof(line), deadline)) return -3;
+  const char *sp = strchr(line, ' ');
+  if (!sp) return -3;
+  int code = atoi(sp + 1);
+  
+  // Headers
+  long contentLength = -1;
+  bool chunked = false;
+  bool serverClose = false;
+  for (;;) {
+    if (!LanHttp::readLine(c, line, sizeof(line), deadline)) return -3;
+    if (line[0] == '\0') break; // Blank line ends headers
+    if (strncasecmp(line, "Content-Length:", 15) == 0) {
+      contentLength = atol(line + 15);
+    } else if (strncasecmp(line, "Transfer-Encoding:", 18) == 0 && strstr(line + 18, "chunked")) {
+      chunked = true;
+    } else if (strncasecmp(line, "Connection:", 11) == 0 && strstr(line + 11, "close")) {
+      serverClose = true;
+    }
+  }
+  
+  // Body: consume every byte, keep the first few for the caller
+  auto consume = [&](long n) -> bool {
+    while (n > 0 && (long)(deadline - millis()) > 0) {
+      if (c.available() <= 0) {
+        if (!c.connected()) return false;
+        delay(5);
+        continue;
+      }
+      int ch = c.read();
+      if (ch < 0) continue;
+      if (body && kept + 1 < bodyCap) {
+        body[kept++] = (char)ch;
+        body[kept] = '\0';
+      }
+      n--;
+    }
+    return n == 0;
+  };
+  
+  bool complete;
+  if (chunked) {
+    complete = false;
+    while (LanHttp::readLine(c, line, sizeof(line), deadline)) {
+      long size = strtol(line, nullptr, 16);
+      if (size == 0) { // Last chunk, then optional trailers up to blank line
+        while (LanHttp::readLine(c, line, sizeof(line), deadline) && line[0] != '\0') {}
+        complete = true;
+        break;
+      }
+      if (!consume(size) || !LanHttp::readLine(c, line, sizeof(line), deadline)) break; // Data + CRLF
+    }
+  } else if (contentLength >= 0) {
+    complete = consume(contentLength);
+  } else {
+    consume(LONG_MAX); // Read until close
+    complete = false;  // Session cannot be reused without a length
+  }
+  
+  *keepAlive = complete && !serverClose;
+  return code;
+}
+
+/*
+ * Issue a GET to the Bot API over the shared session
+ * 
+ * A request on a warm session that fails before any response is retried
+ * once on a fresh connection - the server may have dropped it silently.
+ * 
+ * @param path: Request path incl. query (e.g., "/bot<token>/sendMessage?...")
+ * @param body: Receives start of response body (may be null)
+ * @param bodyCap: Size of body
+ * @param waitTicks: Max wait for the session lock
+ * @param warmOnly: Skip (-2) rather than open a new session
+ * @return HTTP status code, or negative on local failure
+ */
+static int telegramGet(const char *path, char *body, size_t bodyCap, TickType_t waitTicks = portMAX_DELAY,
+                       bool warmOnly = false) {
+  static const char REQ_TAIL[] = " HTTP/1.1\r\n"
+                                 "Host: api.telegram.org\r\n"
+                                 "Connection: keep-alive\r\n\r\n";
+  for (int attempt = 0; attempt < 2; attempt++) {
+    if (!sessionOpen(waitTicks, warmOnly)) return -2;
+    bool reused = tgReused;
+    
+    // Written in pieces - the path is never copied into a request buffer
+    bool keep = false;
+    int code = -3;
+    if (LanHttp::writeAll(tgClient, (const uint8_t*)"GET ", 4) &&
+        LanHttp::writeAll(tgClient, (const uint8_t*)path, strlen(path)) &&
+        LanHttp::writeAll(tgClient, (const uint8_t*)REQ_TAIL, sizeof(REQ_TAIL) - 1)) {
+      code = readResponse(tgClient, body, bodyCap, &keep);
+    }
+    noteResponse(code);
+    sessionClose(keep);
+    
+    if (code > 0 || !reused) return code;
+    tgStats.staleSessions++;
+    LOGI("TELEGRAM", "Warm session was stale - reconnecting");
+  }
+  return -3;
+}
+
+// ---- Camera fetch ----
+// The camera GET is split into request and response halves (LanHttp).
+// Two-stage alerts send the request before the text notification, so
+// the camera is already serving the frame by the time the upload starts.
+
+/*
+ * Send the camera GET request, without waiting for the response
+ * 
+ * @return false if the URL is unusable or the camera did not accept the connection
+ */
+static bool cameraRequest(HttpFetch &f, const char *imageUrl) {
+  return LanHttp::request(f, imageUrl);
+}
+
+/*
+ * Read the camera's status line and headers (H_TG_LOCAL_GET)
+ * 
+ * @param contentLength: Receives Content-Length, or -1 if not sent
+ * @param timeoutMs: How long the headers may take to arrive
+ * @return HTTP status code, or -1 if no valid response arrived
+ */
+static int cameraResponse(HttpFetch &f, long *contentLength, unsigned long timeoutMs = STREAM_IDLE_MS) {
+  int code = LanHttp::response(f, contentLength, millis() + timeoutMs);
+  Metrics::observeSince(H_TG_LOCAL_GET, f.startUs);
+  return code;
+}
+
+/*
+ * Pipe a camera body into the open Telegram request
+ * 
+ * Reads UPLOAD_CHUNK_SIZE pieces and writes each straight out, so the
+ * camera still paces itself on the uplink. With a frame slot the pieces
+ * are read into the slot, which then holds the whole frame for a replay;
+ * if Telegram breaks off, the rest of the frame is still read into the
+ * slot (LAN speed) so the retry does not need the camera. Without a slot
+ * only one chunk buffer is used. Stops at contentLength (when known),
+ * when the camera closes, or after STREAM_IDLE_MS without data.
+ * 
+ * @param chunked: Frame each piece as an HTTP chunk
+ * @param contentLength: Bytes to copy, or <= 0 to copy until close
+ * @param frame: Borrowed slot or nullptr; len is set to the frame size
+ *               if the whole frame arrived in it, 0 otherwise
+ * @param piped: Receives the number of bytes read from the camera
+ * @return false if writing to Telegram failed
+ */
+static bool pipeBody(WiFiClient &stream, Client &tls, bool chunked, long contentLength, FrameBuf *frame, size_t *piped) {
+  static uint8_t chunk[UPLOAD_CHUNK_SIZE]; // Only caller is the alert path
+  bool keep = frame && frame->data && (contentLength <= 0 || (size_t)contentLength <= frame->cap);
+  bool ok = true;
+  bool closed = false;
+  *piped = 0;
+  unsigned long lastProgress = millis();
+  while (ok || keep) {
+    if (contentLength > 0 && *piped >= (size_t)contentLength) break; // Got every byte
+
+    int avail = stream.available();
+    if (avail <= 0) {
+      // No data available - check if still connected and not timed out
+      if (stream.connected() && (millis() - lastProgress) < STREAM_IDLE_MS) {
+        delay(5); // Small delay to avoid busy-waiting
+        continue;
+      }
+      closed = !stream.connected();
+      break; // Connection closed or idle timeout
+    }
+
+    size_t toRead = ((size_t)avail < UPLOAD_CHUNK_SIZE) ? (size_t)avail : UPLOAD_CHUNK_SIZE;
+    if (contentLength > 0) {
+      // Known length: don't read beyond declared size
+      size_t remaining = (size_t)contentLength - *piped;
+      if (toRead > remaining) toRead = remaining;
+    }
+    if (keep && *piped + toRead > frame->cap) {
+      keep = false;  // Unsized frame outgrew the slot: relay the rest in chunks
+      if (!ok) break;
+    }
+
+    uint8_t *dst = keep ? frame->data + *piped : chunk;
+    int n = stream.read(dst, toRead);
+    if (n <= 0) continue;
+    if (ok) ok = writeBodyPart(tls, chunked, dst, n);
+    *piped += n;
+    lastProgress = millis(); // Reset idle timer
+  }
+  if (frame) {
+    bool whole = contentLength > 0 ? *piped == (size_t)contentLength : closed && *piped > 0;
+    frame->len = keep && whole ? *piped : 0;
+  }
+  return ok;
+}
+
+/*
+ * Stream a camera JPEG straight into a Telegram sendPhoto upload
+ * 
+ * Process:
+ * 1. Read the camera's response headers (request sent by cameraRequest)
+ * 2. Acquire TLS session to api.telegram.org and write request headers
+ * 3. Write multipart preamble (chat_id, reply, caption, photo part header)
+ * 4. Pipe camera stream to TLS socket in UPLOAD_CHUNK_SIZE pieces
+ * 5. Write multipart trailer and read Telegram's HTTP response
+ * 
+ * The request goes over the shared keep-alive session, so a warm
+ * connection skips the TLS handshake.
+ * 
+ * The frame goes through a borrowed PSRAM slot when there is one (see
+ * pipeBody); a slot that already holds a whole frame is uploaded from
+ * memory and the camera is not asked at all. Falls back to chunked
+ * transfer encoding if the camera omits Content-Length.
+ * 
+ * @param fetch: Camera request already sent (unused on a replay); closed on return
+ * @param text: Caption for the photo
+ * @param replyTo: message_id to thread the photo under (0 = none)
+ * @param frame: Borrowed slot or nullptr; holds the frame afterwards if it fit
+ * @return Telegram HTTP status code, or negative value on local failure
+ *         (-1 camera fetch failed, -2 TLS connect failed,
+ *          -3 stream broke or Telegram did not answer)
+ */
+static int streamPhotoUpload(HttpFetch &fetch, const char *text, long replyTo, FrameBuf *frame) {
+  // === STEP 1: Camera response, or the frame kept from the last attempt ===
+  bool replay = frame && frame->len > 0;
+  long contentLength = -1;
+  int code = 200;
+  if (replay) {
+    contentLength = (long)frame->len;
+    fetch.client.stop();
+    LOGI("TELEGRAM", "Replaying the buffered frame (%ld bytes) - camera not asked again", contentLength);
+  } else {
+    code = fetch.requested ? cameraResponse(fetch, &contentLength) : -1;
+    LOGI("TELEGRAM", "Local GET: %d", code);
+  }
+  if (code != 200) {
+    fetch.client.stop();
+    Metrics::count(M_TG_FETCH_FAIL);
+    return -1;
+  }
+
+  bool chunked = contentLength <= 0;
+  if (chunked) {
+    LOGI("TELEGRAM", "Image size unknown (no length) - using chunked upload");
+  } else if (!replay) {
+    LOGI("TELEGRAM", "Image size (Content-Length): %ld bytes", contentLength);
+  }
+  WiFiClient &stream = fetch.client; // stream of JPEG data
+
+  // === STEP 2: Build multipart envelope ===
+  // Generate unique boundary string for multipart form
+  char boundary[32];
+  HttpCodec::multipartBoundary(millis(), boundary, sizeof(boundary));
+
+  // Caption is at most AlertEvent::text (128 bytes), so 512 always fits
+  char pre[512];
+  size_t preLen = HttpCodec::multipartPreamble(boundary, TELEGRAM_CHATID, text, replyTo, pre, sizeof(pre));
+  char post[48];
+  size_t postLen = HttpCodec::multipartTrailer(boundary, post, sizeof(post));
+  if (preLen == 0) {
+    stream.stop();
+    return -3;  // Caption too long for the envelope
+  }
+
+  // === STEP 3: Acquire Telegram session and send request headers ===
+  if (!sessionOpen()) {
+    stream.stop();
+    return -2;
+  }
+  WiFiClientSecure &tls = tgClient;
+
+  char head[256];
+  int headLen = snprintf(head, sizeof(head),
+                "POST /bot" TELEGRAM_TOKEN "/sendPhoto HTTP/1.1\r\n"
+                "Host: api.telegram.org\r\n"
+                "Content-Type: multipart/form-data; boundary=%s\r\n",
+                boundary);
+  if (chunked) {
+    headLen += snprintf(head + headLen, sizeof(head) - headLen, "Transfer-Encoding: chunked\r\n");
+  } else {
+    size_t totalLen = preLen + (size_t)contentLength + postLen;
+    headLen += snprintf(head + headLen, sizeof(head) - headLen, "Content-Length: %u\r\n", (unsigned)totalLen);
+  }
+  headLen += snprintf(head + headLen, sizeof(head) - headLen, "Connection: keep-alive\r\n\r\n");
+
+  bool ok = LanHttp::writeAll(tls, (const uint8_t*)head, headLen)
+         && writeBodyPart(tls, chunked, (const uint8_t*)pre, preLen);
+
+  // === STEP 4: Pipe camera bytes (or the buffered frame) to TLS socket ===
+  size_t piped = 0;
+  if (ok && replay) {
+    ok = LanHttp::writeAll(tls, frame->data, frame->len);
+    piped = frame->len;
+  } else if (ok) {
+    ok = pipeBody(stream, tls, chunked, chunked ? -1 : contentLength, frame, &piped);
+  }
+  stream.stop(); // Camera connection no longer needed
+
+  // Validate completeness when length was known
+  if (!chunked && piped != (size_t)contentLength) {
+    LOGE("TELEGRAM", "✗ Short read: %u/%ld", (unsigned)piped, contentLength);
+    ok = false; // Body would be truncated - abandon this request
+  } else if (piped == 0) {
+    LOGE("TELEGRAM", "✗ No data read from stream");
+    ok = false;
+  }
+
+  if (!ok) {
+    sessionClose(false); // Request is half-written - session unusable
+    return -3;
+  }
+
+  // === STEP 5: Trailer and response ===
+  ok = writeBodyPart(tls, chunked, (const uint8_t*)post, postLen);
+  if (ok && chunked) ok = LanHttp::writeAll(tls, (const uint8_t*)"0\r\n\r\n", 5); // Final chunk
+  if (!ok) {
+    sessionClose(false);
+    return -3;
+  }
+  LOGI("TELEGRAM", "Streamed %u image bytes", (unsigned)piped);
+
+  char resp[RESPONSE_BODY_KEEP];
+  bool keep = false;
+  int upCode = readResponse(tls, resp, sizeof(resp), &keep);
+  if (upCode != 200) {
+    LOGW("TELEGRAM", "Response: %s", resp);
+  }
+  noteResponse(upCode);
+  sessionClose(keep);
+  return upCode;
+}
 
 /*
- * URL-encode a string for safe transmission in HTTP GET parameters
+ * Stream several camera JPEGs into one sendMediaGroup upload
+ * 
+ * Process:
+ * 1. Collect each camera's response headers until CAM_ALBUM_DEADLINE_MS
+ *    (requests already sent - the cameras serve in parallel, so this
+ *    waits for the slowest one, not the sum); late or failed frames
+ *    are left out
+ * 2. Build the envelope: chat_id, optional reply, media array with
+ *    attach://p<i> references, then one file part per frame
+ * 3. Pipe the frames one after another into the same TLS request
  * 
- * Converts special characters to %XX format (e.g., space -> +)
- * Preserves alphanumeric and safe characters (- _ . ~)
+ * Every frame must declare Content-Length (both camera endpoints do),
+ * so the total body length is known before the first byte is sent.
  * 
- * @param str: Raw string to encode
- * @return URL-encoded string safe for HTTP transmission
+ * @param fetches: Camera requests already sent; all closed on return
+ * @param n: Number of fetches (at most CAM_MAX_NODES)
+ * @param caption: Caption shown under the album (first photo)
+ * @param replyTo: message_id to thread the album under (0 = none)
+ * @return Telegram HTTP status code, or negative value on local failure
+ *         (-1 fewer than two frames arrived, -2 TLS connect failed,
+ *          -3 stream broke or Telegram did not answer)
  */
-String urlEncode(String str) {
-  String encoded = "";
-  char c;
-  for (int i = 0; i < str.length(); i++) {
-    c = str.charAt(i);
-    if (c == ' ') {
-      encoded += '+';  // Space becomes +
-    } else if (isalnum(c) || c == '-' || c == '_' || c == '.' || c == '~') {
-      encoded += c;  // Safe characters pass through
+static int streamMediaGroup(HttpFetch *fetches, int n, const char *caption, long replyTo) {
+  // === STEP 1: Camera responses within the deadline ===
+  long lengths[CAM_MAX_NODES];
+  int ready = 0;
+  unsigned long deadline = millis() + CAM_ALBUM_DEADLINE_MS;
+  for (int i = 0; i < n; i++) {
+    lengths[i] = -1;
+    if (!fetches[i].requested) continue;
+    long left = (long)(deadline - millis());
+    int code = cameraResponse(fetches[i], &lengths[i], left > 0 ? left : 1);
+    if (code != 200 || lengths[i] <= 0) {
+      LOGW("TELEGRAM", "⚠ Camera %d left out of album (code: %d, length: %ld)", i, code, lengths[i]);
+      if (code < 0) Metrics::count(M_CAM_LATE);
+      fetches[i].client.stop();
+      fetches[i].requested = false;
+      continue;
+    }
+    ready++;
+  }
+  if (ready < 2) {
+    for (int i = 0; i < n; i++) fetches[i].client.stop();
+    return -1;  // sendMediaGroup needs at least two items
+  }
+
+  // === STEP 2: Envelope ===
+  char boundary[32];
+  HttpCodec::multipartBoundary(millis(), boundary, sizeof(boundary));
+
+  char escaped[256];
+  HttpCodec::jsonEscape(caption, escaped, sizeof(escaped));
+  char media[512];
+  size_t mediaLen = 1;
+  strlcpy(media, "[", sizeof(media));
+  int item = 0;
+  for (int i = 0; i < n && mediaLen < sizeof(media); i++) {
+    if (!fetches[i].requested) continue;
+    if (item++ == 0) {
+      mediaLen += snprintf(media + mediaLen, sizeof(media) - mediaLen,
+                           "{\"type\":\"photo\",\"media\":\"attach://p%d\",\"caption\":\"%s\"}", i, escaped);
     } else {
-      // Encode as %XX hexadecimal
-      encoded += '%';
-      char hex[3];
-      sprintf(hex, "%02X", c);
-      encoded += hex;
+      mediaLen += snprintf(media + mediaLen, sizeof(media) - mediaLen,
+                           ",{\"type\":\"photo\",\"media\":\"attach://p%d\"}", i);
+    }
+  }
+  if (mediaLen < sizeof(media)) mediaLen += strlcpy(media + mediaLen, "]", sizeof(media) - mediaLen);
+
+  char pre[768];
+  size_t preLen = 0;
+  char replyId[16];
+  snprintf(replyId, sizeof(replyId), "%ld", replyTo);
+  if (replyTo > 0) preLen += HttpCodec::multipartField(boundary, "reply_to_message_id", replyId, pre, sizeof(pre));
+  preLen += HttpCodec::multipartField(boundary, "chat_id", TELEGRAM_CHATID, pre + preLen, sizeof(pre) - preLen);
+  size_t mediaPart = mediaLen < sizeof(media)
+                   ? HttpCodec::multipartField(boundary, "media", media, pre + preLen, sizeof(pre) - preLen) : 0;
+  char post[48];
+  size_t postLen = HttpCodec::multipartTrailer(boundary, post, sizeof(post));
+  if (mediaPart == 0) {
+    for (int i = 0; i < n; i++) fetches[i].client.stop();
+    return -3;  // Caption too long for the envelope
+  }
+  preLen += mediaPart;
+
+  // Part headers differ only in the index, so sizes are computed up front
+  char part[160];
+  size_t totalLen = preLen + postLen;
+  item = 0;
+  for (int i = 0; i < n; i++) {
+    if (!fetches[i].requested) continue;
+    char name[4];
+    snprintf(name, sizeof(name), "p%d", i);
+    totalLen += HttpCodec::multipartFileHeader(boundary, name, item++ > 0, part, sizeof(part)) + (size_t)lengths[i];
+  }
+
+  // === STEP 3: Request headers, then every frame in turn ===
+  if (!sessionOpen()) {
+    for (int i = 0; i < n; i++) fetches[i].client.stop();
+    return -2;
+  }
+  WiFiClientSecure &tls = tgClient;
+
+  char head[256];
+  int headLen = snprintf(head, sizeof(head),
+                "POST /bot" TELEGRAM_TOKEN "/sendMediaGroup HTTP/1.1\r\n"
+                "Host: api.telegram.org\r\n"
+                "Content-Type: multipart/form-data; boundary=%s\r\n"
+                "Content-Length: %u\r\n"
+                "Connection: keep-alive\r\n\r\n",
+                boundary, (unsigned)totalLen);
+  bool ok = LanHttp::writeAll(tls, (const uint8_t*)head, headLen)
+         && LanHttp::writeAll(tls, (const uint8_t*)pre, preLen);
+
+  size_t streamed = 0;
+  item = 0;
+  for (int i = 0; i < n; i++) {
+    if (!fetches[i].requested) continue;
+    char name[4];
+    snprintf(name, sizeof(name), "p%d", i);
+    size_t partLen = HttpCodec::multipartFileHeader(boundary, name, item++ > 0, part, sizeof(part));
+    size_t piped = 0;
+    ok = ok && LanHttp::writeAll(tls, (const uint8_t*)part, partLen)
+            && pipeBody(fetches[i].client, tls, false, lengths[i], nullptr, &piped);
+    fetches[i].client.stop();
+    if (ok && piped != (size_t)lengths[i]) {
+      LOGE("TELEGRAM", "✗ Short read from camera %d: %u/%ld", i, (unsigned)piped, lengths[i]);
+      ok = false; // Body would be truncated - abandon this request
     }
+    streamed += piped;
+  }
+  for (int i = 0; i < n; i++) fetches[i].client.stop();
+
+  if (ok) ok = LanHttp::writeAll(tls, (const uint8_t*)post, postLen);
+  if (!ok) {
+    sessionClose(false); // Request is half-written - session unusable
+    return -3;
+  }
+  LOGI("TELEGRAM", "Streamed %d photos, %u image bytes", ready, (unsigned)streamed);
+
+  char resp[RESPONSE_BODY_KEEP];
+  bool keep = false;
+  int upCode = readResponse(tls, resp, sizeof(resp), &keep);
+  if (upCode != 200) {
+    LOGW("TELEGRAM", "Response: %s", resp);
+  }
+  noteResponse(upCode);
+  sessionClose(keep);
+  return upCode;
+}
+
+/*
+ * message_id from a sendMessage/sendPhoto response body
+ * 
+ * Scans rather than parses: the kept body may be cut off after
+ * RESPONSE_BODY_KEEP bytes, but message_id comes first in "result".
+ * 
+ * @return message_id, or 0 if not found
+ */
+static long parseMessageId(const char *body) {
+  const char *p = strstr(body, "\"message_id\":");
+  return p ? atol(p + 13) : 0;
+}
+
+/*
+ * Send a plain text message
+ * 
+ * @return message_id of the sent message, or 0 on failure
+ */
+static long sendText(const char *text) {
+  char path[PATH_MAX_LEN];
+  size_t n = snprintf(path, sizeof(path), "/bot" TELEGRAM_TOKEN "/sendMessage?chat_id=" TELEGRAM_CHATID "&text=");
+  HttpCodec::urlEncode(text, path + n, sizeof(path) - n);
+  char response[RESPONSE_BODY_KEEP];
+  int code = telegramGet(path, response, sizeof(response));
+  if (code != 200) {
+    LOGE("TELEGRAM", "✗ sendMessage failed (%d): %s", code, code > 0 ? response : "");
+    return 0;
   }
-  return encoded;
+  return parseMessageId(response);
 }
 
 /*
@@ -57,301 +672,261 @@ String urlEncode(String str) {
  * Two-path delivery strategy:
  * 1. Text-only (if photoURL is empty)
  * 2. Photo URL method (if public URL)
- * 3. Multipart upload method (if private LAN URL)
+ * 3. Direct push (CAM_DIRECT_PUSH): camera uploads, S3 gets a receipt
+ * 4. Multipart upload method (if private LAN URL, or direct push failed)
+ * 
+ * Two-stage mode (TELEGRAM_TWO_STAGE) for motion photo alerts (triggerMs set):
+ * - The camera request goes out first, then the text alert is sent
+ *   right away - the user is notified after one round trip
+ * - The photo follows as a reply to that message
+ *   (reply_to_message_id) while the camera bytes are already waiting
+ * - Once the text is delivered the alert counts as sent; a photo
+ *   failure is logged but not retried by the Dispatcher, which would
+ *   repeat the text
  * 
  * Process:
  * - Detect if photoURL is private (10.x, 192.168.x, etc.)
- * - If private: fetch image bytes, upload via multipart/form-data
+ * - If private: stream image bytes into multipart/form-data upload
  * - If public: send URL directly to Telegram
  * - If image fetch/upload fails: fallback to text-only alert
  * 
  * @param text: Alert message/caption
  * @param photoURL: Optional image URL or JSON with image location
+ * @param triggerMs: millis() of the motion edge (0 = not a motion alert: single stage)
+ * @return true if Telegram accepted the message (HTTP 200)
  */
-void Telegram::sendAlert(String text, String photoURL) {
-  unsigned long startTime = millis();
-  Serial.println("\n=== SENDING TELEGRAM ALERT ===");
-  Serial.println("[TELEGRAM] Message: " + text);
-  
-  HTTPClient http;
-  String url;
+bool Telegram::sendAlert(const char *text, const char *photoURL, unsigned long triggerMs) {
+  uint64_t startUs = Metrics::now();
+  LOG_BANNER("\n=== SENDING TELEGRAM ALERT ===");
+  LOGI("TELEGRAM", "Message: %s", text);
   
-  // Lambda function to detect private IP addresses
-  // Returns true if URL points to local/private network (10.x, 192.168.x, 172.16-31.x, 127.x)
-  auto isPrivateHttpUrl = [](const String &u) -> bool {
-    if (!u.startsWith("http://") && !u.startsWith("https://")) return false;
-    // crude host extraction
-    int schemeEnd = u.indexOf("://");
-    String rest = u.substring(schemeEnd + 3);
-    int slash = rest.indexOf('/');
-    String host = (slash >= 0) ? rest.substring(0, slash) : rest;
-    return host.startsWith("10.") || host.startsWith("192.168.") || host.startsWith("127.") || host.startsWith("172.16.") || host.startsWith("172.17.") || host.startsWith("172.18.") || host.startsWith("172.19.") || host.startsWith("172.20.") || host.startsWith("172.21.") || host.startsWith("172.22.") || host.startsWith("172.23.") || host.startsWith("172.24.") || host.startsWith("172.25.") || host.startsWith("172.26.") || host.startsWith("172.27.") || host.startsWith("172.28.") || host.startsWith("172.29.") || host.startsWith("172.30.") || host.startsWith("172.31.");
-  };
+  char path[PATH_MAX_LEN];  // Bot API request path for the text/URL paths
+  size_t n;
+  long replyTo = 0;         // Two-stage: message_id of the text alert
 
-  if (photoURL == "") {
+  if (photoURL[0] == '\0') {
     // === Path 1: Text Message Only ===
-    Serial.println("[TELEGRAM] Type: Text message only");
-    url = "https://api.telegram.org/bot" + String(TELEGRAM_TOKEN)
-        + "/sendMessage?chat_id=" + String(TELEGRAM_CHATID)
-        + "&text=" + urlEncode(text);
+    LOGI("TELEGRAM", "Type: Text message only");
+    n = snprintf(path, sizeof(path), "/bot" TELEGRAM_TOKEN "/sendMessage?chat_id=" TELEGRAM_CHATID "&text=");
+    HttpCodec::urlEncode(text, path + n, sizeof(path) - n);
   } else {
     // Parse JSON to extract actual image URL if needed
-    String imageUrl = photoURL; // comes from CameraClient::capture() (URL or JSON)
-    if (photoURL.startsWith("{")) { // mock mode JSON -> extract url
-      Serial.println("[TELEGRAM] Parsing JSON photo response...");
-      DynamicJsonDocument doc(256);
+    char imageUrl[128]; // comes from CameraClient::capture() (URL or JSON)
+    strlcpy(imageUrl, photoURL, sizeof(imageUrl));
+    if (photoURL[0] == '{') { // mock mode JSON -> extract url
+      LOGI("TELEGRAM", "Parsing JSON photo response...");
+      StaticJsonDocument<256> doc;
       DeserializationError error = deserializeJson(doc, photoURL);
       if (!error && doc.containsKey("url")) {
-        imageUrl = doc["url"].as<String>();
-        Serial.println("[TELEGRAM] Extracted URL: " + imageUrl);
+        strlcpy(imageUrl, doc["url"] | "", sizeof(imageUrl));
+        LOGI("TELEGRAM", "Extracted URL: %s", imageUrl);
       }
     }
+    bool local = HttpCodec::isPrivateHttpUrl(imageUrl);
+    
+    // === Two-stage: camera request, then instant text alert ===
+    HttpFetch fetch;
+    fetch.requested = false;
+    if (TELEGRAM_TWO_STAGE && triggerMs) {
+      if (local && !CAM_DIRECT_PUSH) cameraRequest(fetch, imageUrl); // Camera serves while the text goes out
+      replyTo = sendText(text);
+      if (replyTo > 0) {
+        LOGI("TELEGRAM", "✓ Text alert delivered (message %ld) - photo follows as reply", replyTo);
+        if (triggerMs) Metrics::observe(H_MOTION_FIRST_NOTICE, (millis() - triggerMs) * 1000UL);
+      }
+    }
+    const char *caption = replyTo > 0 ? "📷 Snapshot" : text;
 
     // === Check if URL is private/local ===
-    // If URL is a private/local address, fetch bytes and upload via multipart
-    if (isPrivateHttpUrl(imageUrl)) { // LAN camera -> fetch bytes then upload
-      Serial.println("[TELEGRAM] Detected local/private image URL. Uploading bytes via multipart...");
+    // If URL is a private/local address, stream bytes into a multipart upload
+    // Direct push: the camera uploads the frame itself, we only get a receipt
+    if (local && CAM_DIRECT_PUSH) {
+      LOGI("TELEGRAM", "Asking camera to deliver the photo directly...");
+      if (fetch.requested) fetch.client.stop(); // Early relay request not needed
+      fetch.requested = false;
+      long photoId = 0;
+      int pushCode = CameraClient::deliver(imageUrl, caption, replyTo, &photoId);
+      if (pushCode == 200) {
+        LOGI("TELEGRAM", "✓ Photo delivered by camera (message %ld)", photoId);
+        Metrics::observeSince(H_TG_SEND, startUs);
+        return true;
+      }
+      LOGW("TELEGRAM", "⚠ Direct delivery failed (%d) - relaying through S3", pushCode);
+    }
+
+    if (local) { // LAN camera -> stream bytes into upload
+      LOGI("TELEGRAM", "Detected local/private image URL. Streaming bytes via multipart...");
 
-      const int maxFetchAttempts = 3;
       const int maxUploadAttempts = 3;
       const int backoffBaseMs = 600;
 
-      // === STEP 1: FETCH the image with retries ===
-      int fetchAttempt = 0;
-      int code = -1;
-      int contentLength = -1;
-      uint8_t* imgBuf = nullptr;
-      size_t imgSize = 0;
-      
-      // Retry loop for fetching image bytes from private URL
-      // Attempts up to 3 times with exponential backoff (600ms base)
+      // The frame is read into a PSRAM slot on the way through, so a
+      // retry replays those bytes: no second camera request, and a live
+      // /jpg capture is not swapped for a later frame. Without a free
+      // slot each attempt fetches from the camera again.
+      FrameBuf frame;
+      FramePool::borrow(frame);
+      int uploadAttempt = 0;
+      int upCode = -1;
       do {
-        fetchAttempt++;
-        HTTPClient imgHttp;
-        WiFiClient imgClient;
-        
-        // Configure HTTP client for image fetching
-        imgClient.setTimeout(12000);  // 12-second socket timeout
-        imgHttp.setTimeout(20000);    // 20-second overall timeout
-        imgHttp.setReuse(false);      // Close connection after use
-        imgHttp.useHTTP10(true);      // HTTP/1.0 avoids chunked encoding on some servers
-        imgHttp.begin(imgClient, imageUrl); // connect to camera
-        imgHttp.addHeader("Connection", "close");
-        
-        code = imgHttp.GET(); // download JPEG
-        Serial.println("[TELEGRAM] Local GET attempt " + String(fetchAttempt) + "/" + String(maxFetchAttempts) + ": " + String(code));
-        
-        if (code == 200) {
-          // Get declared Content-Length from response headers
-          contentLength = imgHttp.getSize();
-          if (contentLength > 0) {
-            Serial.println("[TELEGRAM] Image size (Content-Length): " + String(contentLength) + " bytes");
-          } else {
-            Serial.println("[TELEGRAM] Image size unknown (chunked/no length)");
-          }
-          
-          WiFiClient *stream = imgHttp.getStreamPtr(); // stream of JPEG data
-          
-          // Prepare buffer: exact size if known, dynamic if unknown (chunked transfer)
-          size_t cap = (contentLength > 0) ? (size_t)contentLength : 8192;
-          imgBuf = (uint8_t*)malloc(cap);
-          
-          if (!imgBuf) {
-            Serial.println("[TELEGRAM] ✗ Failed to allocate image buffer");
-            imgHttp.end();
-          } else {
-            size_t readTotal = 0;
-            unsigned long lastProgress = millis();
-            const unsigned long maxIdleMs = 12000; // 12-second idle timeout
-            
-            // Stream reading loop with idle timeout and dynamic buffer growth
-            while (true) {
-              int avail = stream->available();
-              
-              if (avail <= 0) {
-                // No data available - check if still connected and not timed out
-                if (imgClient.connected() && (millis() - lastProgress) < maxIdleMs) {
-                  delay(20); // Small delay to avoid busy-waiting
-                  continue;
-                }
-                // Connection closed or idle timeout - exit loop
-                break;
-              }
-              
-              size_t toRead = avail;
-              
-              if (contentLength > 0) {
-                // Known length: don't read beyond declared size
-                size_t remaining = (size_t)contentLength - readTotal;
-                if (toRead > (int)remaining) toRead = remaining;
-              } else {
-                // Unknown length (chunked): grow buffer dynamically if needed
-                if (readTotal + toRead > cap) {
-                  size_t newCap = cap * 2;  // Double capacity
-                  if (newCap < readTotal + toRead) newCap = readTotal + toRead;
-                  uint8_t* nb = (uint8_t*)realloc(imgBuf, newCap);
-                  
-                  if (!nb) {
-                    Serial.println("[TELEGRAM] ✗ Failed to grow buffer");
-                    break;
-                  }
-                  imgBuf = nb;
-                  cap = newCap;
-                }
-              }
-              
-              // Read chunk into buffer
-              int n = stream->read(imgBuf + readTotal, toRead);
-              if (n > 0) {
-                readTotal += n;
-                lastProgress = millis(); // Reset idle timer
-              } else {
-                delay(10); // Small wait to allow more data
-              }
-              
-              // Check if finished reading exact length
-              if (contentLength > 0 && readTotal == (size_t)contentLength) {
-                break;
-              }
-            }
-            
-            imgHttp.end();
-            imgSize = readTotal;
-            
-            // Validate completeness when length was known
-            if (contentLength > 0 && imgSize != (size_t)contentLength) {
-              Serial.println("[TELEGRAM] ✗ Short read: " + String(imgSize) + "/" + String(contentLength));
-              free(imgBuf); imgBuf = nullptr; imgSize = 0;
-            } else if (imgSize == 0) {
-              Serial.println("[TELEGRAM] ✗ No data read from stream");
-              free(imgBuf); imgBuf = nullptr;
-            } else {
-              Serial.println("[TELEGRAM] ✓ Image fetched successfully (" + String(imgSize) + " bytes)");
-              break; // Success - exit retry loop
-            }
-          }
-        } else {
-          imgHttp.end();
+        uploadAttempt++;
+        if (uploadAttempt > 1) Metrics::count(M_TG_UPLOAD_RETRY);
+        uint64_t upUs = Metrics::now();
+        if (!fetch.requested && frame.len == 0) cameraRequest(fetch, imageUrl);
+        upCode = streamPhotoUpload(fetch, caption, replyTo, &frame);
+        fetch.requested = false;
+        Metrics::observeSince(H_TG_UPLOAD, upUs);
+        LOGI("TELEGRAM", "Upload attempt %d/%d: %d", uploadAttempt, maxUploadAttempts, upCode);
+
+        if (upCode == 200) {
+          LOGI("TELEGRAM", "✓ Photo uploaded successfully");
+          FramePool::giveBack(frame);
+          Metrics::observeSince(H_TG_SEND, startUs);
+          return true; // Exit function - photo delivered successfully
         }
-        
-        // Retry backoff delay (exponential: 600ms, 1200ms, 1800ms)
-        if (fetchAttempt < maxFetchAttempts) {
-          int backoff = backoffBaseMs * fetchAttempt;
-          Serial.println("[TELEGRAM] Retrying fetch in " + String(backoff) + "ms...");
+
+        // Retry backoff delay (linear: 600ms, 1200ms)
+        if (uploadAttempt < maxUploadAttempts) {
+          int backoff = backoffBaseMs * uploadAttempt;
+          LOGI("TELEGRAM", "Retrying upload in %dms...", backoff);
           delay(backoff);
         }
-      } while (fetchAttempt < maxFetchAttempts);
-
-      if (code == 200 && imgBuf && imgSize > 0) {
-        // === STEP 2: UPLOAD via multipart/form-data with retries ===
-        
-        // Generate unique boundary string for multipart form
-        String boundary = "----ESP32Boundary" + String(millis()); // multipart boundary
-        
-        // Build multipart form body parts
-        // Part 1: chat_id field
-        String pre = "--" + boundary + "\r\n"
-                      "Content-Disposition: form-data; name=\"chat_id\"\r\n\r\n" + String(TELEGRAM_CHATID) + "\r\n"
-                      "--" + boundary + "\r\n"
-                      // Part 2: caption field
-                      "Content-Disposition: form-data; name=\"caption\"\r\n\r\n" + text + "\r\n"
-                      "--" + boundary + "\r\n"
-                      // Part 3: photo file field
-                      "Content-Disposition: form-data; name=\"photo\"; filename=\"image.jpg\"\r\n"
-                      "Content-Type: image/jpeg\r\n\r\n";
-        String post = "\r\n--" + boundary + "--\r\n";
-        
-        // Calculate total body size: header + image + footer
-        size_t totalLen = pre.length() + imgSize + post.length();
-
-        // Allocate single buffer for complete multipart body
-        std::unique_ptr<uint8_t[]> body(new (std::nothrow) uint8_t[totalLen]);
-        if (!body) {
-          Serial.println("[TELEGRAM] ✗ Failed to allocate multipart body (" + String(totalLen) + " bytes)");
-          free(imgBuf);
-        } else {
-          // Assemble complete multipart body in memory
-          memcpy(body.get(), pre.c_str(), pre.length());                           // Header
-          memcpy(body.get() + pre.length(), imgBuf, imgSize);                      // Image bytes
-          memcpy(body.get() + pre.length() + imgSize, post.c_str(), post.length()); // Footer
-
-          int uploadAttempt = 0;
-          int upCode = -1;
-          String resp;
-          
-          // Retry loop for uploading multipart form to Telegram
-          // Attempts up to 3 times with exponential backoff
-          do {
-            uploadAttempt++;
-            String apiUrl = "https://api.telegram.org/bot" + String(TELEGRAM_TOKEN) + "/sendPhoto";
-            
-            HTTPClient upHttp;
-            upHttp.setTimeout(20000); // 20-second timeout for upload
-            upHttp.begin(apiUrl);
-            upHttp.addHeader("Content-Type", "multipart/form-data; boundary=" + boundary);
-            
-            // POST entire multipart body
-            upCode = upHttp.POST(body.get(), totalLen); // upload to Telegram
-            Serial.println("[TELEGRAM] Upload attempt " + String(uploadAttempt) + "/" + String(maxUploadAttempts) + ": " + String(upCode));
-            
-            if (upCode != 200) {
-              // Upload failed - log response and retry
-              resp = upHttp.getString();
-              Serial.println("[TELEGRAM] Response: " + resp);
-              upHttp.end();
-              
-              if (uploadAttempt < maxUploadAttempts) {
-                int backoff = backoffBaseMs * uploadAttempt;
-                Serial.println("[TELEGRAM] Retrying upload in " + String(backoff) + "ms...");
-                delay(backoff);
-              }
-            } else {
-              // Upload successful
-              Serial.println("[TELEGRAM] ✓ Photo uploaded successfully");
-              upHttp.end();
-              free(imgBuf);
-              
-              unsigned long elapsed = millis() - startTime;
-              Serial.println("[PERF] Telegram send took: " + String(elapsed) + "ms");
-              return; // Exit function - photo delivered successfully
-            }
-          } while (uploadAttempt < maxUploadAttempts);
-          
-          free(imgBuf); // Clean up after failed upload attempts
-        }
-      } else {
-        Serial.println("[TELEGRAM] ✗ Failed to fetch local image for upload after retries");
-      }
+      } while (uploadAttempt < maxUploadAttempts);
+      FramePool::giveBack(frame);
+
+      LOGE("TELEGRAM", "✗ Failed to stream local image after retries");
       // Fallback to URL method below if multipart upload failed
     }
 
     // === Path 2: Photo URL Method (for public URLs or multipart fallback) ===
-    Serial.println("[TELEGRAM] Type: Photo with caption via URL");
-    Serial.println("[TELEGRAM] Photo URL: " + imageUrl);
-    url = "https://api.telegram.org/bot" + String(TELEGRAM_TOKEN) // public URL path
-        + "/sendPhoto?chat_id=" + String(TELEGRAM_CHATID)
-        + "&photo=" + urlEncode(imageUrl)
-        + "&caption=" + urlEncode(text);
+    LOGI("TELEGRAM", "Type: Photo with caption via URL");
+    LOGI("TELEGRAM", "Photo URL: %s", imageUrl);
+    n = snprintf(path, sizeof(path), "/bot" TELEGRAM_TOKEN "/sendPhoto?chat_id=" TELEGRAM_CHATID "&photo="); // public URL path
+    n += HttpCodec::urlEncode(imageUrl, path + n, sizeof(path) - n);
+    if (replyTo > 0 && n < sizeof(path)) n += snprintf(path + n, sizeof(path) - n, "&reply_to_message_id=%ld", replyTo);
+    if (n < sizeof(path)) n += strlcpy(path + n, "&caption=", sizeof(path) - n);
+    if (n < sizeof(path)) HttpCodec::urlEncode(caption, path + n, sizeof(path) - n);
   }
   
   // === Final API call (text-only or URL-based photo) ===
-  Serial.println("[TELEGRAM] Sending request to Telegram API...");
-  http.begin(url);
-  int httpCode = http.GET();
+  LOGI("TELEGRAM", "Sending request to Telegram API...");
+  char response[RESPONSE_BODY_KEEP];
+  int httpCode = telegramGet(path, response, sizeof(response));
   
-  Serial.print("[TELEGRAM] Response code: ");
-  Serial.println(httpCode);
+  LOGI("TELEGRAM", "Response code: %d", httpCode);
   
   if (httpCode == 200) {
-    Serial.println("[TELEGRAM] ✓ Alert sent successfully");
+    LOGI("TELEGRAM", "✓ Alert sent successfully");
+  } else if (replyTo > 0) {
+    LOGW("TELEGRAM", "⚠ Photo not delivered - text alert already sent");
   } else {
-    Serial.println("[TELEGRAM] ✗ Failed to send alert");
-    String response = http.getString();
-    Serial.println("[TELEGRAM] Response: " + response);
+    LOGE("TELEGRAM", "✗ Failed to send alert");
+    LOGE("TELEGRAM", "Response: %s", httpCode > 0 ? response : "");
   }
   
-  unsigned long elapsed = millis() - startTime;
-  Serial.println("[PERF] Telegram send took: " + String(elapsed) + "ms");
+  bool delivered = httpCode == 200 || replyTo > 0;
+  Metrics::observeSince(H_TG_SEND, startUs);
+  if (!delivered) Metrics::count(M_TG_SEND_FAIL);
+  LOGI("TELEGRAM", "Session: %u handshakes saved / %u performed", (unsigned)tgStats.reused, (unsigned)tgStats.handshakes);
   
-  http.end();
+  return delivered;
+}
+
+/*
+ * Send one alert with photos from several cameras as an album
+ * 
+ * Every camera request goes out first, so the cameras serve their
+ * frames in parallel while the text notification is sent; the album
+ * is then uploaded as a single sendMediaGroup request.
+ * 
+ * Falls back to sendAlert() with the primary photo when fewer than two
+ * frames arrive or when the URLs are not LAN cameras (mock mode). Album
+ * frames are always relayed through the S3: direct push (CAM_DIRECT_PUSH)
+ * uploads from one camera and cannot build a group.
+ * 
+ * @param text: Alert message/caption
+ * @param urls: Camera image URLs, primary camera first
+ * @param n: Number of URLs
+ * @param triggerMs: millis() of the motion edge (0 = single stage)
+ * @return true if Telegram accepted the alert
+ */
+bool Telegram::sendAlbum(const char *text, const char *const urls[], int n, unsigned long triggerMs) {
+  if (n > CAM_MAX_NODES) n = CAM_MAX_NODES;
+  if (n < 2 || !HttpCodec::isPrivateHttpUrl(urls[0])) return sendAlert(text, n > 0 ? urls[0] : "", triggerMs);
+  
+  uint64_t startUs = Metrics::now();
+  LOG_BANNER("\n=== SENDING TELEGRAM ALBUM ===");
+  LOGI("TELEGRAM", "Message: %s (%d cameras)", text, n);
+  
+  // === Camera requests first: every camera serves while the text goes out ===
+  HttpFetch fetches[CAM_MAX_NODES];
+  for (int i = 0; i < n; i++) {
+    fetches[i].requested = false;
+    if (HttpCodec::isPrivateHttpUrl(urls[i])) cameraRequest(fetches[i], urls[i]);
+  }
+  
+  long replyTo = 0;
+  if (TELEGRAM_TWO_STAGE && triggerMs) {
+    replyTo = sendText(text);
+    if (replyTo > 0) {
+      LOGI("TELEGRAM", "✓ Text alert delivered (message %ld) - album follows as reply", replyTo);
+      Metrics::observe(H_MOTION_FIRST_NOTICE, (millis() - triggerMs) * 1000UL);
+    }
+  }
+  const char *caption = replyTo > 0 ? "📷 Snapshots" : text;
+  
+  uint64_t upUs = Metrics::now();
+  int code = streamMediaGroup(fetches, n, caption, replyTo);
+  Metrics::observeSince(H_TG_UPLOAD, upUs);
+  LOGI("TELEGRAM", "sendMediaGroup: %d", code);
+  if (code == 200) {
+    LOGI("TELEGRAM", "✓ Album delivered");
+    Metrics::observeSince(H_TG_SEND, startUs);
+    return true;
+  }
+  
+  // === Fallback: primary photo only ===
+  LOGW("TELEGRAM", "⚠ Album failed (%d) - sending the primary photo only", code);
+  if (replyTo == 0) return sendAlert(text, urls[0]); // Nothing delivered yet - full single-photo path
+  
+  HttpFetch fetch;
+  int upCode = cameraRequest(fetch, urls[0]) ? streamPhotoUpload(fetch, caption, replyTo, nullptr) : -1;
+  if (upCode != 200) LOGW("TELEGRAM", "⚠ Photo not delivered - text alert already sent");
+  Metrics::observeSince(H_TG_SEND, startUs);
+  return true;  // Text went out; repeating it would duplicate the alert
+}
+
+/*
+ * Create the session lock
+ * Called once during setup() before any task can send
+ */
+void Telegram::init() {
+  tgMutex = xSemaphoreCreateMutex();
+}
+
+/*
+ * Keep the shared TLS session from idling out
+ * 
+ * Sends a tiny getMe request when the session has been idle for
+ * TELEGRAM_KEEPALIVE_MS, so the next alert skips the handshake.
+ * Never waits and never handshakes: if an alert is using the session,
+ * or the server has already closed it, this is skipped - a handshake
+ * here would hold tgMutex in front of the next alert. Once the session
+ * is gone nothing is sent until an alert opens a new one.
+ * Called periodically from loop().
+ */
+void Telegram::keepWarm() {
+  if (TELEGRAM_KEEPALIVE_MS == 0 || tgLastUse == 0) return; // Disabled or never used
+  if (millis() - tgLastUse < TELEGRAM_KEEPALIVE_MS) return;
+  
+  int code = telegramGet("/bot" TELEGRAM_TOKEN "/getMe", nullptr, 0, 0, true);
+  if (code == -2) return; // Session busy with an alert or already closed - try next time
+  LOGI("TELEGRAM", "Keep-alive ping: %d", code);
+}
+
+/*
+ * Session reuse statistics since boot
+ */
+Telegram::SessionStats Telegram::sessionStats() {
+  return tgStats;
 }
\ No newline at end of file
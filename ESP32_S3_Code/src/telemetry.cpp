@@ -0,0 +1,84 @@
+/*
+ * Telemetry Codec - Packed Binary Sensor Messages
+ * 
+ * Pure logic behind the self-hosted broker backend (net_mqtt.cpp),
+ * kept free of I/O so it can be unit tested on the host ([env:native]).
+ * 
+ * Adafruit IO takes one text value per feed and counts every one of
+ * them against 30 points/min. The broker backend sends each sensor
+ * cycle as one fixed 24-byte message instead, little-endian, with
+ * explicit byte offsets so it does not depend on struct packing:
+ * 
+ *   0  u8   version (TELEMETRY_VERSION)
+ *   1  u8   flags (TLM_*)
+ *   2  u32  seq
+ *   6  u32  epoch
+ *   10 i16  temp10
+ *   12 u16  hum10
+ *   14 i8   rssi
+ *   15 u8   reserved (0)
+ *   16 u32  freeHeap
+ *   20 u32  uptimeS
+ * 
+ * A collector can drop QoS 1 duplicates by seq and detect a reboot by
+ * seq going back together with uptime.
+ */
+
+#include "telemetry.h"
+
+static void put16(uint8_t *p, uint16_t v) {
+  p[0] = v & 0xFF;
+  p[1] = v >> 8;
+}
+
+static void put32(uint8_t *p, uint32_t v) {
+  for (int i = 0; i < 4; i++) p[i] = (v >> (8 * i)) & 0xFF;
+}
+
+static uint16_t get16(const uint8_t *p) {
+  return (uint16_t)(p[0] | (p[1] << 8));
+}
+
+static uint32_t get32(const uint8_t *p) {
+  return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+/*
+ * Encode a reading
+ * 
+ * @param out: receives TELEMETRY_LEN bytes
+ * @param cap: size of out
+ * @return TELEMETRY_LEN, or 0 if cap is too small
+ */
+size_t Telemetry::encode(const TelemetryReading &r, uint8_t *out, size_t cap) {
+  if (cap < TELEMETRY_LEN) return 0;
+  out[0] = TELEMETRY_VERSION;
+  out[1] = r.flags;
+  put32(out + 2, r.seq);
+  put32(out + 6, r.epoch);
+  put16(out + 10, (uint16_t)r.temp10);
+  put16(out + 12, r.hum10);
+  out[14] = (uint8_t)r.rssi;
+  out[15] = 0;
+  put32(out + 16, r.freeHeap);
+  put32(out + 20, r.uptimeS);
+  return TELEMETRY_LEN;
+}
+
+/*
+ * Decode a message produced by encode()
+ * 
+ * @return false if the length or version does not match
+ */
+bool Telemetry::decode(const uint8_t *in, size_t len, TelemetryReading &r) {
+  if (len != TELEMETRY_LEN || in[0] != TELEMETRY_VERSION) return false;
+  r.flags = in[1];
+  r.seq = get32(in + 2);
+  r.epoch = get32(in + 6);
+  r.temp10 = (int16_t)get16(in + 10);
+  r.hum10 = get16(in + 12);
+  r.rssi = (int8_t)in[14];
+  r.freeHeap = get32(in + 16);
+  r.uptimeS = get32(in + 20);
+  return true;
+}
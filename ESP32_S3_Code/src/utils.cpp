@@ -2,35 +2,67 @@
  * Utility Functions Module
  * 
  * Provides common helper functions used across the system.
- * Currently includes timestamp generation for logging and alerts.
+ * Currently includes NTP time sync and timestamp generation for
+ * logging, alerts and buffered telemetry.
  */
 
 #include "utils.h"
-#include <time.h>
+#include "config.h"
+#include "logging.h"
+
+// Anything earlier means the RTC still counts from boot (no NTP yet)
+static const time_t MIN_VALID_EPOCH = 1700000000;  // Nov 2023
 
 /*
- * Generate ISO 8601 formatted timestamp
+ * Start background NTP time sync
  * 
- * Returns current time in format: YYYY-MM-DDTHH:MM:SS
+ * Non-blocking: SNTP updates the system clock once a server answers.
+ * Call after Wi-Fi is connected.
+ */
+void Utils::syncTime() {
+  configTime(TZ_OFFSET_SEC, 0, NTP_SERVER);
+  LOGI("TIME", "NTP sync started (%s)", NTP_SERVER);
+}
+
+/*
+ * Current Unix time
+ * 
+ * @return seconds since 1970 (UTC), or 0 if NTP has not synced yet
+ */
+time_t Utils::epoch() {
+  time_t now = time(nullptr);
+  return now >= MIN_VALID_EPOCH ? now : 0;
+}
+
+/*
+ * Format a Unix time as ISO 8601 UTC: YYYY-MM-DDTHH:MM:SSZ
+ * 
+ * @param t: Unix time
+ * @param buf: output buffer (21 bytes needed)
+ * @return characters written, 0 if buf is too small
+ */
+size_t Utils::formatIso(time_t t, char *buf, size_t cap) {
+  struct tm tm;
+  gmtime_r(&t, &tm);
+  return strftime(buf, cap, "%Y-%m-%dT%H:%M:%SZ", &tm);
+}
+
+/*
+ * Format a Unix time as local ISO 8601: YYYY-MM-DDTHH:MM:SS
  * Example: "2025-01-15T14:30:45"
  * 
  * Used for:
  * - Alert message timestamps
  * - Log entries with time reference
- * - Event tracking in cloud dashboard
  * 
  * Note: Requires NTP time sync during WiFi setup
+ * 
+ * @param t: Unix time (e.g., SensorData.ts)
+ * @param buf: output buffer (20 bytes needed)
+ * @return characters written, 0 if buf is too small
  */
-String Utils::timestamp() {
-  time_t now;
-  time(&now); // Get current Unix timestamp
-  
-  struct tm t;
-  localtime_r(&now, &t); // Convert to local time structure
-  
-  char buf[25];
-  // Format as ISO 8601: YYYY-MM-DDTHH:MM:SS
-  strftime(buf, sizeof(buf), "%Y-%m-%dT%H:%M:%S", &t);
-  
-  return String(buf);
-}
\ No newline at end of file
+size_t Utils::timestamp(time_t t, char *buf, size_t cap) {
+  struct tm tm;
+  localtime_r(&t, &tm); // Convert to local time structure
+  return strftime(buf, cap, "%Y-%m-%dT%H:%M:%S", &tm);
+}
@@ -0,0 +1,173 @@
+/*
+ * Weather Rule Module - Threshold, Hysteresis and Rate-of-Change Rules
+ * 
+ * Pure decision logic behind Alerts::checkWeatherAlerts, kept free
+ * of I/O so it can be unit tested on the host ([env:native]).
+ * 
+ * Per quantity (temperature, humidity):
+ * - Level rule: alert once the value has stayed above `high` for
+ *   `dwellMs`; re-arm only when it falls below `high - hysteresis`, so
+ *   a value hovering at the limit alerts once instead of every cycle
+ * - Rate rule: alert when the least-squares slope over the last
+ *   WX_HISTORY readings reaches `ratePerMin`; re-arm below half of it
+ * - A NaN reading is skipped: it neither alerts nor re-arms
+ */
+
+#include "weather_rule.h"
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static const uint8_t RATE_MIN_SAMPLES = 3;  // Fewer points give no slope
+
+void WeatherRule::reset(WeatherState &st) {
+  memset(&st, 0, sizeof(st));
+}
+
+/*
+ * Least-squares slope of the history, per minute
+ * 
+ * @return slope, or NaN with fewer than RATE_MIN_SAMPLES readings or
+ *         no time spread
+ */
+float WeatherRule::ratePerMin(const WeatherChannel &c) {
+  if (c.histCount < RATE_MIN_SAMPLES) return NAN;
+  // Oldest entry is the time origin, so minutes stay small
+  uint8_t oldest = (uint8_t)((c.histNext + WX_HISTORY - c.histCount) % WX_HISTORY);
+  uint32_t t0 = c.histMs[oldest];
+  float sumT = 0, sumV = 0, sumTT = 0, sumTV = 0;
+  for (uint8_t i = 0; i < c.histCount; i++) {
+    uint8_t k = (uint8_t)((oldest + i) % WX_HISTORY);
+    float t = (c.histMs[k] - t0) / 60000.0f;
+    sumT += t;
+    sumV += c.hist[k];
+    sumTT += t * t;
+    sumTV += t * c.hist[k];
+  }
+  float n = c.histCount;
+  float denom = n * sumTT - sumT * sumT;
+  if (denom <= 0) return NAN;
+  return (n * sumTV - sumT * sumV) / denom;
+}
+
+/*
+ * Run both rules for one quantity
+ * 
+ * @return highFlag and/or risingFlag for alerts that should be sent now
+ */
+static uint8_t step(WeatherChannel &c, float value, const WeatherLimit &lim, uint32_t now,
+                    uint8_t highFlag, uint8_t risingFlag) {
+  if (isnan(value)) return WX_NONE;  // Failed reading: keep all state
+  uint8_t alerts = WX_NONE;
+  
+  // === Level with dwell and hysteresis ===
+  if (value > lim.high) {
+    if (!c.above) {
+      c.above = true;
+      c.aboveSinceMs = now;
+    }
+    if (!c.alerted && now - c.aboveSinceMs >= lim.dwellMs) {
+      c.alerted = true;
+      alerts |= highFlag;
+    }
+  } else {
+    c.above = false;  // Dwell restarts on the next stretch above high
+    if (value <= lim.high - lim.hysteresis) c.alerted = false;
+  }
+  
+  // === Rate of change ===
+  c.hist[c.histNext] = value;
+  c.histMs[c.histNext] = now;
+  c.histNext = (uint8_t)((c.histNext + 1) % WX_HISTORY);
+  if (c.histCount < WX_HISTORY) c.histCount++;
+  if (lim.ratePerMin > 0) {
+    float rate = WeatherRule::ratePerMin(c);
+    if (!isnan(rate)) {
+      if (!c.rising && rate >= lim.ratePerMin) {
+        c.rising = true;
+        alerts |= risingFlag;
+      } else if (c.rising && rate < lim.ratePerMin / 2) {
+        c.rising = false;
+      }
+    }
+  }
+  return alerts;
+}
+
+/*
+ * Evaluate a reading against the temperature and humidity rules
+ * 
+ * @param st: Rule state, persisted by the caller between readings
+ * @param d: Sensor reading
+ * @param cfg: Current limits
+ * @param nowMs: millis() of the reading
+ * @return WeatherAlert flags for alerts that should be sent now
+ */
+uint8_t WeatherRule::evaluate(WeatherState &st, const SensorData &d, const WeatherConfig &cfg, uint32_t nowMs) {
+  return step(st.temp, d.temp, cfg.temp, nowMs, WX_HIGH_TEMP, WX_TEMP_RISING) |
+         step(st.hum, d.hum, cfg.hum, nowMs, WX_HIGH_HUM, WX_HUM_RISING);
+}
+
+/*
+ * Apply a runtime configuration command
+ * 
+ * Command: "key=value" pairs separated by spaces, commas or semicolons.
+ * Keys: temp_high, temp_hyst, temp_dwell (s), temp_rate (C/min) and
+ * the same for hum_. Nothing is changed unless every pair parses and
+ * is in range.
+ * 
+ * @return number of keys applied, -1 if the command was rejected
+ */
+int WeatherRule::apply(WeatherConfig &cfg, const char *command) {
+  WeatherConfig next = cfg;
+  int applied = 0;
+  const char *p = command;
+  for (;;) {
+    while (*p == ' ' || *p == ',' || *p == ';' || *p == '\n' || *p == '\r') p++;
+    if (*p == '\0') break;
+    
+    const char *eq = strchr(p, '=');
+    if (!eq || eq == p || eq - p > 15) return -1;
+    char key[16];
+    memcpy(key, p, eq - p);
+    key[eq - p] = '\0';
+    char *end;
+    float v = strtof(eq + 1, &end);
+    if (end == eq + 1 || isnan(v)) return -1;
+    p = end;
+    if (*p != '\0' && *p != ' ' && *p != ',' && *p != ';' && *p != '\n' && *p != '\r') return -1;
+    
+    WeatherLimit *lim;
+    const char *field;
+    if (strncmp(key, "temp_", 5) == 0) {
+      lim = &next.temp;
+      field = key + 5;
+    } else if (strncmp(key, "hum_", 4) == 0) {
+      lim = &next.hum;
+      field = key + 4;
+    } else {
+      return -1;
+    }
+    if (strcmp(field, "high") == 0 && v > -40 && v <= 100) lim->high = v;
+    else if (strcmp(field, "hyst") == 0 && v >= 0 && v <= 20) lim->hysteresis = v;
+    else if (strcmp(field, "dwell") == 0 && v >= 0 && v <= 86400) lim->dwellMs = (uint32_t)(v * 1000);
+    else if (strcmp(field, "rate") == 0 && v >= 0 && v <= 100) lim->ratePerMin = v;
+    else return -1;
+    applied++;
+  }
+  if (applied == 0) return -1;
+  cfg = next;
+  return applied;
+}
+
+/*
+ * Current limits in the apply() syntax, e.g. for the log
+ */
+size_t WeatherRule::describe(const WeatherConfig &cfg, char *buf, size_t cap) {
+  int n = snprintf(buf, cap, "temp_high=%.1f temp_hyst=%.1f temp_dwell=%u temp_rate=%.2f "
+                   "hum_high=%.1f hum_hyst=%.1f hum_dwell=%u hum_rate=%.2f",
+                   cfg.temp.high, cfg.temp.hysteresis, (unsigned)(cfg.temp.dwellMs / 1000), cfg.temp.ratePerMin,
+                   cfg.hum.high, cfg.hum.hysteresis, (unsigned)(cfg.hum.dwellMs / 1000), cfg.hum.ratePerMin);
+  return n < 0 ? 0 : min((size_t)n, cap ? cap - 1 : 0);
+}
@@ -0,0 +1,27 @@
+#pragma once
+// Host stand-in for the Arduino core ([env:native] only)
+// Just enough for the pure-logic modules and their tests.
+#include <stdint.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <algorithm>
+#include <chrono>
+#include <thread>
+#include "freertos/FreeRTOS.h"
+
+inline unsigned long micros() {
+  using namespace std::chrono;
+  return (unsigned long)duration_cast<microseconds>(steady_clock::now().time_since_epoch()).count();
+}
+inline unsigned long millis() { return micros() / 1000; }
+inline void delay(unsigned long ms) { std::this_thread::sleep_for(std::chrono::milliseconds(ms)); }
+
+#ifndef IRAM_ATTR
+#define IRAM_ATTR
+#endif
+
+using std::min;
+using std::max;
@@ -0,0 +1,19 @@
+#pragma once
+// Host stand-in for the FreeRTOS types used in shared headers ([env:native] only)
+// Tests are single-threaded, so critical sections compile to nothing.
+#include <stdint.h>
+
+typedef uint32_t TickType_t;
+typedef void *TaskHandle_t;
+typedef void *QueueHandle_t;
+typedef void *SemaphoreHandle_t;
+typedef int BaseType_t;
+typedef struct { int unused; } portMUX_TYPE;
+
+#define portMAX_DELAY          0xFFFFFFFFu
+#define portMUX_INITIALIZER_UNLOCKED {0}
+#define portENTER_CRITICAL(m)  ((void)(m))
+#define portEXIT_CRITICAL(m)   ((void)(m))
+#define pdMS_TO_TICKS(ms)      ((TickType_t)(ms))
+#define pdTRUE  1
+#define pdFALSE 0
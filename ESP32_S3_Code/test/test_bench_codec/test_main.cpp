@@ -0,0 +1,131 @@
+/*
+ * Host microbenchmarks for the string/encoding paths
+ * 
+ * Prints throughput and heap allocations per call for each pure
+ * helper, and fails if any of them starts allocating (they must
+ * stay on caller buffers to be safe on the ESP32 alert path).
+ * 
+ * Run: pio test -e native -f test_bench_codec -v
+ * Profile: the built program is .pio/build/native/program, e.g.
+ *   perf record .pio/build/native/program
+ */
+
+#include <unity.h>
+#include <chrono>
+#include <new>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "http_codec.h"
+#include "weather_rule.h"
+
+#ifndef BENCH_ROUNDS
+#define BENCH_ROUNDS 200000
+#endif
+
+// ---- Allocation counting ----
+static size_t allocCount = 0;
+
+void *operator new(size_t n) {
+  allocCount++;
+  if (void *p = malloc(n ? n : 1)) return p;
+  throw std::bad_alloc();
+}
+void operator delete(void *p) noexcept { free(p); }
+void operator delete(void *p, size_t) noexcept { free(p); }
+
+// Keeps the optimizer from discarding benchmarked results
+static volatile size_t sink;
+
+struct BenchResult {
+  double nsPerOp;
+  double allocsPerOp;
+};
+
+/*
+ * Time `rounds` calls of fn and count allocations made meanwhile
+ */
+template <typename Fn>
+static BenchResult run(const char *name, size_t bytesPerOp, Fn fn) {
+  for (int i = 0; i < 1000; i++) fn();  // Warm caches
+  
+  size_t allocsBefore = allocCount;
+  auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < BENCH_ROUNDS; i++) fn();
+  auto end = std::chrono::steady_clock::now();
+  
+  BenchResult r;
+  r.nsPerOp = std::chrono::duration<double, std::nano>(end - start).count() / BENCH_ROUNDS;
+  r.allocsPerOp = (double)(allocCount - allocsBefore) / BENCH_ROUNDS;
+  if (bytesPerOp) {
+    printf("BENCH %-22s %8.1f ns/op %8.1f MB/s %5.2f allocs/op\n", name, r.nsPerOp,
+           bytesPerOp / r.nsPerOp * 1000.0, r.allocsPerOp);
+  } else {
+    printf("BENCH %-22s %8.1f ns/op %19s %5.2f allocs/op\n", name, r.nsPerOp, "", r.allocsPerOp);
+  }
+  return r;
+}
+
+static const char CAPTION[] = "⚠️ HIGH TEMPERATURE ALERT: 35.2°C (Limit: 34.00°C)";
+static const char PHOTO_URL[] = "http://10.28.158.71:80/jpg?ago=1200&size=VGA&q=12";
+
+void setUp() {}
+void tearDown() {}
+
+static void bench_urlEncode_caption() {
+  char out[256];
+  BenchResult r = run("urlEncode(caption)", strlen(CAPTION), [&] {
+    sink = HttpCodec::urlEncode(CAPTION, out, sizeof(out));
+  });
+  TEST_ASSERT_EQUAL_FLOAT(0.0, r.allocsPerOp);
+}
+
+static void bench_urlEncode_url() {
+  char out[256];
+  BenchResult r = run("urlEncode(url)", strlen(PHOTO_URL), [&] {
+    sink = HttpCodec::urlEncode(PHOTO_URL, out, sizeof(out));
+  });
+  TEST_ASSERT_EQUAL_FLOAT(0.0, r.allocsPerOp);
+}
+
+static void bench_isPrivateHttpUrl() {
+  BenchResult r = run("isPrivateHttpUrl", 0, [&] {
+    sink = HttpCodec::isPrivateHttpUrl(PHOTO_URL);
+  });
+  TEST_ASSERT_EQUAL_FLOAT(0.0, r.allocsPerOp);
+}
+
+static void bench_multipart_envelope() {
+  char boundary[32], pre[512], post[48];
+  unsigned long seed = 0;
+  BenchResult r = run("multipart envelope", 0, [&] {
+    HttpCodec::multipartBoundary(seed++, boundary, sizeof(boundary));
+    size_t n = HttpCodec::multipartPreamble(boundary, "1111111111", CAPTION, 0, pre, sizeof(pre));
+    sink = n + HttpCodec::multipartTrailer(boundary, post, sizeof(post));
+  });
+  TEST_ASSERT_EQUAL_FLOAT(0.0, r.allocsPerOp);
+}
+
+static void bench_weather_evaluate() {
+  WeatherState st;
+  WeatherRule::reset(st);
+  WeatherConfig cfg = { { 34.0f, 1.0f, 0, 0.5f }, { 90.0f, 5.0f, 0, 0 } };
+  SensorData d = {33.5f, 89.0f, 0};
+  uint32_t nowMs = 0;
+  BenchResult r = run("WeatherRule::evaluate", 0, [&] {
+    d.temp += 0.02f;  // Walk across the limit and back
+    if (d.temp > 35.0f) d.temp = 33.0f;
+    sink = WeatherRule::evaluate(st, d, cfg, nowMs += 10000);
+  });
+  TEST_ASSERT_EQUAL_FLOAT(0.0, r.allocsPerOp);
+}
+
+int main() {
+  UNITY_BEGIN();
+  RUN_TEST(bench_urlEncode_caption);
+  RUN_TEST(bench_urlEncode_url);
+  RUN_TEST(bench_isPrivateHttpUrl);
+  RUN_TEST(bench_multipart_envelope);
+  RUN_TEST(bench_weather_evaluate);
+  return UNITY_END();
+}
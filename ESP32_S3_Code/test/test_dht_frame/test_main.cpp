@@ -0,0 +1,88 @@
+/*
+ * Unit tests for DhtFrame (DHT22 reply decoding from pulse widths)
+ * 
+ * Run: pio test -e native -f test_dht_frame
+ */
+
+#include <unity.h>
+#include "dht_frame.h"
+
+static uint16_t pulses[48];
+static size_t pulseCount;
+
+void setUp() { pulseCount = 0; }
+void tearDown() {}
+
+// Append the pulses for bytes b[0..4] as the sensor would send them
+static void frame(const uint8_t b[5]) {
+  for (int i = 0; i < 40; i++) {
+    pulses[pulseCount++] = (b[i / 8] >> (7 - i % 8)) & 1 ? 70 : 26;
+  }
+}
+
+static void frameOf(uint16_t hum10, uint16_t tempRaw) {
+  uint8_t b[5] = { (uint8_t)(hum10 >> 8), (uint8_t)hum10, (uint8_t)(tempRaw >> 8), (uint8_t)tempRaw, 0 };
+  b[4] = (uint8_t)(b[0] + b[1] + b[2] + b[3]);
+  frame(b);
+}
+
+static void test_decodes_datasheet_example() {
+  frameOf(652, 351);  // 65.2 %RH, 35.1 C
+  float t = 0, h = 0;
+  TEST_ASSERT_EQUAL(DHT_OK, DhtFrame::decode(pulses, pulseCount, t, h));
+  TEST_ASSERT_FLOAT_WITHIN(0.01f, 35.1f, t);
+  TEST_ASSERT_FLOAT_WITHIN(0.01f, 65.2f, h);
+}
+
+static void test_negative_temperature_is_sign_magnitude() {
+  frameOf(500, 0x8000 | 101);  // -10.1 C
+  float t = 0, h = 0;
+  TEST_ASSERT_EQUAL(DHT_OK, DhtFrame::decode(pulses, pulseCount, t, h));
+  TEST_ASSERT_FLOAT_WITHIN(0.01f, -10.1f, t);
+}
+
+static void test_leading_pulses_are_skipped() {
+  pulses[pulseCount++] = 30;  // Line release
+  pulses[pulseCount++] = 80;  // Sensor response
+  frameOf(400, 250);
+  float t = 0, h = 0;
+  TEST_ASSERT_EQUAL(DHT_OK, DhtFrame::decode(pulses, pulseCount, t, h));
+  TEST_ASSERT_FLOAT_WITHIN(0.01f, 25.0f, t);
+  TEST_ASSERT_FLOAT_WITHIN(0.01f, 40.0f, h);
+}
+
+static void test_short_frame_is_no_response() {
+  frameOf(400, 250);
+  float t = 1, h = 2;
+  TEST_ASSERT_EQUAL(DHT_NO_RESPONSE, DhtFrame::decode(pulses, 39, t, h));
+  TEST_ASSERT_EQUAL(DHT_NO_RESPONSE, DhtFrame::decode(pulses, 0, t, h));
+  TEST_ASSERT_EQUAL_FLOAT(1, t);  // Outputs untouched on failure
+  TEST_ASSERT_EQUAL_FLOAT(2, h);
+}
+
+static void test_bit_error_fails_checksum() {
+  frameOf(400, 250);
+  pulses[20] = pulses[20] > DHT_BIT_ONE_US ? 26 : 70;  // Flip one temperature bit
+  float t, h;
+  TEST_ASSERT_EQUAL(DHT_CHECKSUM, DhtFrame::decode(pulses, pulseCount, t, h));
+}
+
+static void test_out_of_range_rejected() {
+  frameOf(1200, 250);  // 120 %RH
+  float t, h;
+  TEST_ASSERT_EQUAL(DHT_RANGE, DhtFrame::decode(pulses, pulseCount, t, h));
+  pulseCount = 0;
+  frameOf(400, 900);   // 90 C
+  TEST_ASSERT_EQUAL(DHT_RANGE, DhtFrame::decode(pulses, pulseCount, t, h));
+}
+
+int main() {
+  UNITY_BEGIN();
+  RUN_TEST(test_decodes_datasheet_example);
+  RUN_TEST(test_negative_temperature_is_sign_magnitude);
+  RUN_TEST(test_leading_pulses_are_skipped);
+  RUN_TEST(test_short_frame_is_no_response);
+  RUN_TEST(test_bit_error_fails_checksum);
+  RUN_TEST(test_out_of_range_rejected);
+  return UNITY_END();
+}
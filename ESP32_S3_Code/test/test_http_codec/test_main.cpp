@@ -0,0 +1,198 @@
+/*
+ * Unit tests for HttpCodec (URL encoding, private URL detection,
+ * multipart envelope)
+ * 
+ * Run: pio test -e native -f test_http_codec
+ */
+
+#include <unity.h>
+#include <string.h>
+#include "http_codec.h"
+
+void setUp() {}
+void tearDown() {}
+
+// ---- urlEncode ----
+
+static void test_urlEncode_passes_safe_characters() {
+  char out[32];
+  TEST_ASSERT_EQUAL(14, HttpCodec::urlEncode("Az09-_.~Motion", out, sizeof(out)));
+  TEST_ASSERT_EQUAL_STRING("Az09-_.~Motion", out);
+}
+
+static void test_urlEncode_space_and_reserved() {
+  char out[64];
+  size_t n = HttpCodec::urlEncode("a b&c=d/e?", out, sizeof(out));
+  TEST_ASSERT_EQUAL_STRING("a+b%26c%3Dd%2Fe%3F", out);
+  TEST_ASSERT_EQUAL(strlen(out), n);
+}
+
+static void test_urlEncode_utf8_bytes() {
+  char out[32];
+  HttpCodec::urlEncode("°C", out, sizeof(out));  // C2 B0 43
+  TEST_ASSERT_EQUAL_STRING("%C2%B0C", out);
+}
+
+static void test_urlEncode_truncates_on_character_boundary() {
+  char out[6];
+  size_t n = HttpCodec::urlEncode("ab&cd", out, sizeof(out));  // "ab%26" needs 6 with NUL
+  TEST_ASSERT_EQUAL_STRING("ab%26", out);
+  TEST_ASSERT_EQUAL(5, n);
+  
+  char tight[5];
+  n = HttpCodec::urlEncode("ab&cd", tight, sizeof(tight));  // "%26" would not fit
+  TEST_ASSERT_EQUAL_STRING("ab", tight);
+  TEST_ASSERT_EQUAL(2, n);
+}
+
+static void test_urlEncode_empty_and_zero_cap() {
+  char out[4] = "xyz";
+  TEST_ASSERT_EQUAL(0, HttpCodec::urlEncode("", out, sizeof(out)));
+  TEST_ASSERT_EQUAL_STRING("", out);
+  
+  char untouched[2] = {'q', 0};
+  TEST_ASSERT_EQUAL(0, HttpCodec::urlEncode("abc", untouched, 0));
+  TEST_ASSERT_EQUAL('q', untouched[0]);
+}
+
+static void test_hexEncode() {
+  const unsigned char bytes[] = {0x00, 0x7f, 0xa5, 0xff};
+  char out[9];
+  TEST_ASSERT_EQUAL(8, HttpCodec::hexEncode(bytes, sizeof(bytes), out, sizeof(out)));
+  TEST_ASSERT_EQUAL_STRING("007fa5ff", out);
+  TEST_ASSERT_EQUAL(0, HttpCodec::hexEncode(bytes, sizeof(bytes), out, 8));  // No room for NUL
+}
+
+// ---- isPrivateHttpUrl ----
+
+static void test_private_ranges() {
+  TEST_ASSERT_TRUE(HttpCodec::isPrivateHttpUrl("http://10.28.158.71/jpg"));
+  TEST_ASSERT_TRUE(HttpCodec::isPrivateHttpUrl("http://192.168.1.5:80/jpg"));
+  TEST_ASSERT_TRUE(HttpCodec::isPrivateHttpUrl("https://127.0.0.1/"));
+  TEST_ASSERT_TRUE(HttpCodec::isPrivateHttpUrl("http://172.16.0.1/"));
+  TEST_ASSERT_TRUE(HttpCodec::isPrivateHttpUrl("http://172.31.255.255/"));
+}
+
+static void test_public_and_malformed() {
+  TEST_ASSERT_FALSE(HttpCodec::isPrivateHttpUrl("http://172.15.0.1/"));
+  TEST_ASSERT_FALSE(HttpCodec::isPrivateHttpUrl("http://172.32.0.1/"));
+  TEST_ASSERT_FALSE(HttpCodec::isPrivateHttpUrl("https://via.placeholder.com/640x480.jpg"));
+  TEST_ASSERT_FALSE(HttpCodec::isPrivateHttpUrl("ftp://10.0.0.1/"));
+  TEST_ASSERT_FALSE(HttpCodec::isPrivateHttpUrl("10.0.0.1/jpg"));
+  TEST_ASSERT_FALSE(HttpCodec::isPrivateHttpUrl(""));
+}
+
+// ---- multipart envelope ----
+
+static void test_multipart_envelope() {
+  char boundary[32], pre[512], post[48];
+  TEST_ASSERT_EQUAL(strlen("----ESP32Boundary1234"), HttpCodec::multipartBoundary(1234, boundary, sizeof(boundary)));
+  TEST_ASSERT_EQUAL_STRING("----ESP32Boundary1234", boundary);
+  
+  size_t preLen = HttpCodec::multipartPreamble(boundary, "42", "Motion detected", 0, pre, sizeof(pre));
+  TEST_ASSERT_EQUAL(strlen(pre), preLen);
+  TEST_ASSERT_EQUAL_STRING(
+    "------ESP32Boundary1234\r\n"
+    "Content-Disposition: form-data; name=\"chat_id\"\r\n\r\n42\r\n"
+    "------ESP32Boundary1234\r\n"
+    "Content-Disposition: form-data; name=\"caption\"\r\n\r\nMotion detected\r\n"
+    "------ESP32Boundary1234\r\n"
+    "Content-Disposition: form-data; name=\"photo\"; filename=\"image.jpg\"\r\n"
+    "Content-Type: image/jpeg\r\n\r\n", pre);
+  
+  size_t postLen = HttpCodec::multipartTrailer(boundary, post, sizeof(post));
+  TEST_ASSERT_EQUAL_STRING("\r\n------ESP32Boundary1234--\r\n", post);
+  TEST_ASSERT_EQUAL(strlen(post), postLen);
+}
+
+static void test_multipart_reply_part_comes_first() {
+  char pre[512];
+  size_t n = HttpCodec::multipartPreamble("B", "42", "Photo", 1234, pre, sizeof(pre));
+  TEST_ASSERT_EQUAL(strlen(pre), n);
+  const char *head = "--B\r\nContent-Disposition: form-data; name=\"reply_to_message_id\"\r\n\r\n1234\r\n"
+                     "--B\r\nContent-Disposition: form-data; name=\"chat_id\"";
+  TEST_ASSERT_EQUAL(0, strncmp(pre, head, strlen(head)));
+}
+
+// ---- splitHttpUrl ----
+
+static void test_splitHttpUrl() {
+  char host[32];
+  unsigned port;
+  const char *path;
+  TEST_ASSERT_TRUE(HttpCodec::splitHttpUrl("http://10.28.158.71/frame?id=7", host, sizeof(host), &port, &path));
+  TEST_ASSERT_EQUAL_STRING("10.28.158.71", host);
+  TEST_ASSERT_EQUAL(80, port);
+  TEST_ASSERT_EQUAL_STRING("/frame?id=7", path);
+  
+  TEST_ASSERT_TRUE(HttpCodec::splitHttpUrl("http://cam.local:8080", host, sizeof(host), &port, &path));
+  TEST_ASSERT_EQUAL_STRING("cam.local", host);
+  TEST_ASSERT_EQUAL(8080, port);
+  TEST_ASSERT_EQUAL_STRING("/", path);
+}
+
+static void test_splitHttpUrl_rejects() {
+  char host[8];
+  unsigned port;
+  const char *path;
+  TEST_ASSERT_FALSE(HttpCodec::splitHttpUrl("https://10.0.0.1/", host, sizeof(host), &port, &path));
+  TEST_ASSERT_FALSE(HttpCodec::splitHttpUrl("http:///jpg", host, sizeof(host), &port, &path));
+  TEST_ASSERT_FALSE(HttpCodec::splitHttpUrl("http://10.0.0.1:/jpg", host, sizeof(host), &port, &path));
+  TEST_ASSERT_FALSE(HttpCodec::splitHttpUrl("http://10.0.0.1:99999/", host, sizeof(host), &port, &path));
+  TEST_ASSERT_FALSE(HttpCodec::splitHttpUrl("http://verylonghost/", host, sizeof(host), &port, &path));
+}
+
+static void test_multipart_overflow_reports_zero() {
+  char pre[64], post[8];
+  TEST_ASSERT_EQUAL(0, HttpCodec::multipartPreamble("b", "42", "caption", 0, pre, sizeof(pre)));
+  TEST_ASSERT_EQUAL(0, HttpCodec::multipartPreamble("b", "42", "", 7, pre, sizeof(pre)));
+  TEST_ASSERT_EQUAL(0, HttpCodec::multipartTrailer("----ESP32Boundary1", post, sizeof(post)));
+}
+
+// ---- sendMediaGroup parts ----
+
+static void test_multipart_media_group_parts() {
+  char out[160];
+  size_t n = HttpCodec::multipartField("B", "media", "[]", out, sizeof(out));
+  TEST_ASSERT_EQUAL_STRING("--B\r\nContent-Disposition: form-data; name=\"media\"\r\n\r\n[]\r\n", out);
+  TEST_ASSERT_EQUAL(strlen(out), n);
+  
+  n = HttpCodec::multipartFileHeader("B", "p1", true, out, sizeof(out));
+  TEST_ASSERT_EQUAL_STRING(
+    "\r\n--B\r\n"
+    "Content-Disposition: form-data; name=\"p1\"; filename=\"p1.jpg\"\r\n"
+    "Content-Type: image/jpeg\r\n\r\n", out);
+  TEST_ASSERT_EQUAL(strlen(out), n);
+  TEST_ASSERT_EQUAL(n - 2, HttpCodec::multipartFileHeader("B", "p1", false, out, sizeof(out)));
+  TEST_ASSERT_EQUAL(0, HttpCodec::multipartFileHeader("B", "p1", false, out, 16));
+}
+
+static void test_jsonEscape() {
+  char out[32];
+  TEST_ASSERT_EQUAL(16, HttpCodec::jsonEscape("a\"b\\c\nd\x01", out, sizeof(out)));
+  TEST_ASSERT_EQUAL_STRING("a\\\"b\\\\c\\nd\\u0001", out);
+  
+  char tight[4];
+  TEST_ASSERT_EQUAL(2, HttpCodec::jsonEscape("ab\"", tight, sizeof(tight)));  // \" would not fit
+  TEST_ASSERT_EQUAL_STRING("ab", tight);
+}
+
+int main() {
+  UNITY_BEGIN();
+  RUN_TEST(test_urlEncode_passes_safe_characters);
+  RUN_TEST(test_urlEncode_space_and_reserved);
+  RUN_TEST(test_urlEncode_utf8_bytes);
+  RUN_TEST(test_urlEncode_truncates_on_character_boundary);
+  RUN_TEST(test_urlEncode_empty_and_zero_cap);
+  RUN_TEST(test_hexEncode);
+  RUN_TEST(test_private_ranges);
+  RUN_TEST(test_public_and_malformed);
+  RUN_TEST(test_multipart_envelope);
+  RUN_TEST(test_multipart_reply_part_comes_first);
+  RUN_TEST(test_multipart_overflow_reports_zero);
+  RUN_TEST(test_splitHttpUrl);
+  RUN_TEST(test_splitHttpUrl_rejects);
+  RUN_TEST(test_multipart_media_group_parts);
+  RUN_TEST(test_jsonEscape);
+  return UNITY_END();
+}
@@ -0,0 +1,81 @@
+/*
+ * Unit tests for Digest (motion events aggregated during the cooldown)
+ * 
+ * Run: pio test -e native -f test_motion_digest
+ */
+
+#include <unity.h>
+#include "motion_digest.h"
+
+static MotionDigest d;
+static char text[128];
+
+void setUp() {
+  Digest::open(d, 100000);  // Alert at t = 100 s opened the window
+}
+void tearDown() {}
+
+static void test_counts_events_and_edges() {
+  Digest::add(d, 104000, 1, "");
+  Digest::add(d, 109500, 3, nullptr);
+  TEST_ASSERT_EQUAL_UINT32(2, d.events);
+  TEST_ASSERT_EQUAL_UINT32(4, d.edges);
+  TEST_ASSERT_EQUAL_INT(0, Digest::photoCount(d));
+  Digest::describe(d, text, sizeof(text));
+  TEST_ASSERT_EQUAL_STRING("2 more motion events (4 PIR edges)\n+4s +9s", text);
+}
+
+static void test_single_event_with_photo() {
+  Digest::add(d, 112000, 1, "http://cam/frame?id=7");
+  Digest::describe(d, text, sizeof(text));
+  TEST_ASSERT_EQUAL_STRING("1 more motion event, 1 photo\n+12s", text);
+  TEST_ASSERT_EQUAL_STRING("http://cam/frame?id=7", Digest::photo(d, 0));
+  TEST_ASSERT_EQUAL_STRING("", Digest::photo(d, 1));
+}
+
+static void test_newest_photos_win() {
+  char url[DIGEST_URL_LEN];
+  for (int i = 1; i <= 5; i++) {
+    snprintf(url, sizeof(url), "http://cam/frame?id=%d", i);
+    Digest::add(d, 100000 + i * 5000, 1, url);
+  }
+  TEST_ASSERT_EQUAL_INT(DIGEST_MAX_PHOTOS, Digest::photoCount(d));
+  TEST_ASSERT_EQUAL_STRING("http://cam/frame?id=3", Digest::photo(d, 0));  // Oldest kept first
+  TEST_ASSERT_EQUAL_STRING("http://cam/frame?id=5", Digest::photo(d, 2));
+}
+
+static void test_ring_keeps_newest_times() {
+  for (int i = 1; i <= DIGEST_MAX_EVENTS + 2; i++) Digest::add(d, 100000 + i * 1000, 1, "");
+  TEST_ASSERT_EQUAL_UINT32(DIGEST_MAX_EVENTS + 2, d.events);
+  Digest::describe(d, text, sizeof(text));
+  // The two oldest times are counted but no longer listed
+  TEST_ASSERT_EQUAL_STRING("18 more motion events\n… +3s +4s +5s +6s +7s +8s +9s +10s +11s +12s +13s +14s +15s +16s +17s +18s", text);
+}
+
+static void test_describe_truncates_with_ellipsis() {
+  for (int i = 1; i <= 10; i++) Digest::add(d, 100000 + i * 6000, 1, "");
+  char small[40];
+  size_t len = Digest::describe(d, small, sizeof(small));
+  TEST_ASSERT_EQUAL_STRING("10 more motion events\n+6s +12s +18s …", small);
+  TEST_ASSERT_EQUAL_UINT32(strlen(small), len);
+  TEST_ASSERT_TRUE(len < sizeof(small));
+}
+
+static void test_open_resets() {
+  Digest::add(d, 101000, 2, "http://cam/frame?id=1");
+  Digest::open(d, 200000);
+  TEST_ASSERT_EQUAL_UINT32(0, d.events);
+  TEST_ASSERT_EQUAL_INT(0, Digest::photoCount(d));
+  TEST_ASSERT_EQUAL_UINT32(200000, d.windowStartMs);
+}
+
+int main() {
+  UNITY_BEGIN();
+  RUN_TEST(test_counts_events_and_edges);
+  RUN_TEST(test_single_event_with_photo);
+  RUN_TEST(test_newest_photos_win);
+  RUN_TEST(test_ring_keeps_newest_times);
+  RUN_TEST(test_describe_truncates_with_ellipsis);
+  RUN_TEST(test_open_resets);
+  return UNITY_END();
+}
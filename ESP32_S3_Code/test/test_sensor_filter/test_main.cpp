@@ -0,0 +1,85 @@
+/*
+ * Unit tests for Filter (median + EMA reading filter, publish deadband)
+ * 
+ * Run: pio test -e native -f test_sensor_filter
+ */
+
+#include <unity.h>
+#include <math.h>
+#include "sensor_filter.h"
+
+static SensorFilter f;
+static PublishGate g;
+
+void setUp() {
+  Filter::init(f, 5, 1.0f, 3);  // alpha 1: output is the plain median
+  Filter::initGate(g, 0.5f, 60000);
+}
+void tearDown() {}
+
+static void test_nan_until_first_sample() {
+  TEST_ASSERT_TRUE(isnan(f.value));
+  TEST_ASSERT_TRUE(isnan(Filter::push(f, NAN)));
+  TEST_ASSERT_EQUAL_FLOAT(21.0f, Filter::push(f, 21.0f));
+}
+
+static void test_median_rejects_single_spike() {
+  Filter::push(f, 20.0f);
+  Filter::push(f, 20.2f);
+  TEST_ASSERT_FLOAT_WITHIN(0.01f, 20.2f, Filter::push(f, 85.0f));  // Median of 3
+  TEST_ASSERT_FLOAT_WITHIN(0.01f, 20.3f, Filter::push(f, 20.4f));  // Even count: mean of middle two
+  TEST_ASSERT_FLOAT_WITHIN(0.01f, 20.4f, Filter::push(f, 20.6f));
+}
+
+static void test_window_slides() {
+  for (int i = 0; i < 5; i++) Filter::push(f, 10.0f);
+  for (int i = 0; i < 2; i++) Filter::push(f, 30.0f);
+  TEST_ASSERT_EQUAL_FLOAT(10.0f, f.value);  // 3 of 5 still old
+  Filter::push(f, 30.0f);
+  TEST_ASSERT_EQUAL_FLOAT(30.0f, f.value);
+}
+
+static void test_ema_smooths_steps() {
+  Filter::init(f, 1, 0.5f, 3);
+  Filter::push(f, 10.0f);
+  TEST_ASSERT_EQUAL_FLOAT(15.0f, Filter::push(f, 20.0f));
+  TEST_ASSERT_EQUAL_FLOAT(17.5f, Filter::push(f, 20.0f));
+}
+
+static void test_misses_hold_then_go_nan() {
+  Filter::push(f, 25.0f);
+  TEST_ASSERT_EQUAL_FLOAT(25.0f, Filter::push(f, NAN));  // One failed read: hold
+  TEST_ASSERT_EQUAL_FLOAT(25.0f, Filter::push(f, NAN));
+  TEST_ASSERT_TRUE(isnan(Filter::push(f, NAN)));         // Third in a row: stale
+  TEST_ASSERT_EQUAL_FLOAT(30.0f, Filter::push(f, 30.0f)); // Fresh start, no old samples
+  TEST_ASSERT_EQUAL(1, f.count);
+}
+
+static void test_gate_first_value_and_deadband() {
+  TEST_ASSERT_FALSE(Filter::due(g, NAN, 0));
+  TEST_ASSERT_TRUE(Filter::due(g, 20.0f, 0));
+  Filter::mark(g, 20.0f, 0);
+  TEST_ASSERT_FALSE(Filter::due(g, 20.4f, 1000));
+  TEST_ASSERT_TRUE(Filter::due(g, 20.5f, 1000));
+  TEST_ASSERT_TRUE(Filter::due(g, 19.5f, 1000));
+}
+
+static void test_gate_heartbeat() {
+  Filter::mark(g, 20.0f, 1000);
+  TEST_ASSERT_FALSE(Filter::due(g, 20.0f, 60999));
+  TEST_ASSERT_TRUE(Filter::due(g, 20.0f, 61000));
+  Filter::mark(g, NAN, 61000);  // NaN does not count as published
+  TEST_ASSERT_TRUE(Filter::due(g, 20.0f, 61000));
+}
+
+int main() {
+  UNITY_BEGIN();
+  RUN_TEST(test_nan_until_first_sample);
+  RUN_TEST(test_median_rejects_single_spike);
+  RUN_TEST(test_window_slides);
+  RUN_TEST(test_ema_smooths_steps);
+  RUN_TEST(test_misses_hold_then_go_nan);
+  RUN_TEST(test_gate_first_value_and_deadband);
+  RUN_TEST(test_gate_heartbeat);
+  return UNITY_END();
+}
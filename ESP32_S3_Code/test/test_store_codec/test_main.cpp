@@ -0,0 +1,95 @@
+/*
+ * Unit tests for StoreCodec (delta-encoded spool blocks)
+ * 
+ * Run: pio test -e native -f test_store_codec
+ */
+
+#include <unity.h>
+#include "store_codec.h"
+
+static StoreRecord recs[48];
+static StoreRecord back[48];
+static uint8_t buf[STORE_BLOCK_BYTES(48) + 8];
+
+static StoreRecord env(uint32_t epoch, int16_t temp10, uint16_t hum10) {
+  StoreRecord r = { epoch, STORE_ENV, 0, temp10, hum10 };
+  return r;
+}
+
+static StoreRecord alert(uint32_t epoch, uint8_t reason) {
+  StoreRecord r = { epoch, STORE_ALERT, reason, STORE_NAN_TEMP, STORE_NAN_HUM };
+  return r;
+}
+
+static void assertSame(const StoreRecord *a, const StoreRecord *b, int n) {
+  for (int i = 0; i < n; i++) {
+    TEST_ASSERT_EQUAL_UINT32(a[i].epoch, b[i].epoch);
+    TEST_ASSERT_EQUAL(a[i].kind, b[i].kind);
+    TEST_ASSERT_EQUAL(a[i].reason, b[i].reason);
+    TEST_ASSERT_EQUAL(a[i].temp10, b[i].temp10);
+    TEST_ASSERT_EQUAL(a[i].hum10, b[i].hum10);
+  }
+}
+
+void setUp() {
+  memset(buf, 0xAA, sizeof(buf));
+  memset(back, 0, sizeof(back));
+}
+void tearDown() {}
+
+static void test_steady_readings_pack_to_three_bytes() {
+  for (int i = 0; i < 48; i++) recs[i] = env(1736922645 + 30 * i, 215 + (i % 3), 556 - (i % 5));
+  size_t len = StoreCodec::encodeBlock(recs, 48, buf, sizeof(buf));
+  TEST_ASSERT_EQUAL(STORE_BLOCK_HEADER + 9 + 47 * 3, len);  // First record in full
+  TEST_ASSERT_EQUAL(48, StoreCodec::decodeBlock(buf, len, back, 48));
+  assertSame(recs, back, 48);
+}
+
+static void test_wide_steps_round_trip() {
+  recs[0] = env(0, 215, 556);                    // Clock not synced yet
+  recs[1] = env(1736922645, 230, 600);           // NTP: absolute epoch, i8 deltas
+  recs[2] = env(1736922645 + 300, -40, 1000);    // u16 gap, values in full
+  recs[3] = alert(1736922645 + 301, 3);
+  recs[4] = env(1736922645 + 302, STORE_NAN_TEMP, 610);
+  recs[5] = env(1736922645 + 100000, -38, 998);  // Deltas against recs[2]
+  recs[6] = env(1736922645 + 50, -38, 998);      // Clock stepped back
+  size_t len = StoreCodec::encodeBlock(recs, 7, buf, sizeof(buf));
+  TEST_ASSERT_TRUE(len > STORE_BLOCK_HEADER);
+  TEST_ASSERT_EQUAL(7, StoreCodec::decodeBlock(buf, len, back, 48));
+  assertSame(recs, back, 7);
+}
+
+static void test_header_describes_block() {
+  recs[0] = env(1736922645, 215, 556);
+  recs[1] = alert(1736922675, 1);
+  size_t len = StoreCodec::encodeBlock(recs, 2, buf, sizeof(buf));
+  uint8_t count = 0;
+  TEST_ASSERT_EQUAL(len, StoreCodec::blockLength(buf, &count));
+  TEST_ASSERT_EQUAL(2, count);
+  TEST_ASSERT_EQUAL(STORE_BLOCK_VERSION, buf[0]);
+  TEST_ASSERT_EQUAL(0xAA, buf[len]);  // Nothing written past the block
+}
+
+static void test_rejects_bad_input() {
+  recs[0] = env(1736922645, 215, 556);
+  recs[1] = env(1736922675, 216, 556);
+  TEST_ASSERT_EQUAL(0, StoreCodec::encodeBlock(recs, 0, buf, sizeof(buf)));
+  TEST_ASSERT_EQUAL(0, StoreCodec::encodeBlock(recs, 2, buf, STORE_BLOCK_BYTES(2) - 1));
+  
+  size_t len = StoreCodec::encodeBlock(recs, 2, buf, sizeof(buf));
+  TEST_ASSERT_EQUAL(0, StoreCodec::decodeBlock(buf, len - 1, back, 48));  // Torn write
+  TEST_ASSERT_EQUAL(0, StoreCodec::decodeBlock(buf, len, back, 1));       // No room
+  buf[0] = STORE_BLOCK_VERSION + 1;
+  uint8_t count = 0;
+  TEST_ASSERT_EQUAL(0, StoreCodec::blockLength(buf, &count));
+  TEST_ASSERT_EQUAL(0, StoreCodec::decodeBlock(buf, len, back, 48));
+}
+
+int main() {
+  UNITY_BEGIN();
+  RUN_TEST(test_steady_readings_pack_to_three_bytes);
+  RUN_TEST(test_wide_steps_round_trip);
+  RUN_TEST(test_header_describes_block);
+  RUN_TEST(test_rejects_bad_input);
+  return UNITY_END();
+}
@@ -0,0 +1,71 @@
+/*
+ * Unit tests for Telemetry (packed binary messages for the broker backend)
+ * 
+ * Run: pio test -e native -f test_telemetry
+ */
+
+#include <unity.h>
+#include "telemetry.h"
+
+static TelemetryReading sample;
+static uint8_t buf[32];
+
+void setUp() {
+  sample = { TLM_CLOCK, 0x01020304, 1736922645, -123, 556, -67, 183456, 86400 };
+  memset(buf, 0xAA, sizeof(buf));
+}
+void tearDown() {}
+
+static void test_round_trip() {
+  TEST_ASSERT_EQUAL(TELEMETRY_LEN, Telemetry::encode(sample, buf, sizeof(buf)));
+  TelemetryReading r;
+  TEST_ASSERT_TRUE(Telemetry::decode(buf, TELEMETRY_LEN, r));
+  TEST_ASSERT_EQUAL(TLM_CLOCK, r.flags);
+  TEST_ASSERT_EQUAL_UINT32(0x01020304, r.seq);
+  TEST_ASSERT_EQUAL_UINT32(1736922645, r.epoch);
+  TEST_ASSERT_EQUAL(-123, r.temp10);
+  TEST_ASSERT_EQUAL(556, r.hum10);
+  TEST_ASSERT_EQUAL(-67, r.rssi);
+  TEST_ASSERT_EQUAL_UINT32(183456, r.freeHeap);
+  TEST_ASSERT_EQUAL_UINT32(86400, r.uptimeS);
+}
+
+static void test_little_endian_layout() {
+  Telemetry::encode(sample, buf, sizeof(buf));
+  TEST_ASSERT_EQUAL(TELEMETRY_VERSION, buf[0]);
+  TEST_ASSERT_EQUAL(0x04, buf[2]);  // seq, low byte first
+  TEST_ASSERT_EQUAL(0x01, buf[5]);
+  TEST_ASSERT_EQUAL(0x85, buf[10]); // -123 = 0xFF85
+  TEST_ASSERT_EQUAL(0xFF, buf[11]);
+  TEST_ASSERT_EQUAL(0xBD, buf[14]); // -67 dBm
+  TEST_ASSERT_EQUAL(0, buf[15]);
+  TEST_ASSERT_EQUAL(0xAA, buf[TELEMETRY_LEN]);  // Nothing written past the message
+}
+
+static void test_nan_sentinels_survive() {
+  sample.temp10 = TLM_NAN_TEMP;
+  sample.hum10 = TLM_NAN_HUM;
+  Telemetry::encode(sample, buf, sizeof(buf));
+  TelemetryReading r;
+  TEST_ASSERT_TRUE(Telemetry::decode(buf, TELEMETRY_LEN, r));
+  TEST_ASSERT_EQUAL(TLM_NAN_TEMP, r.temp10);
+  TEST_ASSERT_EQUAL(TLM_NAN_HUM, r.hum10);
+}
+
+static void test_rejects_bad_input() {
+  TEST_ASSERT_EQUAL(0, Telemetry::encode(sample, buf, TELEMETRY_LEN - 1));
+  Telemetry::encode(sample, buf, sizeof(buf));
+  TelemetryReading r;
+  TEST_ASSERT_FALSE(Telemetry::decode(buf, TELEMETRY_LEN - 1, r));
+  buf[0] = TELEMETRY_VERSION + 1;
+  TEST_ASSERT_FALSE(Telemetry::decode(buf, TELEMETRY_LEN, r));
+}
+
+int main() {
+  UNITY_BEGIN();
+  RUN_TEST(test_round_trip);
+  RUN_TEST(test_little_endian_layout);
+  RUN_TEST(test_nan_sentinels_survive);
+  RUN_TEST(test_rejects_bad_input);
+  return UNITY_END();
+}
@@ -0,0 +1,158 @@
+/*
+ * Unit tests for WeatherRule (hysteresis, dwell and rate-of-change rules)
+ * 
+ * Run: pio test -e native -f test_weather_rule
+ */
+
+#include <unity.h>
+#include <math.h>
+#include "weather_rule.h"
+
+static WeatherState st;
+static WeatherConfig cfg;
+static uint32_t clockMs;
+
+void setUp() {
+  WeatherRule::reset(st);
+  cfg = { { 34.0f, 1.0f, 0, 0 }, { 90.0f, 5.0f, 0, 0 } };  // No dwell, no rate rule
+  clockMs = 0;
+}
+void tearDown() {}
+
+// One reading every 10 s
+static uint8_t feed(float temp, float hum) {
+  SensorData d = {temp, hum, 0};
+  uint8_t alerts = WeatherRule::evaluate(st, d, cfg, clockMs);
+  clockMs += 10000;
+  return alerts;
+}
+
+static void test_normal_reading_raises_nothing() {
+  TEST_ASSERT_EQUAL(WX_NONE, feed(25.0f, 60.0f));
+  TEST_ASSERT_EQUAL(WX_NONE, feed(34.0f, 90.0f));  // At the limit is not over it
+}
+
+static void test_hovering_at_limit_alerts_once() {
+  TEST_ASSERT_EQUAL(WX_HIGH_TEMP, feed(34.1f, 60.0f));
+  TEST_ASSERT_EQUAL(WX_NONE, feed(33.9f, 60.0f));  // Inside the hysteresis band: not re-armed
+  TEST_ASSERT_EQUAL(WX_NONE, feed(34.2f, 60.0f));
+  TEST_ASSERT_EQUAL(WX_NONE, feed(33.5f, 60.0f));
+  TEST_ASSERT_EQUAL(WX_NONE, feed(34.1f, 60.0f));
+}
+
+static void test_rearms_below_hysteresis_band() {
+  TEST_ASSERT_EQUAL(WX_HIGH_TEMP, feed(35.0f, 60.0f));
+  TEST_ASSERT_EQUAL(WX_NONE, feed(33.0f, 60.0f));  // 34 - 1: re-armed
+  TEST_ASSERT_EQUAL(WX_HIGH_TEMP, feed(35.0f, 60.0f));
+}
+
+static void test_dwell_delays_alert() {
+  cfg.temp.dwellMs = 30000;
+  TEST_ASSERT_EQUAL(WX_NONE, feed(35.0f, 60.0f));   // t=0: above since 0
+  TEST_ASSERT_EQUAL(WX_NONE, feed(35.0f, 60.0f));   // t=10 s
+  TEST_ASSERT_EQUAL(WX_NONE, feed(35.0f, 60.0f));   // t=20 s
+  TEST_ASSERT_EQUAL(WX_HIGH_TEMP, feed(35.0f, 60.0f)); // t=30 s
+}
+
+static void test_short_excursion_does_not_alert() {
+  cfg.temp.dwellMs = 30000;
+  feed(35.0f, 60.0f);
+  feed(35.0f, 60.0f);
+  feed(33.8f, 60.0f);  // Dipped below high: dwell restarts
+  TEST_ASSERT_EQUAL(WX_NONE, feed(35.0f, 60.0f));
+  TEST_ASSERT_EQUAL(WX_NONE, feed(35.0f, 60.0f));
+  TEST_ASSERT_EQUAL(WX_NONE, feed(35.0f, 60.0f));
+  TEST_ASSERT_EQUAL(WX_HIGH_TEMP, feed(35.0f, 60.0f));
+}
+
+static void test_thresholds_are_independent() {
+  TEST_ASSERT_EQUAL(WX_HIGH_HUM, feed(25.0f, 95.0f));
+  TEST_ASSERT_EQUAL(WX_HIGH_TEMP, feed(35.0f, 95.0f));
+  TEST_ASSERT_EQUAL(WX_NONE, feed(35.0f, 95.0f));
+  TEST_ASSERT_EQUAL(WX_HIGH_HUM, feed(35.0f, 80.0f) | feed(35.0f, 95.0f));
+}
+
+static void test_both_at_once() {
+  TEST_ASSERT_EQUAL(WX_HIGH_TEMP | WX_HIGH_HUM, feed(40.0f, 99.0f));
+}
+
+static void test_nan_keeps_state() {
+  TEST_ASSERT_EQUAL(WX_HIGH_TEMP, feed(35.0f, 60.0f));
+  TEST_ASSERT_EQUAL(WX_NONE, feed(NAN, NAN));
+  TEST_ASSERT_TRUE(st.temp.alerted);                // NaN does not re-arm
+  TEST_ASSERT_EQUAL(WX_NONE, feed(35.0f, 60.0f));   // So no repeat alert
+}
+
+static void test_nan_does_not_break_dwell() {
+  cfg.temp.dwellMs = 20000;
+  feed(35.0f, 60.0f);
+  feed(NAN, 60.0f);
+  TEST_ASSERT_EQUAL(WX_HIGH_TEMP, feed(35.0f, 60.0f));  // 20 s above, NaN in between
+}
+
+static void test_rate_of_change() {
+  cfg.temp.ratePerMin = 1.0f;  // 1 C per minute = 0.167 C per 10 s reading
+  TEST_ASSERT_EQUAL(WX_NONE, feed(25.0f, 60.0f));
+  TEST_ASSERT_EQUAL(WX_NONE, feed(25.1f, 60.0f));   // Two points: no slope yet
+  TEST_ASSERT_EQUAL(WX_NONE, feed(25.2f, 60.0f));   // 0.6 C/min
+  TEST_ASSERT_EQUAL(WX_NONE, feed(25.5f, 60.0f));
+  TEST_ASSERT_EQUAL(WX_TEMP_RISING, feed(26.0f, 60.0f));
+  TEST_ASSERT_EQUAL(WX_NONE, feed(26.5f, 60.0f));   // Still rising: no repeat
+  TEST_ASSERT_FLOAT_WITHIN(0.01f, 1.8f, WeatherRule::ratePerMin(st.temp));  // Least-squares over 6 readings
+}
+
+static void test_rate_rearms_when_flat() {
+  cfg.hum.ratePerMin = 6.0f;
+  feed(25.0f, 50.0f);
+  feed(25.0f, 52.0f);
+  TEST_ASSERT_EQUAL(WX_HUM_RISING, feed(25.0f, 54.0f));  // 12 %/min
+  for (int i = 0; i < WX_HISTORY; i++) feed(25.0f, 54.0f);
+  TEST_ASSERT_FALSE(st.hum.rising);
+}
+
+static void test_apply_runtime_config() {
+  TEST_ASSERT_EQUAL(3, WeatherRule::apply(cfg, "temp_high=30.5, temp_dwell=60;hum_rate=2"));
+  TEST_ASSERT_EQUAL_FLOAT(30.5f, cfg.temp.high);
+  TEST_ASSERT_EQUAL(60000, cfg.temp.dwellMs);
+  TEST_ASSERT_EQUAL_FLOAT(2.0f, cfg.hum.ratePerMin);
+  TEST_ASSERT_EQUAL_FLOAT(90.0f, cfg.hum.high);  // Untouched
+}
+
+static void test_apply_rejects_whole_command() {
+  WeatherConfig before = cfg;
+  TEST_ASSERT_EQUAL(-1, WeatherRule::apply(cfg, "temp_high=30 bogus=1"));
+  TEST_ASSERT_EQUAL(-1, WeatherRule::apply(cfg, "temp_high=abc"));
+  TEST_ASSERT_EQUAL(-1, WeatherRule::apply(cfg, "hum_hyst=-2"));
+  TEST_ASSERT_EQUAL(-1, WeatherRule::apply(cfg, "   "));
+  TEST_ASSERT_EQUAL_FLOAT(before.temp.high, cfg.temp.high);
+}
+
+static void test_describe_round_trips() {
+  cfg.temp.ratePerMin = 0.5f;
+  char buf[160];
+  WeatherRule::describe(cfg, buf, sizeof(buf));
+  WeatherConfig copy = { { 0, 0, 0, 0 }, { 0, 0, 0, 0 } };
+  TEST_ASSERT_EQUAL(8, WeatherRule::apply(copy, buf));
+  TEST_ASSERT_EQUAL_FLOAT(cfg.temp.high, copy.temp.high);
+  TEST_ASSERT_EQUAL_FLOAT(cfg.temp.ratePerMin, copy.temp.ratePerMin);
+  TEST_ASSERT_EQUAL_FLOAT(cfg.hum.hysteresis, copy.hum.hysteresis);
+}
+
+int main() {
+  UNITY_BEGIN();
+  RUN_TEST(test_normal_reading_raises_nothing);
+  RUN_TEST(test_hovering_at_limit_alerts_once);
+  RUN_TEST(test_rearms_below_hysteresis_band);
+  RUN_TEST(test_dwell_delays_alert);
+  RUN_TEST(test_short_excursion_does_not_alert);
+  RUN_TEST(test_thresholds_are_independent);
+  RUN_TEST(test_both_at_once);
+  RUN_TEST(test_nan_keeps_state);
+  RUN_TEST(test_nan_does_not_break_dwell);
+  RUN_TEST(test_rate_of_change);
+  RUN_TEST(test_rate_rearms_when_flat);
+  RUN_TEST(test_apply_runtime_config);
+  RUN_TEST(test_apply_rejects_whole_command);
+  RUN_TEST(test_describe_round_trips);
+  return UNITY_END();
+}
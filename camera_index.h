@@ -0,0 +1,152 @@
+#pragma once
+// Root page of the camera node, served from flash as a gzip constant
+// (Content-Encoding: gzip) - no String building per request.
+// The page is static: IP addresses come from location.hostname and the
+// connection details from /health. Stream port 81 and preview port 82
+// are fixed in the page and must match STREAM_PORT / PREVIEW_PORT.
+//
+// Regenerate after editing the source below:
+//   gzip -9 -n -c index.html | xxd -i
+//
+// Source (3006 bytes, 1242 gzipped):
+/*
+<!DOCTYPE html><html><head><title>ESP32-CAM Snapshot</title>
+<meta charset='UTF-8'>
+<meta name='viewport' content='width=device-width, initial-scale=1'>
+<style>
+body{font-family:Arial,sans-serif;text-align:center;margin:20px;background:#f5f5f5;}
+.container{max-width:800px;margin:0 auto;background:white;padding:20px;border-radius:8px;box-shadow:0 2px 4px rgba(0,0,0,0.1);}
+.info{background:#e8f4f8;padding:15px;border-radius:5px;margin:15px 0;text-align:left;}
+.info p{margin:8px 0;}
+.code{background:#f0f0f0;padding:8px;border-radius:3px;font-family:monospace;overflow-x:auto;}
+img{max-width:100%;height:auto;border:1px solid #ddd;border-radius:5px;margin:15px 0;}
+button{background:#007bff;color:white;border:none;padding:10px 20px;border-radius:5px;cursor:pointer;font-size:16px;}
+button:hover{background:#0056b3;}
+.status{background:#d4edda;color:#155724;padding:10px;border-radius:5px;margin:10px 0;}
+.warning{background:#fff3cd;color:#856404;padding:10px;border-radius:5px;margin:10px 0;}
+</style></head>
+<body><div class='container'>
+<h1>🎥 ESP32-CAM Snapshot Server</h1>
+<div id='mode' class='status'>Checking connection...</div>
+<div class='info'>
+<p><strong>WiFi Mode:</strong> <span id='wifi'></span></p>
+<p><strong>Network:</strong> <span id='ssid'></span></p>
+<p><strong>IP Address:</strong> <span class='ip'></span></p>
+</div>
+<h2>Live Preview</h2>
+<div id='preview'></div>
+<h2>API Endpoints</h2>
+<div class='info'>
+<p><strong>JPEG Snapshot:</strong></p>
+<div class='code'>http://<span class='ip'></span>/jpg</div>
+<p style='margin-top:10px;'><strong>Fixed size / quality:</strong></p>
+<div class='code'>http://<span class='ip'></span>/jpg?size=vga&amp;q=14</div>
+<p style='margin-top:10px;'><strong>Preview snapshot:</strong></p>
+<div class='code'>http://<span class='ip'></span>:82/snapshot</div>
+<p style='margin-top:10px;'><strong>Frame at a past moment (ring buffer):</strong></p>
+<div class='code'>http://<span class='ip'></span>/frame?ago=500</div>
+<p style='margin-top:10px;'><strong>MJPEG stream:</strong></p>
+<div class='code'>http://<span class='ip'></span>:81/stream</div>
+</div>
+<p style='color:#666;font-size:14px;margin-top:20px;'>Use these URLs to capture images from your IoT device</p>
+</div>
+<script>
+var h=location.hostname;
+document.querySelectorAll('.ip').forEach(function(e){e.textContent=h;});
+fetch('/health').then(function(r){return r.json();}).then(function(s){
+var m=document.getElementById('mode');
+m.className=s.ap?'warning':'status';
+m.textContent=s.ap?'Using Fallback AP Mode':'Connected to Phone Hotspot';
+document.getElementById('wifi').textContent=s.ap?'Fallback AP Mode':'Connected to Hotspot';
+document.getElementById('ssid').textContent=s.ssid;
+document.getElementById('preview').innerHTML=s.ring
+?"<div><img src='http://"+h+":81/stream' id='stream' alt='Live Stream'></div>"
+:"<button onclick='location.reload()'> Refresh Image</button><div><img src='http://"+h+":82/snapshot' id='stream' alt='Snapshot Preview'></div>";
+});
+</script>
+</body></html>
+*/
+
+#include <Arduino.h>
+
+static const size_t camera_index_html_gz_len = 1242;
+static const uint8_t camera_index_html_gz[] PROGMEM = {
+  0x1f, 0x8b, 0x08, 0x00, 0x00, 0x00, 0x00, 0x00, 0x02, 0x03, 0xad, 0x56, 0xeb, 0x6e, 0xdb, 0x36,
+  0x14, 0xfe, 0xef, 0xa7, 0xe0, 0x52, 0x6c, 0xb2, 0xd1, 0xda, 0x96, 0x1d, 0x3b, 0x35, 0x74, 0x0b,
+  0xb2, 0x2c, 0x59, 0x33, 0x34, 0x9d, 0xd1, 0x24, 0x18, 0xf6, 0x93, 0x16, 0x29, 0x89, 0x8d, 0x44,
+  0x2a, 0x24, 0xe5, 0xcb, 0x8c, 0xbc, 0xc2, 0x5e, 0x61, 0xbf, 0xf6, 0x7e, 0x7b, 0x84, 0x1d, 0x52,
+  0xb2, 0x63, 0x27, 0xe9, 0x0d, 0x2d, 0x84, 0x38, 0x36, 0x75, 0xbe, 0x73, 0xbe, 0x73, 0x67, 0xf0,
+  0xc3, 0x2f, 0xbf, 0x9f, 0x5e, 0xff, 0x39, 0x3d, 0x43, 0x99, 0x2e, 0xf2, 0x28, 0x68, 0x3e, 0x29,
+  0x26, 0x51, 0xa0, 0x99, 0xce, 0x69, 0x74, 0x76, 0x35, 0x3d, 0x1c, 0x76, 0x4f, 0x4f, 0x2e, 0xd1,
+  0x15, 0xc7, 0xa5, 0xca, 0x84, 0x0e, 0xfa, 0xf5, 0x9b, 0x56, 0x50, 0x50, 0x8d, 0x51, 0x9c, 0x61,
+  0xa9, 0xa8, 0x0e, 0x9d, 0x9b, 0xeb, 0xf3, 0xee, 0xc4, 0xd9, 0x1c, 0x73, 0x5c, 0xd0, 0xd0, 0x99,
+  0x33, 0xba, 0x28, 0x85, 0xd4, 0x0e, 0x8a, 0x05, 0xd7, 0x94, 0x83, 0xd8, 0x82, 0x11, 0x9d, 0x85,
+  0x84, 0xce, 0x59, 0x4c, 0xbb, 0xf6, 0xc7, 0x2b, 0xc4, 0x38, 0xd3, 0x0c, 0xe7, 0x5d, 0x15, 0xe3,
+  0x9c, 0x86, 0x03, 0xa3, 0x44, 0xe9, 0x95, 0xb1, 0x31, 0x13, 0x64, 0xb5, 0x4e, 0x00, 0xdb, 0x4d,
+  0x70, 0xc1, 0xf2, 0x95, 0x77, 0x22, 0x41, 0xf0, 0x95, 0xc2, 0x5c, 0x75, 0x15, 0x95, 0x2c, 0xf1,
+  0x35, 0x5d, 0xea, 0x2e, 0xce, 0x59, 0xca, 0xbd, 0x18, 0x0c, 0x50, 0xe9, 0x17, 0x58, 0xa6, 0x8c,
+  0x7b, 0x43, 0xb7, 0x5c, 0xfa, 0x33, 0x1c, 0xdf, 0xa6, 0x52, 0x54, 0x9c, 0x78, 0x2f, 0x92, 0xb1,
+  0x79, 0xfc, 0xfb, 0x56, 0xcf, 0x90, 0xc1, 0x8c, 0x53, 0xb9, 0x2e, 0xf0, 0xb2, 0x26, 0xe1, 0x4d,
+  0x5c, 0x23, 0xdf, 0x60, 0x5d, 0x84, 0x2b, 0x2d, 0x76, 0xd1, 0x8b, 0x8c, 0x69, 0xea, 0x97, 0x98,
+  0x10, 0xc6, 0xd3, 0x46, 0xb7, 0x90, 0x84, 0xca, 0xae, 0xc4, 0x84, 0x55, 0xca, 0x9b, 0xd8, 0x93,
+  0x65, 0x57, 0x65, 0x98, 0x88, 0x05, 0x68, 0x18, 0x96, 0x4b, 0x34, 0x82, 0x3f, 0x99, 0xce, 0x70,
+  0xdb, 0x7d, 0x65, 0x9f, 0xde, 0xa0, 0x63, 0xec, 0x33, 0x9e, 0x88, 0xf5, 0x2e, 0x35, 0x3a, 0x49,
+  0x46, 0xc9, 0x64, 0xab, 0x7e, 0x30, 0x7e, 0xa2, 0x7e, 0xfc, 0x40, 0xce, 0xbc, 0x45, 0xee, 0xae,
+  0xe3, 0x39, 0x4d, 0xf4, 0x46, 0x2f, 0x2a, 0xd7, 0x8d, 0xdc, 0xc4, 0x8a, 0x59, 0x77, 0x09, 0xdd,
+  0x33, 0x97, 0xb8, 0xe6, 0xd9, 0x9a, 0x9b, 0x3c, 0xb1, 0x76, 0x08, 0x27, 0xbb, 0x51, 0x2f, 0x04,
+  0x17, 0xaa, 0xc4, 0x31, 0xf5, 0xc5, 0x9c, 0xca, 0x24, 0x17, 0x8b, 0xee, 0xd2, 0xb3, 0x21, 0xba,
+  0x6f, 0xb1, 0x22, 0xdd, 0x09, 0xe3, 0xc0, 0x75, 0x7f, 0xf4, 0x33, 0xca, 0xd2, 0x4c, 0xd7, 0x02,
+  0xb5, 0x62, 0x6f, 0x00, 0x64, 0x94, 0xc8, 0x19, 0x41, 0x2f, 0x08, 0x21, 0x9f, 0x75, 0xee, 0xbe,
+  0x35, 0xab, 0xb4, 0x16, 0x7c, 0x8f, 0xb6, 0xeb, 0xbe, 0x9e, 0x25, 0x89, 0x1f, 0x8b, 0x5c, 0xc8,
+  0x26, 0x21, 0x8d, 0x76, 0x2e, 0xf8, 0x43, 0x72, 0x06, 0x90, 0x1c, 0xf4, 0x4c, 0x86, 0x8c, 0x95,
+  0xb8, 0x92, 0x0a, 0xc0, 0xa5, 0x60, 0xb6, 0x54, 0xac, 0x8f, 0x8a, 0xfd, 0x45, 0xbd, 0xc1, 0x11,
+  0xbc, 0xdd, 0x58, 0xf5, 0x32, 0xe3, 0xe6, 0x23, 0xdb, 0xe3, 0xa3, 0xd9, 0xa1, 0x89, 0xa6, 0xd2,
+  0x58, 0x57, 0x6a, 0xef, 0x25, 0x19, 0x51, 0x42, 0x70, 0x43, 0xec, 0xc5, 0x60, 0x3c, 0x7e, 0x3d,
+  0x1c, 0xed, 0xd1, 0xf9, 0x84, 0xbf, 0xee, 0x26, 0x4b, 0x0b, 0x2c, 0x39, 0xc8, 0xef, 0x27, 0x2a,
+  0x49, 0x0e, 0x63, 0xb2, 0x51, 0x3c, 0x19, 0x1f, 0x8d, 0xdc, 0xaf, 0x56, 0x1c, 0xf4, 0xeb, 0x5e,
+  0x0a, 0xfa, 0xb6, 0xaf, 0x5b, 0x81, 0xe9, 0xa9, 0x28, 0x20, 0x6c, 0x8e, 0xe2, 0x1c, 0x2b, 0x15,
+  0x3a, 0xdb, 0x76, 0x30, 0x8d, 0x97, 0x0d, 0xa2, 0xff, 0xfe, 0xf9, 0xfb, 0x5f, 0xf4, 0xb4, 0xf1,
+  0xd1, 0x15, 0x95, 0x10, 0x16, 0xd0, 0x33, 0x00, 0x39, 0x83, 0x67, 0x24, 0x74, 0x0a, 0x28, 0x2e,
+  0x67, 0xa3, 0xa9, 0x8e, 0x8d, 0x13, 0x9d, 0x66, 0x34, 0xbe, 0x05, 0x8e, 0xa6, 0xed, 0x39, 0x8d,
+  0x35, 0x13, 0xbc, 0xd7, 0xeb, 0x05, 0x7d, 0x00, 0x35, 0xd0, 0x06, 0x60, 0x2a, 0xd6, 0x58, 0x2d,
+  0x23, 0xe8, 0x78, 0x29, 0x78, 0x1a, 0xfd, 0xc1, 0xce, 0x19, 0xba, 0x04, 0xa5, 0x9e, 0x21, 0x6e,
+  0x8f, 0x50, 0x00, 0xb5, 0xc7, 0xad, 0xb5, 0x05, 0x4b, 0x98, 0x03, 0xae, 0x98, 0x03, 0xf8, 0x57,
+  0xee, 0x41, 0xdf, 0x51, 0xbd, 0x10, 0xf2, 0xf6, 0x59, 0xa0, 0x52, 0x8c, 0x7c, 0x14, 0x78, 0x31,
+  0x45, 0x27, 0x84, 0x48, 0xaa, 0xd4, 0x13, 0xec, 0x86, 0x67, 0xf9, 0x08, 0xdc, 0xb8, 0x92, 0x0d,
+  0xa3, 0xb7, 0x6c, 0x4e, 0xd1, 0x54, 0x52, 0x33, 0xeb, 0x20, 0x36, 0xc3, 0x9d, 0xd8, 0x94, 0xf5,
+  0xa9, 0x81, 0x6e, 0xc5, 0x4f, 0xa6, 0x17, 0xe8, 0x8c, 0x13, 0x5b, 0x81, 0x6a, 0x47, 0xfe, 0xa3,
+  0x01, 0xf9, 0x6d, 0x7a, 0xf6, 0xeb, 0x36, 0x07, 0x0f, 0xfc, 0x6a, 0x1a, 0x7b, 0x59, 0x84, 0x44,
+  0x44, 0x99, 0xd6, 0xa5, 0xd7, 0xef, 0x7f, 0x8c, 0x7c, 0xff, 0x43, 0x99, 0x6e, 0xc8, 0x94, 0xc8,
+  0x16, 0x06, 0xa4, 0xd0, 0x56, 0x4c, 0x57, 0x8b, 0xb2, 0xae, 0x29, 0x67, 0x6b, 0xfb, 0x9c, 0x2d,
+  0x29, 0x41, 0xa6, 0x41, 0x50, 0x1f, 0xdd, 0x55, 0x30, 0x6d, 0xf4, 0xea, 0x7b, 0x50, 0x38, 0x36,
+  0x2a, 0xc3, 0x79, 0x8a, 0x7f, 0xc2, 0x45, 0xe9, 0xdf, 0x85, 0x83, 0xd1, 0x57, 0x90, 0x6a, 0x62,
+  0x8d, 0xd4, 0x77, 0x8a, 0x89, 0x37, 0x19, 0xf6, 0xd5, 0x76, 0xb9, 0x7d, 0x79, 0x6c, 0x24, 0xac,
+  0x38, 0x84, 0x35, 0xc2, 0xa8, 0xc4, 0x4a, 0xa3, 0x42, 0x14, 0xb0, 0x7f, 0x50, 0x5b, 0x9a, 0xba,
+  0x9f, 0x55, 0x49, 0x42, 0x65, 0xe7, 0x9b, 0x63, 0x95, 0x18, 0x23, 0xc7, 0x38, 0x15, 0xe1, 0xd8,
+  0x75, 0xbf, 0x82, 0xdc, 0xa5, 0xad, 0x1a, 0xf8, 0x41, 0x71, 0xf1, 0xed, 0xf1, 0x19, 0xf4, 0x6b,
+  0x4d, 0x1b, 0x02, 0x8f, 0x79, 0x34, 0xf3, 0xe9, 0xe8, 0xe8, 0x68, 0x77, 0xa2, 0x8e, 0xb6, 0xc3,
+  0xc8, 0x32, 0x1c, 0xd6, 0x0c, 0x6f, 0x14, 0x45, 0x3a, 0xa3, 0xf0, 0x79, 0xf3, 0xfe, 0xad, 0x42,
+  0x5a, 0xa0, 0x18, 0x97, 0xba, 0x92, 0x14, 0xb1, 0x02, 0xa7, 0x54, 0xa1, 0x44, 0x8a, 0x02, 0xad,
+  0x44, 0x25, 0xd1, 0x85, 0xb8, 0x46, 0xf5, 0x45, 0x61, 0xaf, 0xe7, 0x54, 0x2c, 0x59, 0xa9, 0xa3,
+  0xd6, 0x1c, 0x4b, 0x94, 0x85, 0xb9, 0x88, 0xb1, 0x9d, 0x2f, 0x99, 0x50, 0xda, 0xdc, 0x3a, 0xfc,
+  0x16, 0x11, 0x71, 0x65, 0x72, 0xd1, 0xbb, 0xab, 0xa8, 0x5c, 0x5d, 0xd1, 0x1c, 0x26, 0x90, 0x90,
+  0x27, 0x79, 0xde, 0x76, 0x7a, 0xe0, 0x57, 0xa7, 0x97, 0x08, 0x79, 0x86, 0xe3, 0xac, 0x9d, 0x54,
+  0xdc, 0xce, 0xa6, 0x36, 0xed, 0xac, 0x69, 0xcf, 0x2c, 0xd4, 0xd3, 0xe6, 0x9a, 0x92, 0xf9, 0xf7,
+  0x1d, 0xbf, 0x95, 0x50, 0x0d, 0x52, 0x8e, 0x19, 0x9c, 0xb9, 0xce, 0x00, 0x08, 0xc4, 0xf9, 0x03,
+  0x4a, 0x76, 0xd6, 0x92, 0x02, 0x75, 0x8e, 0x64, 0xef, 0x83, 0x82, 0x03, 0x58, 0xee, 0x8f, 0x65,
+  0x54, 0x67, 0x6d, 0x89, 0x16, 0xe1, 0x96, 0x55, 0x4a, 0xf5, 0x59, 0x4e, 0xcd, 0xd7, 0x9f, 0x57,
+  0x17, 0xa4, 0x5d, 0x4f, 0x50, 0xb0, 0x56, 0xf4, 0x6c, 0xec, 0xdf, 0x99, 0x9b, 0x93, 0xea, 0xe1,
+  0xf2, 0xd8, 0x69, 0x56, 0x82, 0xe3, 0x6d, 0x06, 0xab, 0x11, 0xda, 0xa5, 0x59, 0x8b, 0xdd, 0x28,
+  0x53, 0x72, 0xe7, 0x38, 0xcf, 0xcd, 0xee, 0x40, 0x27, 0x53, 0x3b, 0x3f, 0x01, 0x75, 0x5a, 0x4f,
+  0x5f, 0x68, 0x61, 0x08, 0xf3, 0x34, 0x83, 0x25, 0x89, 0xde, 0x08, 0xad, 0x4a, 0xa1, 0x9d, 0x9d,
+  0x28, 0x3d, 0xe6, 0x63, 0x67, 0x6c, 0xe7, 0x19, 0x3b, 0x9f, 0xb3, 0xf0, 0x05, 0xba, 0xed, 0x18,
+  0x7e, 0xac, 0xdb, 0x1c, 0x7e, 0x02, 0xb3, 0x99, 0xa2, 0x1d, 0xb8, 0xdf, 0xc0, 0x92, 0x7a, 0x73,
+  0x7d, 0xf9, 0x16, 0x40, 0xa6, 0xcd, 0x5a, 0xc7, 0x07, 0xa6, 0x9a, 0xa3, 0x00, 0xee, 0x20, 0x48,
+  0xc9, 0x38, 0x74, 0x9a, 0x52, 0x3e, 0x78, 0x99, 0xbd, 0x3c, 0x78, 0xa8, 0x5b, 0xa7, 0x5e, 0x01,
+  0xcd, 0x77, 0xc8, 0x65, 0xe8, 0xd8, 0xa9, 0x7d, 0x55, 0x9f, 0x34, 0xe3, 0xf9, 0xa0, 0xe5, 0x1d,
+  0x04, 0xf5, 0x05, 0x00, 0x09, 0x1e, 0xe7, 0x2c, 0xbe, 0x0d, 0x9d, 0x6d, 0x79, 0x49, 0x9a, 0x0b,
+  0x4c, 0xda, 0x1d, 0x27, 0x42, 0xef, 0x69, 0x02, 0xbb, 0x22, 0x43, 0x17, 0xa6, 0x60, 0x83, 0x7e,
+  0x0d, 0x89, 0x3e, 0xc9, 0xe4, 0x61, 0xc2, 0x3c, 0xc3, 0x65, 0xbb, 0x60, 0xa7, 0xfb, 0xfb, 0xe2,
+  0xc0, 0x6f, 0x99, 0x2a, 0x84, 0x36, 0x6c, 0x2a, 0x1e, 0x6c, 0xd9, 0xdd, 0xdd, 0xb7, 0xf7, 0xf4,
+  0xd6, 0xff, 0x4e, 0xfd, 0x07, 0x51, 0xbe, 0x0b, 0x00, 0x00,
+};